@@ -0,0 +1,14 @@
+uniform mat4 view;
+uniform mat4 projection;
+
+layout(location = 0) in vec3 inVertexLocation;
+// Per-draw instanced attribute
+layout(location = 4) in mat4 inModel;
+
+// Must match simple.vert bit for bit, lit pass tests depth with GL_EQUAL
+invariant gl_Position;
+
+void main() {
+  vec3 location = vec3(inModel * vec4(inVertexLocation, 1.0f));
+  gl_Position = projection * view * vec4(location, 1.0f);
+}
@@ -0,0 +1,90 @@
+struct DirectionalLight
+{
+    vec4 direction;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+};
+
+layout(std140) uniform DirectionalLightBlock
+{
+    DirectionalLight directionalLights[cv_max_lights_per_draw];
+};
+
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedo;
+uniform sampler2D gSpecular;
+uniform sampler2D gDepth;
+uniform mat4 inverseProjectionView;
+uniform vec2 viewportSize;
+uniform vec3 viewLocation;
+
+flat in int lightIndex;
+
+out vec4 FragColor;
+
+struct Surface
+{
+    vec3 location;
+    vec3 normal;
+    vec3 viewDirection;
+    vec3 albedo;
+    vec3 specular;
+    float shininess;
+};
+
+// Returns false for pixels not covered by geometry
+bool ReadSurface(out Surface surface)
+{
+    vec2 uv = gl_FragCoord.xy / viewportSize;
+    float depth = texture(gDepth, uv).r;
+    if (depth >= 1.0f) {
+        return false;
+    }
+
+    vec4 ndc = vec4(vec3(uv, depth) * 2.0f - 1.0f, 1.0f);
+    vec4 location = inverseProjectionView * ndc;
+    surface.location = location.xyz / location.w;
+    surface.normal = normalize(texture(gNormal, uv).xyz);
+    surface.viewDirection = normalize(viewLocation - surface.location);
+    surface.albedo = texture(gAlbedo, uv).rgb;
+    vec4 specular = texture(gSpecular, uv);
+    surface.specular = specular.rgb;
+    surface.shininess = specular.a * 256.0f;
+    return true;
+}
+
+float ComputeAttenuation(vec3 attenuation, float dist)
+{
+    float div = attenuation.x;
+    div += attenuation.y * dist;
+    div += attenuation.z * dist * dist;
+    return clamp(1.0f / div, 0, 1.0f);
+}
+
+float ComputeSpecular(in Surface surface, vec3 lightDirection)
+{
+    vec3 reflectDirection = reflect(-lightDirection, surface.normal);
+    return pow(max(dot(surface.viewDirection, reflectDirection), 0.0f),
+               surface.shininess);
+}
+
+void main()
+{
+    Surface surface;
+    if (!ReadSurface(surface)) {
+        discard;
+    }
+
+    DirectionalLight light = directionalLights[lightIndex];
+    vec3 lightDirection = normalize(-light.direction.xyz);
+
+    vec3 ambient = light.ambient.rgb;
+    vec3 diffuse = light.diffuse.rgb *
+                   max(dot(surface.normal, lightDirection), 0.0f);
+    vec3 specular = light.specular.rgb *
+                    ComputeSpecular(surface, lightDirection);
+
+    FragColor = vec4((ambient + diffuse) * surface.albedo +
+                     specular * surface.specular, 1.0f);
+}
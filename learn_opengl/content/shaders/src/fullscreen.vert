@@ -0,0 +1,8 @@
+flat out int lightIndex;
+
+void main() {
+  lightIndex = gl_InstanceID;
+  // Single triangle that covers the whole viewport
+  vec2 location = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  gl_Position = vec4(location * 2.0f - 1.0f, 0.0f, 1.0f);
+}
@@ -0,0 +1,29 @@
+struct Material
+{
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+uniform Material material;
+
+in vec3 fragmentColor;
+in vec2 fragmentTextureCoordinates;
+in vec3 fragmentNormal;
+in vec3 fragmentLocation;
+
+layout(location = 0) out vec4 outNormal;
+layout(location = 1) out vec4 outAlbedo;
+layout(location = 2) out vec4 outSpecular;
+layout(location = 3) out float outDepth;
+
+void main()
+{
+    vec4 diffuse = texture(material.diffuse, fragmentTextureCoordinates);
+    vec3 specular = vec3(texture(material.specular, fragmentTextureCoordinates));
+
+    outNormal = vec4(normalize(fragmentNormal), 0.0f);
+    outAlbedo = vec4(diffuse.rgb * fragmentColor, diffuse.a);
+    outSpecular = vec4(specular * fragmentColor, material.shininess / 256.0f);
+    outDepth = gl_FragCoord.z;
+}
@@ -0,0 +1,13 @@
+uniform mat4 view;
+uniform mat4 projection;
+
+layout(location = 0) in vec3 inVertexLocation;
+// Per-light instanced attribute
+layout(location = 4) in mat4 inModel;
+
+flat out int lightIndex;
+
+void main() {
+  lightIndex = gl_InstanceID;
+  gl_Position = projection * view * inModel * vec4(inVertexLocation, 1.0f);
+}
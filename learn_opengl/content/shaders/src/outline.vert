@@ -1,9 +1,10 @@
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
-in vec3 inVertexLocation;
+layout(location = 0) in vec3 inVertexLocation;
+// Per-draw instanced attribute
+layout(location = 4) in mat4 inModel;
 
 void main() {
-  gl_Position = projection * view * model * vec4(inVertexLocation, 1.0f);
+  gl_Position = projection * view * inModel * vec4(inVertexLocation, 1.0f);
 }
@@ -1,5 +1,4 @@
 uniform vec2 texCoordMultiplier;
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
@@ -7,15 +6,20 @@ layout(location = 0) in vec3 inVertexLocation;
 layout(location = 1) in vec2 inTexCoord;
 layout(location = 2) in vec3 inVertexColor;
 layout(location = 3) in vec3 inNormal;
+// Per-draw instanced attribute
+layout(location = 4) in mat4 inModel;
 
 out vec3 fragmentColor;
 out vec2 fragmentTextureCoordinates;
 out vec3 fragmentNormal;
 out vec3 fragmentLocation;
 
+// Depth pre-pass (depth.vert) computes the same position
+invariant gl_Position;
+
 void main() {
-  fragmentLocation = vec3(model * vec4(inVertexLocation, 1.0f));
-  fragmentNormal = mat3(transpose(inverse(model))) * inNormal;
+  fragmentLocation = vec3(inModel * vec4(inVertexLocation, 1.0f));
+  fragmentNormal = mat3(transpose(inverse(inModel))) * inNormal;
   gl_Position = projection * view * vec4(fragmentLocation, 1.0f);
   
   fragmentColor = inVertexColor;
@@ -2,7 +2,8 @@
 
 #include "components/type_id_widget.hpp"
 
-void Component::DrawDetails() {
+bool Component::DrawDetails() {
   bool value_changed = false;
   TypeIdWidget(GetTypeGUID(), this, value_changed);
+  return value_changed;
 }
\ No newline at end of file
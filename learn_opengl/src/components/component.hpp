@@ -7,7 +7,8 @@
 class Component {
  public:
   [[nodiscard]] virtual edt::GUID GetTypeGUID() const noexcept = 0;
-  virtual void DrawDetails();
+  // Returns true if a value was edited
+  virtual bool DrawDetails();
   virtual ~Component() noexcept = default;
 };
 
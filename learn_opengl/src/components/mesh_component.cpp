@@ -3,9 +3,6 @@
 #include <unordered_map>
 
 #include "shader/shader.hpp"
-#include "template/class_member_traits.hpp"
-#include "template/member_offset.hpp"
-#include "template/type_to_gl_type.hpp"
 #include "tiny_obj_loader.h"
 
 MeshComponent::MeshComponent() = default;
@@ -77,45 +74,11 @@ static void LoadModel(const std::string& model_path,
   }
 }
 
-template <auto MemberVariablePtr>
-void RegisterAttribute(GLuint location, bool normalized) {
-  using MemberTraits = ClassMemberTraits<decltype(MemberVariablePtr)>;
-  using GlTypeTraits = TypeToGlType<typename MemberTraits::Member>;
-  const size_t vertex_stride = sizeof(typename MemberTraits::Class);
-  const size_t member_stride = MemberOffset<MemberVariablePtr>();
-  OpenGl::VertexAttribPointer(location, GlTypeTraits::Size, GlTypeTraits::Type,
-                              normalized, vertex_stride,
-                              reinterpret_cast<void*>(member_stride));
-  OpenGl::EnableVertexAttribArray(location);
-}
-
 void MeshComponent::Create(const std::span<const Vertex>& vertices,
                            const std::span<const ui32>& indices,
                            const std::shared_ptr<Shader>& shader) {
-  vao_ = OpenGl::GenVertexArray();
-  vbo_ = OpenGl::GenBuffer();
-  ebo_ = OpenGl::GenBuffer();
-
-  // bind Vertex Array Object
-  OpenGl::BindVertexArray(vao_);
-
-  // copy our vertices array in a buffer for OpenGL to use
-  OpenGl::BindBuffer(GL_ARRAY_BUFFER, vbo_);
-  OpenGl::BufferData(GL_ARRAY_BUFFER, std::span(vertices), GL_STATIC_DRAW);
-
-  // copy index array in a element buffer
-  OpenGl::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-  OpenGl::BufferData(GL_ELEMENT_ARRAY_BUFFER, std::span(indices),
-                     GL_STATIC_DRAW);
-
-  GLuint location = 0;
-  RegisterAttribute<&Vertex::position>(location++, false);
-  RegisterAttribute<&Vertex::tex_coord>(location++, false);
-  RegisterAttribute<&Vertex::color>(location++, false);
-  RegisterAttribute<&Vertex::normal>(location++, false);
-
+  geometry_ = GeometryArena::Get().AllocateShared(vertices, indices);
   shader_ = shader;
-  num_indices_ = indices.size();
 }
 
 constexpr std::array<ui32, 6> get_square_indices(bool clockwise) {
@@ -186,16 +149,22 @@ void MeshComponent::MakeCube(float width, const Eigen::Vector3f& color,
   Create(vertices, indices, shader);
 }
 
-void MeshComponent::Draw() {
-  OpenGl::BindVertexArray(vao_);
-  OpenGl::DrawElements(GL_TRIANGLES, num_indices_, GL_UNSIGNED_INT, nullptr);
+void MeshComponent::ReadGeometry(std::vector<Vertex>& vertices,
+                                 std::vector<ui32>& indices) const {
+  [[likely]] if (geometry_) {
+    GeometryArena::Get().Read(*geometry_, vertices, indices);
+  } else {
+    vertices.clear();
+    indices.clear();
+  }
 }
 
-void MeshComponent::DrawDetails() {
-  SimpleComponentBase<MeshComponent>::DrawDetails();
+bool MeshComponent::DrawDetails() {
+  const bool value_changed = SimpleComponentBase<MeshComponent>::DrawDetails();
   if (shader_) {
     shader_->DrawDetails();
   }
+  return value_changed;
 }
 
 void MeshComponent::Create(const std::string& path,
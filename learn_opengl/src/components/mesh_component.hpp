@@ -2,21 +2,16 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "components/component.hpp"
+#include "geometry/geometry_arena.hpp"
+#include "geometry/vertex.hpp"
 #include "opengl/gl_api.hpp"
 #include "reflection/eigen_reflect.hpp"
 
 class Shader;
 
-class Vertex {
- public:
-  Eigen::Vector3f position;
-  Eigen::Vector2f tex_coord;
-  Eigen::Vector3f color;
-  Eigen::Vector3f normal;
-};
-
 class MeshComponent : public SimpleComponentBase<MeshComponent> {
  public:
   MeshComponent();
@@ -31,16 +26,25 @@ class MeshComponent : public SimpleComponentBase<MeshComponent> {
   void MakeCube(float width, const Eigen::Vector3f& color,
                 const std::shared_ptr<Shader>& shader);
 
-  void Draw();
+  // Range of the global geometry arena. Copies of the component share it.
+  [[nodiscard]] const std::shared_ptr<const GeometryAllocation>& GetGeometry()
+      const noexcept {
+    return geometry_;
+  }
+
+  // Reads geometry back from GPU buffers
+  void ReadGeometry(std::vector<Vertex>& vertices,
+                    std::vector<ui32>& indices) const;
+
+  [[nodiscard]] const std::shared_ptr<Shader>& GetShader() const noexcept {
+    return shader_;
+  }
 
-  virtual void DrawDetails() override;
+  virtual bool DrawDetails() override;
 
  private:
-  size_t num_indices_ = 0;
+  std::shared_ptr<const GeometryAllocation> geometry_;
   std::shared_ptr<Shader> shader_;
-  GLuint vao_;  // vertex array object
-  GLuint vbo_;  // vertex buffer object
-  GLuint ebo_;  // element buffer object
 };
 
 namespace cppreflection {
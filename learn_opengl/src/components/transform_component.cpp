@@ -0,0 +1,12 @@
+#include "components/transform_component.hpp"
+
+#include "components/type_id_widget.hpp"
+
+bool TransformComponent::DrawDetails() {
+  bool value_changed = false;
+  TypeIdWidget(GetTypeGUID(), this, value_changed);
+  if (value_changed) {
+    MarkDirty();
+  }
+  return value_changed;
+}
@@ -1,27 +1,72 @@
 #pragma once
 
+#include <atomic>
+
 #include "components/component.hpp"
+#include "entities/entity_handle.hpp"
+#include "integer.hpp"
 #include "reflection/eigen_reflect.hpp"
 
+// Transform relative to the parent entity. The world matrix is cached and
+// updated by TransformSystem for transforms that changed and for all their
+// descendants, so call MarkDirty() after changing the local transform. The
+// system looks for dirty transforms in chunks with changed transforms, so
+// the change has to be a write for change queries as well.
 class TransformComponent : public SimpleComponentBase<TransformComponent> {
  public:
-  TransformComponent() {
-    Eigen::Transform<float, 3, Eigen::Affine> tr;
-    tr.matrix().setIdentity();
-    transform = tr.matrix();
-  }
+  TransformComponent() { world_.setIdentity(); }
   ~TransformComponent() = default;
 
+  bool DrawDetails() override;
+
+  void MarkDirty() noexcept { dirty_ = true; }
+
+  // Parent must have a transform component, otherwise this one is a root
+  void SetParent(EntityHandle parent) noexcept {
+    parent_ = parent;
+    dirty_ = true;
+    hierarchy_version_.fetch_add(1, std::memory_order_relaxed);
+  }
+  [[nodiscard]] EntityHandle GetParent() const noexcept { return parent_; }
+
+  [[nodiscard]] Eigen::Matrix4f GetLocal() const noexcept {
+    Eigen::Affine3f local;
+    local.fromPositionOrientationScale(translation, rotation, scale);
+    return local.matrix();
+  }
+
+  [[nodiscard]] const Eigen::Matrix4f& GetWorld() const noexcept {
+    return world_;
+  }
+
   [[nodiscard]] Eigen::Vector3f GetTranslation() const {
-    Eigen::Transform<float, 3, Eigen::Affine> tr(transform);
-    return tr.translation();
+    return world_.block<3, 1>(0, 3);
   }
 
   [[nodiscard]] Eigen::Matrix3f GetRotationMtx() const {
-    return transform.block<3, 3>(0, 0);
+    return world_.block<3, 3>(0, 0);
   }
 
-  Eigen::Matrix4f transform;
+  // Local, relative to the parent
+  Eigen::Quaternionf rotation = Eigen::Quaternionf::Identity();
+  Eigen::Vector3f translation = Eigen::Vector3f::Zero();
+  Eigen::Vector3f scale = Eigen::Vector3f::Ones();
+
+ private:
+  friend class TransformSystem;
+
+  // Bumped by any SetParent, so that cached hierarchies are rebuilt
+  static inline std::atomic<ui64> hierarchy_version_ = 0;
+
+  Eigen::Matrix4f world_;
+  EntityHandle parent_;
+  // Bookkeeping of the last TransformSystem update
+  const TransformComponent* parent_transform_ = nullptr;
+  ui64 visited_frame_ = 0;
+  ui32 depth_ = 0;
+  ui32 node_index_ = 0;
+  bool dirty_ = true;
+  bool world_changed_ = false;
 };
 
 namespace cppreflection {
@@ -32,7 +77,9 @@ struct TypeReflectionProvider<TransformComponent> {
                "TransformComponent",
                edt::GUID::Create("2B10B91A-661A-413D-978C-3B9BCD9BB5D0"))
         .Base<Component>()
-        .Field<"transform", &TransformComponent::transform>();
+        .Field<"translation", &TransformComponent::translation>()
+        .Field<"rotation", &TransformComponent::rotation>()
+        .Field<"scale", &TransformComponent::scale>();
   }
 };
-}  // namespace cppreflection
\ No newline at end of file
+}  // namespace cppreflection
@@ -79,6 +79,25 @@ bool MatrixProperty(edt::GUID type_guid, std::string_view name, void* address,
   return false;
 }
 
+// Edits coefficients (x, y, z, w) and keeps the quaternion normalized
+static bool QuaternionProperty(edt::GUID type_guid, std::string_view name,
+                               void* address, bool& value_changed) {
+  constexpr auto type_info =
+      cppreflection::GetStaticTypeInfo<Eigen::Quaternionf>();
+  if (type_info.guid == type_guid) {
+    Eigen::Quaternionf& value = *reinterpret_cast<Eigen::Quaternionf*>(address);
+    Eigen::Vector4f coeffs = value.coeffs();
+    [[unlikely]] if (VectorProperty(name, coeffs, -1.0f, 1.0f) &&
+                     coeffs.squaredNorm() > 0.0f) {
+      value.coeffs() = coeffs.normalized();
+      value_changed = true;
+    }
+    return true;
+  }
+
+  return false;
+}
+
 void SimpleTypeWidget(edt::GUID type_guid, std::string_view name, void* value,
                       bool& value_changed) {
   value_changed = false;
@@ -96,6 +115,7 @@ void SimpleTypeWidget(edt::GUID type_guid, std::string_view name, void* value,
       VectorProperty<Eigen::Vector2f>(type_guid, name, value, value_changed) ||
       VectorProperty<Eigen::Vector3f>(type_guid, name, value, value_changed) ||
       VectorProperty<Eigen::Vector4f>(type_guid, name, value, value_changed) ||
+      QuaternionProperty(type_guid, name, value, value_changed) ||
       MatrixProperty<Eigen::Matrix4f>(type_guid, name, value, value_changed);
 }
 
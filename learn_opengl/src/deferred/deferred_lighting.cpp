@@ -0,0 +1,412 @@
+#include "deferred/deferred_lighting.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "components/camera_component.hpp"
+#include "components/lights/directional_light_component.hpp"
+#include "components/lights/point_light_component.hpp"
+#include "components/lights/spot_light_component.hpp"
+#include "components/transform_component.hpp"
+#include "deferred/g_buffer.hpp"
+#include "name_cache/name_literal.hpp"
+#include "window.hpp"
+
+namespace {
+// Light contribution below this value is invisible in 8 bit output
+constexpr float kLightCutoff = 1.0f / 256.0f;
+constexpr float kMaxLightRange = 1000.0f;
+constexpr size_t kVolumeSegments = 16;
+constexpr size_t kSphereRings = kVolumeSegments / 2;
+
+constexpr GLuint kPointLightBlockBinding = 0;
+constexpr GLuint kSpotLightBlockBinding = 1;
+constexpr GLuint kDirectionalLightBlockBinding = 2;
+
+// Layouts match std140 blocks in light shaders
+struct PointLightData {
+  Eigen::Vector4f location_radius;
+  Eigen::Vector4f ambient;
+  Eigen::Vector4f diffuse;
+  Eigen::Vector4f specular;
+  Eigen::Vector4f attenuation;
+};
+
+struct SpotLightData {
+  Eigen::Vector4f location_range;
+  Eigen::Vector4f direction_inner;
+  Eigen::Vector4f diffuse_outer;
+  Eigen::Vector4f specular;
+  Eigen::Vector4f attenuation;
+};
+
+struct DirectionalLightData {
+  Eigen::Vector4f direction;
+  Eigen::Vector4f ambient;
+  Eigen::Vector4f diffuse;
+  Eigen::Vector4f specular;
+};
+
+static_assert(sizeof(PointLightData) == 80);
+static_assert(sizeof(SpotLightData) == 80);
+static_assert(sizeof(DirectionalLightData) == 64);
+
+[[nodiscard]] constexpr size_t AlignUp(size_t value,
+                                       size_t alignment) noexcept {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+[[nodiscard]] Eigen::Vector4f Extend(const Eigen::Vector3f& v,
+                                     float w = 0.0f) noexcept {
+  return Eigen::Vector4f(v.x(), v.y(), v.z(), w);
+}
+
+[[nodiscard]] Eigen::Vector4f Extend(const Attenuation& a) noexcept {
+  return Eigen::Vector4f(a.constant, a.linear, a.quadratic, 0.0f);
+}
+
+// Distance at which the light contribution drops below kLightCutoff
+[[nodiscard]] float ComputeLightRange(const Attenuation& attenuation,
+                                      float intensity) noexcept {
+  const float divisor = intensity / kLightCutoff;
+  [[unlikely]] if (divisor <= attenuation.constant) { return 0.0f; }
+
+  float range = kMaxLightRange;
+  if (attenuation.quadratic > 0.0f) {
+    const float b = attenuation.linear;
+    const float c = attenuation.constant - divisor;
+    range = (-b + std::sqrt(b * b - 4.0f * attenuation.quadratic * c)) /
+            (2.0f * attenuation.quadratic);
+  } else if (attenuation.linear > 0.0f) {
+    range = (divisor - attenuation.constant) / attenuation.linear;
+  }
+
+  return std::min(range, kMaxLightRange);
+}
+
+// Same as forward path computes it in ApplyUniforms
+[[nodiscard]] Eigen::Vector3f GetLightDirection(
+    const TransformComponent& transform, const Eigen::Vector3f& local) {
+  return (local.transpose() * transform.GetRotationMtx()).transpose();
+}
+
+// Sphere of radius 1 whose flat faces enclose the unit sphere
+std::shared_ptr<const GeometryAllocation> CreateSphereVolume() {
+  const float step = edt::PI<float> / static_cast<float>(kSphereRings);
+  const float cos_half_step = std::cos(step / 2.0f);
+  const float radius = 1.0f / (cos_half_step * cos_half_step);
+
+  std::vector<Vertex> vertices;
+  for (size_t ring = 0; ring <= kSphereRings; ++ring) {
+    const float phi = step * static_cast<float>(ring);
+    for (size_t segment = 0; segment != kVolumeSegments; ++segment) {
+      const float theta = step * static_cast<float>(segment);
+      Vertex& v = vertices.emplace_back();
+      v.position = Eigen::Vector3f(std::sin(phi) * std::cos(theta),
+                                   std::cos(phi),
+                                   std::sin(phi) * std::sin(theta)) *
+                   radius;
+      v.normal = v.position.normalized();
+    }
+  }
+
+  auto index = [](size_t ring, size_t segment) {
+    return static_cast<ui32>(ring * kVolumeSegments +
+                             segment % kVolumeSegments);
+  };
+
+  // Counter clockwise when looking from outside
+  std::vector<ui32> indices;
+  for (size_t ring = 0; ring != kSphereRings; ++ring) {
+    for (size_t segment = 0; segment != kVolumeSegments; ++segment) {
+      const ui32 a = index(ring, segment);
+      const ui32 b = index(ring + 1, segment);
+      const ui32 c = index(ring + 1, segment + 1);
+      const ui32 d = index(ring, segment + 1);
+      indices.insert(indices.end(), {a, c, b, a, d, c});
+    }
+  }
+
+  return GeometryArena::Get().AllocateShared(vertices, indices);
+}
+
+// Apex at origin, base of radius 1 at z = -1
+std::shared_ptr<const GeometryAllocation> CreateConeVolume() {
+  const float step =
+      2.0f * edt::PI<float> / static_cast<float>(kVolumeSegments);
+  const float radius = 1.0f / std::cos(step / 2.0f);
+
+  std::vector<Vertex> vertices(2);
+  vertices[0].position = Eigen::Vector3f::Zero();
+  vertices[1].position = Eigen::Vector3f(0.0f, 0.0f, -1.0f);
+  for (size_t segment = 0; segment != kVolumeSegments; ++segment) {
+    const float theta = step * static_cast<float>(segment);
+    Vertex& v = vertices.emplace_back();
+    v.position = Eigen::Vector3f(std::cos(theta) * radius,
+                                 std::sin(theta) * radius, -1.0f);
+  }
+
+  // Counter clockwise when looking from outside
+  std::vector<ui32> indices;
+  for (size_t segment = 0; segment != kVolumeSegments; ++segment) {
+    const auto a = static_cast<ui32>(2 + segment);
+    const auto b = static_cast<ui32>(2 + (segment + 1) % kVolumeSegments);
+    indices.insert(indices.end(), {0, a, b, 1, b, a});
+  }
+
+  return GeometryArena::Get().AllocateShared(vertices, indices);
+}
+}  // namespace
+
+DeferredLighting::LightPass::LightPass(const char* shader_path,
+                                       Name block_name, GLuint binding)
+    : shader(std::make_shared<Shader>(shader_path)), block_binding(binding) {
+  shader->SetUniformBlockBinding(block_name, block_binding);
+  view = shader->GetUniform("view"_name);
+  projection = shader->GetUniform("projection"_name);
+  inverse_projection_view = shader->GetUniform("inverseProjectionView"_name);
+  viewport_size = shader->GetUniform("viewportSize"_name);
+  view_location = shader->GetUniform("viewLocation"_name);
+  g_normal = shader->GetUniform("gNormal"_name);
+  g_albedo = shader->GetUniform("gAlbedo"_name);
+  g_specular = shader->GetUniform("gSpecular"_name);
+  g_depth = shader->GetUniform("gDepth"_name);
+
+  DefineHandle max_lights = shader->GetDefine("cv_max_lights_per_draw"_name);
+  max_lights_per_draw =
+      static_cast<size_t>(shader->GetDefineValue<int>(max_lights));
+}
+
+void DeferredLighting::LightPass::Begin(
+    const GBuffer& g_buffer, const Window& window,
+    const Eigen::Matrix4f& inverse_projection_view_matrix) {
+  shader->Use();
+  shader->SetUniform(view, window.GetView());
+  shader->SetUniform(projection, window.GetProjection());
+  shader->SetUniform(inverse_projection_view, inverse_projection_view_matrix);
+  shader->SetUniform(viewport_size,
+                     Eigen::Vector2f(static_cast<float>(window.GetWidth()),
+                                     static_cast<float>(window.GetHeight())));
+  shader->SetUniform(view_location, window.GetEyeLocation());
+  shader->SetUniform(g_normal, g_buffer.GetTexture(GBufferTarget::Normal));
+  shader->SetUniform(g_albedo, g_buffer.GetTexture(GBufferTarget::Albedo));
+  shader->SetUniform(g_specular,
+                     g_buffer.GetTexture(GBufferTarget::Specular));
+  shader->SetUniform(g_depth, g_buffer.GetTexture(GBufferTarget::Depth));
+  shader->SendUniforms();
+}
+
+DeferredLighting::DeferredLighting()
+    : point_pass_("point_light.shader.json", "PointLightBlock",
+                  kPointLightBlockBinding),
+      spot_pass_("spot_light.shader.json", "SpotLightBlock",
+                 kSpotLightBlockBinding),
+      directional_pass_("directional_light.shader.json",
+                        "DirectionalLightBlock",
+                        kDirectionalLightBlockBinding),
+      sphere_(CreateSphereVolume()),
+      cone_(CreateConeVolume()),
+      uniform_buffer_alignment_(static_cast<size_t>(
+          OpenGl::GetInteger(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT))),
+      empty_vertex_array_(OpenGl::GenVertexArray()) {}
+
+DeferredLighting::~DeferredLighting() {
+  OpenGl::DeleteVertexArray(empty_vertex_array_);
+}
+
+void DeferredLighting::Render(
+    const GBuffer& g_buffer, const Window& window,
+    LightList<PointLightComponent> point_lights,
+    LightList<SpotLightComponent> spot_lights,
+    LightList<DirectionalLightComponent> directional_lights) {
+  stats_ = DeferredLightingStats{};
+  const Eigen::Matrix4f inverse_projection_view =
+      (window.GetProjection() * window.GetView()).inverse();
+
+  // Lights out of range keep their slots with empty volumes, so that
+  // indices of other lights stay the same
+  ResizeMirrors<PointLightData>(point_pass_, point_lights.size(), true);
+  for (size_t i = 0; i != point_lights.size(); ++i) {
+    const auto& [transform, light, changed] = point_lights[i];
+    [[likely]] if (!changed) { continue; }
+
+    const float intensity =
+        std::max({light->ambient.maxCoeff(), light->diffuse.maxCoeff(),
+                  light->specular.maxCoeff()});
+    const float radius =
+        std::max(ComputeLightRange(light->attenuation, intensity), 0.0f);
+    const Eigen::Vector3f location = transform->GetTranslation();
+    PointLightData data;
+    data.location_radius = Extend(location, radius);
+    data.ambient = Extend(light->ambient);
+    data.diffuse = Extend(light->diffuse);
+    data.specular = Extend(light->specular);
+    data.attenuation = Extend(light->attenuation);
+    const Eigen::Matrix4f model =
+        Eigen::Translate(location.x(), location.y(), location.z()) *
+        Eigen::Scale(radius, radius, radius);
+    WriteLight(point_pass_, i, data, &model);
+  }
+
+  ResizeMirrors<SpotLightData>(spot_pass_, spot_lights.size(), true);
+  for (size_t i = 0; i != spot_lights.size(); ++i) {
+    const auto& [transform, light, changed] = spot_lights[i];
+    [[likely]] if (!changed) { continue; }
+
+    const float intensity =
+        std::max(light->diffuse.maxCoeff(), light->specular.maxCoeff());
+    const float range =
+        std::max(ComputeLightRange(light->attenuation, intensity), 0.0f);
+    const Eigen::Vector3f location = transform->GetTranslation();
+    const Eigen::Vector3f direction =
+        GetLightDirection(*transform, Eigen::Vector3f(0.0f, 0.0f, -1.0f))
+            .normalized();
+    // Angles are stored as cosines
+    const float cos_outer = std::max(light->outerAngle, 0.05f);
+    const float base_radius =
+        range * std::sqrt(1.0f - cos_outer * cos_outer) / cos_outer;
+
+    SpotLightData data;
+    data.location_range = Extend(location, range);
+    data.direction_inner = Extend(direction, light->innerAngle);
+    data.diffuse_outer = Extend(light->diffuse, light->outerAngle);
+    data.specular = Extend(light->specular);
+    data.attenuation = Extend(light->attenuation);
+
+    Eigen::Matrix4f rotation = Eigen::Matrix4f::Identity();
+    rotation.block<3, 3>(0, 0) =
+        Eigen::Quaternionf::FromTwoVectors(-Eigen::Vector3f::UnitZ(),
+                                           direction)
+            .toRotationMatrix();
+    const Eigen::Matrix4f model =
+        Eigen::Translate(location.x(), location.y(), location.z()) *
+        rotation * Eigen::Scale(base_radius, base_radius, range);
+    WriteLight(spot_pass_, i, data, &model);
+  }
+
+  ResizeMirrors<DirectionalLightData>(directional_pass_,
+                                      directional_lights.size(), false);
+  for (size_t i = 0; i != directional_lights.size(); ++i) {
+    const auto& [transform, light, changed] = directional_lights[i];
+    [[likely]] if (!changed) { continue; }
+
+    DirectionalLightData data;
+    data.direction = Extend(
+        GetLightDirection(*transform, Eigen::Vector3f(1.0f, 0.0f, 0.0f)));
+    data.ambient = Extend(light->ambient);
+    data.diffuse = Extend(light->diffuse);
+    data.specular = Extend(light->specular);
+    WriteLight(directional_pass_, i, data, nullptr);
+  }
+
+  // Lights add up
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_ONE, GL_ONE);
+  glDepthMask(GL_FALSE);
+  glStencilMask(0x00);
+
+  // Back faces of a volume pass depth test only in front of geometry, which
+  // also works when the camera is inside of the volume. Depth clamp keeps
+  // back faces beyond far plane.
+  glEnable(GL_CULL_FACE);
+  glCullFace(GL_FRONT);
+  glDepthFunc(GL_GEQUAL);
+  glEnable(GL_DEPTH_CLAMP);
+
+  point_pass_.Begin(g_buffer, window, inverse_projection_view);
+  DrawLights<PointLightData>(point_pass_, point_lights.size(), sphere_.get());
+  stats_.num_point_lights = static_cast<ui32>(point_lights.size());
+
+  spot_pass_.Begin(g_buffer, window, inverse_projection_view);
+  DrawLights<SpotLightData>(spot_pass_, spot_lights.size(), cone_.get());
+  stats_.num_spot_lights = static_cast<ui32>(spot_lights.size());
+
+  glDisable(GL_DEPTH_CLAMP);
+  glCullFace(GL_BACK);
+  glDisable(GL_CULL_FACE);
+  glDisable(GL_DEPTH_TEST);
+
+  directional_pass_.Begin(g_buffer, window, inverse_projection_view);
+  DrawLights<DirectionalLightData>(directional_pass_,
+                                   directional_lights.size(), nullptr);
+  stats_.num_directional_lights =
+      static_cast<ui32>(directional_lights.size());
+
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+  glDepthMask(GL_TRUE);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+template <typename LightData>
+void DeferredLighting::ResizeMirrors(LightPass& pass, size_t num_lights,
+                                     bool has_volume) {
+  const size_t num_pages = (num_lights + pass.max_lights_per_draw - 1) /
+                           pass.max_lights_per_draw;
+  pass.page_stride = AlignUp(sizeof(LightData) * pass.max_lights_per_draw,
+                             uniform_buffer_alignment_);
+  pass.lights.Resize(num_pages * pass.page_stride);
+  if (has_volume) {
+    pass.models.Resize(sizeof(Eigen::Matrix4f) * num_lights);
+  }
+}
+
+template <typename LightData>
+void DeferredLighting::WriteLight(LightPass& pass, size_t index,
+                                  const LightData& data,
+                                  const Eigen::Matrix4f* model) {
+  const size_t page = index / pass.max_lights_per_draw;
+  const size_t slot = index % pass.max_lights_per_draw;
+  bool changed =
+      pass.lights.Write(page * pass.page_stride + sizeof(LightData) * slot,
+                        data);
+  if (model) {
+    changed = pass.models.Write(sizeof(Eigen::Matrix4f) * index, *model) ||
+              changed;
+  }
+
+  if (changed) {
+    ++stats_.num_updated_lights;
+  }
+}
+
+template <typename LightData>
+void DeferredLighting::DrawLights(LightPass& pass, size_t num_lights,
+                                  const GeometryAllocation* volume) {
+  pass.lights.Upload();
+  stats_.uploaded_bytes += pass.lights.GetStats().last_upload_bytes;
+  if (volume) {
+    pass.models.Upload();
+    stats_.uploaded_bytes += pass.models.GetStats().last_upload_bytes;
+  }
+
+  // Uniform block is bound in full, unused tail of the last page is left
+  // uninitialized
+  const size_t block_size = sizeof(LightData) * pass.max_lights_per_draw;
+  for (size_t first = 0; first < num_lights;
+       first += pass.max_lights_per_draw) {
+    const size_t count = std::min(pass.max_lights_per_draw, num_lights - first);
+    const size_t page = first / pass.max_lights_per_draw;
+    OpenGl::BindBufferRange(GL_UNIFORM_BUFFER, pass.block_binding,
+                            pass.lights.GetBuffer(),
+                            static_cast<GLintptr>(page * pass.page_stride),
+                            static_cast<GLsizeiptr>(block_size));
+
+    if (volume) {
+      GeometryArena& arena = GeometryArena::Get();
+      arena.Bind();
+      GeometryArena::SetInstanceData(pass.models.GetBuffer(),
+                                     sizeof(Eigen::Matrix4f) * first);
+      OpenGl::DrawElementsInstancedBaseVertex(
+          GL_TRIANGLES, volume->num_indices, GL_UNSIGNED_INT,
+          reinterpret_cast<const void*>(sizeof(ui32) * volume->first_index),
+          count, static_cast<GLint>(volume->first_vertex));
+    } else {
+      OpenGl::BindVertexArray(empty_vertex_array_);
+      OpenGl::DrawArraysInstanced(GL_TRIANGLES, 0, 3, count);
+    }
+
+    ++stats_.num_draw_calls;
+  }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "geometry/geometry_arena.hpp"
+#include "integer.hpp"
+#include "opengl/gpu_mirror.hpp"
+#include "shader/shader.hpp"
+#include "wrap/wrap_eigen.hpp"
+
+class DirectionalLightComponent;
+class GBuffer;
+class PointLightComponent;
+class SpotLightComponent;
+class TransformComponent;
+class Window;
+
+template <typename Light>
+struct LightEntry {
+  TransformComponent* transform;
+  Light* light;
+  // Light or its transform changed since the previous frame, or the list
+  // is new
+  bool changed;
+};
+
+template <typename Light>
+using LightList = std::span<const LightEntry<Light>>;
+
+struct DeferredLightingStats {
+  ui32 num_point_lights = 0;
+  ui32 num_spot_lights = 0;
+  ui32 num_directional_lights = 0;
+  ui32 num_draw_calls = 0;
+  ui32 num_updated_lights = 0;
+  size_t uploaded_bytes = 0;
+};
+
+// Lighting pass of deferred shading. Point and spot lights are drawn as
+// instanced light volumes (spheres and cones) so each of them shades only
+// pixels it can reach, directional lights are full screen passes. Light
+// parameters and volume transforms are kept in GPU mirrors: only lights
+// marked as changed are recomputed and only changed bytes are uploaded.
+// Parameters are split into pages that fit into the uniform block, volume
+// transforms feed the instanced model matrix attribute.
+class DeferredLighting {
+ public:
+  DeferredLighting();
+  DeferredLighting(const DeferredLighting&) = delete;
+  ~DeferredLighting();
+
+  // Accumulates light into the currently bound framebuffer
+  void Render(const GBuffer& g_buffer, const Window& window,
+              LightList<PointLightComponent> point_lights,
+              LightList<SpotLightComponent> spot_lights,
+              LightList<DirectionalLightComponent> directional_lights);
+
+  [[nodiscard]] const DeferredLightingStats& GetStats() const noexcept {
+    return stats_;
+  }
+
+  DeferredLighting& operator=(const DeferredLighting&) = delete;
+
+ private:
+  struct LightPass {
+    explicit LightPass(const char* shader_path, Name block_name,
+                       GLuint block_binding);
+
+    void Begin(const GBuffer& g_buffer, const Window& window,
+               const Eigen::Matrix4f& inverse_projection_view);
+
+    std::shared_ptr<Shader> shader;
+    UniformHandle view;
+    UniformHandle projection;
+    UniformHandle inverse_projection_view;
+    UniformHandle viewport_size;
+    UniformHandle view_location;
+    UniformHandle g_normal;
+    UniformHandle g_albedo;
+    UniformHandle g_specular;
+    UniformHandle g_depth;
+    GLuint block_binding;
+    size_t max_lights_per_draw;
+    // Light data by pages of max_lights_per_draw
+    GpuMirror lights;
+    GpuMirror models;
+    size_t page_stride = 0;
+  };
+
+  template <typename LightData>
+  void ResizeMirrors(LightPass& pass, size_t num_lights, bool has_volume);
+
+  // Model is null for full screen lights
+  template <typename LightData>
+  void WriteLight(LightPass& pass, size_t index, const LightData& data,
+                  const Eigen::Matrix4f* model);
+
+  // Draws lights by pages that fit into the uniform block. Volume is null
+  // for full screen lights.
+  template <typename LightData>
+  void DrawLights(LightPass& pass, size_t num_lights,
+                  const GeometryAllocation* volume);
+
+ private:
+  LightPass point_pass_;
+  LightPass spot_pass_;
+  LightPass directional_pass_;
+  std::shared_ptr<const GeometryAllocation> sphere_;
+  std::shared_ptr<const GeometryAllocation> cone_;
+  DeferredLightingStats stats_;
+  size_t uniform_buffer_alignment_ = 0;
+  // Full screen triangle is generated from gl_VertexID
+  GLuint empty_vertex_array_ = 0;
+};
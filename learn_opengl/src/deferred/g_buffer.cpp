@@ -0,0 +1,152 @@
+#include "deferred/g_buffer.hpp"
+
+#include <stdexcept>
+
+#include "fmt/format.h"
+#include "memory/memory_tracker.hpp"
+#include "texture/texture.hpp"
+
+namespace {
+struct TargetFormat {
+  GLint internal_format;
+  GLenum data_format;
+  GLenum data_type;
+};
+
+constexpr std::array<TargetFormat, GBuffer::kNumTargets> kTargetFormats{
+    TargetFormat{GL_RGBA16F, GL_RGBA, GL_FLOAT},
+    TargetFormat{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE},
+    TargetFormat{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE},
+    TargetFormat{GL_R32F, GL_RED, GL_FLOAT}};
+
+constexpr std::array<GLenum, GBuffer::kNumTargets> kGeometryDrawBuffers{
+    GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2,
+    GL_COLOR_ATTACHMENT3};
+
+constexpr std::array<GLenum, 1> kLightingDrawBuffers{GL_COLOR_ATTACHMENT0};
+
+// Texture is left bound to GL_TEXTURE0
+GLuint CreateTargetTexture(GLint internal_format, ui32 width, ui32 height,
+                           GLenum data_format, GLenum data_type) {
+  const GLuint texture = OpenGl::GenTexture();
+  OpenGl::ActiveTexture(GL_TEXTURE0);
+  OpenGl::BindTexture2d(texture);
+  OpenGl::TexImage2d(GL_TEXTURE_2D, 0, internal_format, width, height,
+                     data_format, data_type, nullptr);
+  // Targets are read with texelFetch-like 1:1 mapping and have no mipmaps
+  OpenGl::SetTextureParameter2d(GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  OpenGl::SetTextureParameter2d(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  OpenGl::SetTextureParameter2d(GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  OpenGl::SetTextureParameter2d(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  return texture;
+}
+
+void CheckFramebuffer(std::string_view name) {
+  const GLenum status = OpenGl::CheckFramebufferStatus(GL_FRAMEBUFFER);
+  [[unlikely]] if (status != GL_FRAMEBUFFER_COMPLETE) {
+    throw std::runtime_error(
+        fmt::format("{} framebuffer is incomplete: {:#x}", name, status));
+  }
+}
+}  // namespace
+
+GBuffer::GBuffer() = default;
+GBuffer::~GBuffer() { Destroy(); }
+
+void GBuffer::Resize(ui32 width, ui32 height) {
+  [[likely]] if (width == width_ && height == height_ &&
+                 geometry_framebuffer_) {
+    return;
+  }
+
+  Destroy();
+  width_ = width;
+  height_ = height;
+  Create();
+}
+
+void GBuffer::BeginGeometryPass() {
+  OpenGl::BindFramebuffer(GL_FRAMEBUFFER, geometry_framebuffer_);
+
+  OpenGl::ClearBuffer(GL_COLOR, 0, Eigen::Vector4f::Zero());
+  OpenGl::ClearBuffer(GL_COLOR, 1, Eigen::Vector4f::Zero());
+  OpenGl::ClearBuffer(GL_COLOR, 2, Eigen::Vector4f::Zero());
+  // Far plane marks pixels without geometry
+  OpenGl::ClearBuffer(GL_COLOR, 3, Eigen::Vector4f::Ones());
+  OpenGl::Clear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+}
+
+void GBuffer::BeginLightingPass() {
+  OpenGl::BindFramebuffer(GL_FRAMEBUFFER, lighting_framebuffer_);
+  OpenGl::Clear(GL_COLOR_BUFFER_BIT);
+}
+
+void GBuffer::Present() {
+  OpenGl::BindFramebuffer(GL_READ_FRAMEBUFFER, lighting_framebuffer_);
+  OpenGl::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  OpenGl::BlitFramebuffer(static_cast<GLint>(width_),
+                          static_cast<GLint>(height_), GL_COLOR_BUFFER_BIT,
+                          GL_NEAREST);
+  OpenGl::BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void GBuffer::Create() {
+  const MemoryTagScope tag_scope(MemoryTag::Render);
+  for (size_t i = 0; i != kNumTargets; ++i) {
+    const TargetFormat& format = kTargetFormats[i];
+    textures_[i] = Texture::FromHandle(
+        CreateTargetTexture(format.internal_format, width_, height_,
+                            format.data_format, format.data_type));
+  }
+
+  depth_stencil_ =
+      CreateTargetTexture(GL_DEPTH24_STENCIL8, width_, height_,
+                          GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+  light_accumulation_ =
+      CreateTargetTexture(GL_RGBA16F, width_, height_, GL_RGBA, GL_FLOAT);
+
+  geometry_framebuffer_ = OpenGl::GenFramebuffer();
+  OpenGl::BindFramebuffer(GL_FRAMEBUFFER, geometry_framebuffer_);
+  for (size_t i = 0; i != kNumTargets; ++i) {
+    OpenGl::FramebufferTexture2d(GL_FRAMEBUFFER, kGeometryDrawBuffers[i],
+                                 textures_[i]->GetHandle());
+  }
+  OpenGl::FramebufferTexture2d(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                               depth_stencil_);
+  OpenGl::DrawBuffers(kGeometryDrawBuffers);
+  CheckFramebuffer("Geometry");
+
+  lighting_framebuffer_ = OpenGl::GenFramebuffer();
+  OpenGl::BindFramebuffer(GL_FRAMEBUFFER, lighting_framebuffer_);
+  OpenGl::FramebufferTexture2d(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               light_accumulation_);
+  OpenGl::FramebufferTexture2d(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                               depth_stencil_);
+  OpenGl::DrawBuffers(kLightingDrawBuffers);
+  CheckFramebuffer("Lighting");
+
+  OpenGl::BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void GBuffer::Destroy() {
+  if (geometry_framebuffer_) {
+    OpenGl::DeleteFramebuffer(geometry_framebuffer_);
+    OpenGl::DeleteFramebuffer(lighting_framebuffer_);
+    geometry_framebuffer_ = 0;
+    lighting_framebuffer_ = 0;
+  }
+
+  for (std::shared_ptr<Texture>& texture : textures_) {
+    if (texture) {
+      OpenGl::DeleteTexture(texture->GetHandle());
+      texture = nullptr;
+    }
+  }
+
+  if (depth_stencil_) {
+    OpenGl::DeleteTexture(depth_stencil_);
+    OpenGl::DeleteTexture(light_accumulation_);
+    depth_stencil_ = 0;
+    light_accumulation_ = 0;
+  }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include "integer.hpp"
+#include "opengl/gl_api.hpp"
+
+class Texture;
+
+enum class GBufferTarget : ui8 {
+  // World space normal
+  Normal,
+  // Diffuse color multiplied by vertex color
+  Albedo,
+  // Specular color and shininess / 256 in alpha
+  Specular,
+  // Window space depth. Depth-stencil attachment is never sampled
+  Depth,
+  Max
+};
+
+// Render targets of deferred shading. Geometry pass writes surface
+// attributes into GBufferTarget textures, lighting pass accumulates light in
+// a separate color target that shares depth and stencil with geometry pass.
+class GBuffer {
+ public:
+  static constexpr size_t kNumTargets =
+      static_cast<size_t>(GBufferTarget::Max);
+
+  GBuffer();
+  GBuffer(const GBuffer&) = delete;
+  ~GBuffer();
+
+  // Recreates attachments if size changed
+  void Resize(ui32 width, ui32 height);
+
+  // Binds geometry framebuffer and clears it. Depth and stencil write masks
+  // must be enabled.
+  void BeginGeometryPass();
+
+  // Binds lighting framebuffer and clears its color to clear color
+  void BeginLightingPass();
+
+  // Copies lighting result to the default framebuffer and binds it
+  void Present();
+
+  [[nodiscard]] const std::shared_ptr<Texture>& GetTexture(
+      GBufferTarget target) const noexcept {
+    return textures_[static_cast<size_t>(target)];
+  }
+
+  GBuffer& operator=(const GBuffer&) = delete;
+
+ private:
+  void Create();
+  void Destroy();
+
+ private:
+  std::array<std::shared_ptr<Texture>, kNumTargets> textures_;
+  GLuint depth_stencil_ = 0;
+  GLuint light_accumulation_ = 0;
+  GLuint geometry_framebuffer_ = 0;
+  GLuint lighting_framebuffer_ = 0;
+  ui32 width_ = 0;
+  ui32 height_ = 0;
+};
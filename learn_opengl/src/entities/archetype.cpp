@@ -0,0 +1,209 @@
+#include "entities/archetype.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "memory/type_pools.hpp"
+
+namespace {
+[[nodiscard]] constexpr size_t AlignUp(size_t value,
+                                       size_t alignment) noexcept {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+}  // namespace
+
+void ArchetypeChunk::DataDeleter::operator()(ui8* data) const {
+  pools->Free(data, size, alignment);
+}
+
+Archetype::Archetype(std::vector<const cppreflection::Type*> types,
+                     TypePools& pools)
+    : types_(std::move(types)), pools_(&pools) {
+  [[unlikely]] if (types_.size() >= kNoColumn) {
+    throw std::runtime_error("Too many component types in archetype");
+  }
+
+  TypeIndices& type_indices = TypeIndices::Get();
+  column_by_type_.fill(kNoColumn);
+  chunk_alignment_ = alignof(Entity*);
+  size_t row_bytes = sizeof(Entity*);
+  columns_.reserve(types_.size());
+  for (const cppreflection::Type* type : types_) {
+    const cppreflection::SpecialMembers& special = type->GetSpecialMembers();
+    [[unlikely]] if (!special.defaultConstructor || !special.destructor ||
+                     (!special.moveConstructor && !special.copyConstructor)) {
+      throw std::runtime_error(fmt::format(
+          "{} can't be stored in archetype: it must be default "
+          "constructible, destructible and movable or copyable",
+          type->GetName()));
+    }
+
+    const ui32 type_index = type_indices.Register(*type);
+    assert(columns_.empty() || columns_.back().type_index < type_index);
+    column_by_type_[type_index] = static_cast<ui8>(columns_.size());
+    mask_.set(type_index);
+
+    ArchetypeColumn& column = columns_.emplace_back();
+    column.type = type;
+    column.type_index = type_index;
+    column.stride = AlignUp(type->GetInstanceSize(), type->GetAlignment());
+    chunk_alignment_ = std::max(chunk_alignment_, type->GetAlignment());
+    row_bytes += column.stride;
+  }
+
+  // The largest number of rows whose arrays fit into kChunkBytes. Very large
+  // components get chunks of one row.
+  auto compute_layout = [&](size_t capacity) {
+    size_t offset = sizeof(Entity*) * capacity;
+    for (ArchetypeColumn& column : columns_) {
+      offset = AlignUp(offset, column.type->GetAlignment());
+      column.offset = offset;
+      offset += column.stride * capacity;
+    }
+    return offset;
+  };
+
+  chunk_capacity_ = std::max<size_t>(kChunkBytes / row_bytes, 1);
+  chunk_bytes_ = compute_layout(chunk_capacity_);
+  while (chunk_bytes_ > kChunkBytes && chunk_capacity_ > 1) {
+    chunk_bytes_ = compute_layout(--chunk_capacity_);
+  }
+}
+
+Archetype::~Archetype() {
+  for (const ArchetypeChunk& chunk : chunks_) {
+    for (const ArchetypeColumn& column : columns_) {
+      for (size_t row = 0; row != chunk.size_; ++row) {
+        column.type->GetSpecialMembers().destructor(
+            chunk.GetComponent(column, row));
+      }
+    }
+  }
+}
+
+bool Archetype::HasAncestor(ui32 type_index) const noexcept {
+  const TypeIndices& type_indices = TypeIndices::Get();
+  const size_t num_types = type_indices.GetNumTypes();
+  [[unlikely]] if (ancestor_mask_num_types_.load(std::memory_order_acquire) !=
+                   num_types) {
+    TypeMask mask;
+    for (const ArchetypeColumn& column : columns_) {
+      mask |= type_indices.GetAncestors(column.type_index);
+    }
+    ancestor_mask_.Or(mask);
+    ancestor_mask_num_types_.store(num_types, std::memory_order_release);
+  }
+
+  return ancestor_mask_.Test(type_index);
+}
+
+ArchetypeLocation Archetype::AddRow(Entity* entity) {
+  [[unlikely]] if (chunks_.empty() ||
+                   chunks_.back().size_ == chunk_capacity_) {
+    AddChunk();
+  }
+
+  ArchetypeChunk& chunk = chunks_.back();
+  ArchetypeLocation location;
+  location.chunk = static_cast<ui32>(chunks_.size() - 1);
+  location.row = static_cast<ui32>(chunk.size_);
+  chunk.GetEntity(chunk.size_++) = entity;
+  ++size_;
+  return location;
+}
+
+void Archetype::Reserve(size_t num_rows) {
+  const size_t num_rows_total = size_ + num_rows;
+  chunks_.reserve((num_rows_total + chunk_capacity_ - 1) / chunk_capacity_);
+}
+
+Entity* Archetype::RemoveRow(ArchetypeLocation location,
+                             bool destroy_components) {
+  assert(location.chunk < chunks_.size());
+  ArchetypeChunk& chunk = chunks_[location.chunk];
+  assert(location.row < chunk.size_);
+
+  if (destroy_components) {
+    for (const ArchetypeColumn& column : columns_) {
+      column.type->GetSpecialMembers().destructor(
+          chunk.GetComponent(column, location.row));
+    }
+  }
+
+  ArchetypeChunk& last_chunk = chunks_.back();
+  const size_t last_row = last_chunk.size_ - 1;
+  Entity* moved = nullptr;
+  if (&last_chunk != &chunk || last_row != location.row) {
+    for (size_t column = 0; column != columns_.size(); ++column) {
+      RelocateComponent(*columns_[column].type,
+                        chunk.GetComponent(columns_[column], location.row),
+                        last_chunk.GetComponent(columns_[column], last_row));
+      chunk.MarkChanged(column, location.row,
+                        last_chunk.GetChangeVersion(column, last_row));
+    }
+
+    moved = last_chunk.GetEntity(last_row);
+    chunk.GetEntity(location.row) = moved;
+  }
+
+  --size_;
+  [[unlikely]] if (--last_chunk.size_ == 0) { chunks_.pop_back(); }
+
+  return moved;
+}
+
+void Archetype::ConstructComponent(ArchetypeLocation location,
+                                   size_t column) const {
+  columns_[column].type->GetSpecialMembers().defaultConstructor(
+      GetComponent(location, column));
+}
+
+void Archetype::RelocateComponent(const cppreflection::Type& type,
+                                  void* destination, void* source) {
+  const cppreflection::SpecialMembers& special = type.GetSpecialMembers();
+  [[likely]] if (special.moveConstructor) {
+    special.moveConstructor(destination, source);
+  } else {
+    special.copyConstructor(destination, source);
+  }
+  special.destructor(source);
+}
+
+Archetype* Archetype::FindAddEdge(
+    const cppreflection::Type* type) const noexcept {
+  const auto it = add_edges_.find(type);
+  return it != add_edges_.end() ? it->second : nullptr;
+}
+
+void Archetype::SetAddEdge(const cppreflection::Type* type,
+                           Archetype* archetype) {
+  add_edges_[type] = archetype;
+}
+
+Archetype* Archetype::FindRemoveEdge(
+    const cppreflection::Type* type) const noexcept {
+  const auto it = remove_edges_.find(type);
+  return it != remove_edges_.end() ? it->second : nullptr;
+}
+
+void Archetype::SetRemoveEdge(const cppreflection::Type* type,
+                              Archetype* archetype) {
+  remove_edges_[type] = archetype;
+}
+
+void Archetype::AddChunk() {
+  ArchetypeChunk& chunk = chunks_.emplace_back();
+  chunk.archetype_ = this;
+  chunk.data_ = std::unique_ptr<ui8[], ArchetypeChunk::DataDeleter>(
+      reinterpret_cast<ui8*>(
+          pools_->Allocate(chunk_bytes_, chunk_alignment_)),
+      {pools_, chunk_bytes_, chunk_alignment_});
+  chunk.capacity_ = chunk_capacity_;
+  chunk.row_versions_ =
+      std::make_unique<ui32[]>(columns_.size() * chunk_capacity_);
+  chunk.column_versions_ =
+      std::make_unique<std::atomic<ui32>[]>(columns_.size());
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "CppReflection/GetStaticTypeInfo.hpp"
+#include "CppReflection/TypeRegistry.hpp"
+#include "EverydayTools/GUID.hpp"
+#include "integer.hpp"
+#include "reflection/type_indices.hpp"
+
+class Archetype;
+class Entity;
+class TypePools;
+
+// Row of an entity in archetype storage
+struct ArchetypeLocation {
+  ui32 chunk = 0;
+  ui32 row = 0;
+
+  [[nodiscard]] bool operator==(const ArchetypeLocation&) const = default;
+};
+
+// Array of one component type inside each chunk
+struct ArchetypeColumn {
+  const cppreflection::Type* type = nullptr;
+  ui32 type_index = 0;
+  size_t stride = 0;
+  size_t offset = 0;
+};
+
+// Fixed size block of memory that keeps components of several entities of
+// one archetype. Components of every type are stored contiguously.
+class ArchetypeChunk {
+ public:
+  [[nodiscard]] size_t GetSize() const noexcept { return size_; }
+
+  [[nodiscard]] std::span<Entity* const> GetEntities() const noexcept {
+    return std::span(reinterpret_cast<Entity* const*>(data_.get()), size_);
+  }
+
+  // Column must store exactly T
+  template <typename T>
+  [[nodiscard]] std::span<T> GetComponents(size_t column) const noexcept;
+
+  // Empty if the archetype has no column of exactly T
+  template <typename T>
+  [[nodiscard]] std::span<T> FindComponents() const noexcept;
+
+  [[nodiscard]] const Archetype& GetArchetype() const noexcept {
+    return *archetype_;
+  }
+
+  // World change version of the last write to the component
+  [[nodiscard]] ui32 GetChangeVersion(size_t column,
+                                      size_t row) const noexcept {
+    return row_versions_[column * capacity_ + row];
+  }
+
+  // The latest change version of the column in this chunk
+  [[nodiscard]] ui32 GetColumnChangeVersion(size_t column) const noexcept {
+    return column_versions_[column].load(std::memory_order_relaxed);
+  }
+
+  // Rows are written by one thread at a time. Concurrent writers of a
+  // column use the same version, so the column maximum can't go backwards.
+  void MarkChanged(size_t column, size_t row, ui32 version) const noexcept {
+    row_versions_[column * capacity_ + row] = version;
+    std::atomic<ui32>& column_version = column_versions_[column];
+    [[unlikely]] if (column_version.load(std::memory_order_relaxed) <
+                     version) {
+      column_version.store(version, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  friend class Archetype;
+
+  class DataDeleter {
+   public:
+    void operator()(ui8* data) const;
+
+    TypePools* pools;
+    size_t size;
+    size_t alignment;
+  };
+
+  [[nodiscard]] void* GetComponent(const ArchetypeColumn& column,
+                                   size_t row) const noexcept {
+    return data_.get() + column.offset + column.stride * row;
+  }
+
+  [[nodiscard]] Entity*& GetEntity(size_t row) const noexcept {
+    return reinterpret_cast<Entity**>(data_.get())[row];
+  }
+
+ private:
+  const Archetype* archetype_ = nullptr;
+  std::unique_ptr<ui8[], DataDeleter> data_;
+  // Per column: versions of all rows, the latest one
+  std::unique_ptr<ui32[]> row_versions_;
+  std::unique_ptr<std::atomic<ui32>[]> column_versions_;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+};
+
+// Storage of all entities that have the same set of component types.
+// Entities are packed into chunks without holes: removing a row moves the
+// last row into its place.
+class Archetype {
+ public:
+  static constexpr size_t kChunkBytes = 16 * 1024;
+
+  // Types must be unique and sorted by TypeIndices index. Chunks are
+  // allocated from pools.
+  Archetype(std::vector<const cppreflection::Type*> types, TypePools& pools);
+  Archetype(const Archetype&) = delete;
+  ~Archetype();
+
+  [[nodiscard]] std::span<const cppreflection::Type* const> GetTypes()
+      const noexcept {
+    return types_;
+  }
+  [[nodiscard]] std::span<const ArchetypeColumn> GetColumns() const noexcept {
+    return columns_;
+  }
+  [[nodiscard]] std::optional<size_t> FindColumn(
+      ui32 type_index) const noexcept {
+    const ui8 column = column_by_type_[type_index];
+    [[likely]] if (column != kNoColumn) { return column; }
+    return std::nullopt;
+  }
+
+  // Exact types of components
+  [[nodiscard]] const TypeMask& GetMask() const noexcept { return mask_; }
+  // If any of components IsA the type
+  [[nodiscard]] bool HasAncestor(ui32 type_index) const noexcept;
+
+  [[nodiscard]] size_t GetSize() const noexcept { return size_; }
+  [[nodiscard]] size_t GetChunkCapacity() const noexcept {
+    return chunk_capacity_;
+  }
+  [[nodiscard]] std::span<const ArchetypeChunk> GetChunks() const noexcept {
+    return chunks_;
+  }
+
+  // Appends a row. Components of the row are not constructed and their
+  // change versions must be set.
+  ArchetypeLocation AddRow(Entity* entity);
+
+  // Room for this many more rows without moving the chunk list
+  void Reserve(size_t num_rows);
+
+  // Removes the row and moves the last one into its place with its change
+  // versions. Components of the row are destroyed unless they were
+  // relocated already. Returns the entity whose row moved or nullptr.
+  Entity* RemoveRow(ArchetypeLocation location, bool destroy_components);
+
+  [[nodiscard]] void* GetComponent(ArchetypeLocation location,
+                                   size_t column) const noexcept {
+    return chunks_[location.chunk].GetComponent(columns_[column],
+                                                location.row);
+  }
+
+  void ConstructComponent(ArchetypeLocation location, size_t column) const;
+
+  [[nodiscard]] ui32 GetChangeVersion(ArchetypeLocation location,
+                                      size_t column) const noexcept {
+    return chunks_[location.chunk].GetChangeVersion(column, location.row);
+  }
+  void MarkChanged(ArchetypeLocation location, size_t column,
+                   ui32 version) const noexcept {
+    chunks_[location.chunk].MarkChanged(column, location.row, version);
+  }
+
+  // Move constructs an object at destination and destroys the source
+  static void RelocateComponent(const cppreflection::Type& type,
+                                void* destination, void* source);
+
+  // Cached transitions to archetypes with one more component type
+  [[nodiscard]] Archetype* FindAddEdge(
+      const cppreflection::Type* type) const noexcept;
+  void SetAddEdge(const cppreflection::Type* type, Archetype* archetype);
+  // Same for archetypes with one component type less
+  [[nodiscard]] Archetype* FindRemoveEdge(
+      const cppreflection::Type* type) const noexcept;
+  void SetRemoveEdge(const cppreflection::Type* type, Archetype* archetype);
+
+  Archetype& operator=(const Archetype&) = delete;
+
+ private:
+  void AddChunk();
+
+ private:
+  static constexpr ui8 kNoColumn = 0xFF;
+
+  std::vector<const cppreflection::Type*> types_;
+  std::vector<ArchetypeColumn> columns_;
+  std::array<ui8, kMaxIndexedTypes> column_by_type_;
+  TypeMask mask_;
+  // Extended when more types get indices: one of them may be a base. Called
+  // concurrently, masks only grow so racing updates agree.
+  mutable AtomicTypeMask ancestor_mask_;
+  mutable std::atomic<size_t> ancestor_mask_num_types_ = 0;
+  std::vector<ArchetypeChunk> chunks_;
+  std::unordered_map<const cppreflection::Type*, Archetype*> add_edges_;
+  std::unordered_map<const cppreflection::Type*, Archetype*> remove_edges_;
+  TypePools* pools_;
+  size_t chunk_capacity_ = 0;
+  size_t chunk_bytes_ = 0;
+  size_t chunk_alignment_ = 0;
+  size_t size_ = 0;
+};
+
+template <typename T>
+std::span<T> ArchetypeChunk::GetComponents(size_t column) const noexcept {
+  const ArchetypeColumn& c = archetype_->GetColumns()[column];
+  assert(c.stride == sizeof(T));
+  return std::span(reinterpret_cast<T*>(data_.get() + c.offset), size_);
+}
+
+template <typename T>
+std::span<T> ArchetypeChunk::FindComponents() const noexcept {
+  [[likely]] if (auto column =
+                     archetype_->FindColumn(TypeIndices::IndexOf<T>())) {
+    return GetComponents<T>(*column);
+  }
+  return {};
+}
@@ -8,12 +8,7 @@
 #include "EverydayTools/GUID_fmtlib.hpp"
 #include "components/component.hpp"
 #include "imgui.h"
-#include "memory/memory.hpp"
-
-void Entity::ComponentDeleter::operator()(Component* component) const {
-  component->~Component();
-  Memory::AlignedFree(component);
-}
+#include "world.hpp"
 
 Entity::Entity() = default;
 Entity::~Entity() noexcept = default;
@@ -36,22 +31,51 @@ Component* Entity::AddComponent(edt::GUID type_guid) {
     throw std::runtime_error(
         fmt::format("{} is not a component", type_info->GetName()));
   }
-  void* memory = Memory::AlignedAlloc(type_info->GetInstanceSize(),
-                                      type_info->GetAlignment());
-  type_info->GetSpecialMembers().defaultConstructor(memory);
-  ComponentPtr component(reinterpret_cast<Component*>(memory));
-  components_.push_back(std::move(component));
-  return components_.back().get();
+
+  [[unlikely]] if (!world_) {
+    throw std::runtime_error(
+        fmt::format("{} does not belong to a world", GetName()));
+  }
+
+  return world_->AddComponent(*this, *type_info);
+}
+
+void Entity::RemoveComponent(edt::GUID type_guid) {
+  const cppreflection::Type* type_info =
+      cppreflection::GetTypeRegistry()->FindType(type_guid);
+  [[unlikely]] if (!type_info) {
+    throw std::runtime_error(fmt::format("Unknown type: {}", type_guid));
+  }
+
+  [[unlikely]] if (!world_) {
+    throw std::runtime_error(
+        fmt::format("{} does not belong to a world", GetName()));
+  }
+
+  world_->RemoveComponent(*this, *type_info);
 }
 
 void Entity::DrawDetails() {
   if (ImGui::TreeNode(name_.data())) {
+    ImGui::Checkbox("static", &is_static_);
     if (ImGui::TreeNode("Components")) {
-      ForEachComp([&](Component& c) { c.DrawDetails(); });
+      // Edits are writes for change queries
+      for (size_t column = 0; column != archetype_->GetColumns().size();
+           ++column) {
+        auto* component = reinterpret_cast<Component*>(
+            archetype_->GetComponent(location_, column));
+        if (component->DrawDetails()) {
+          MarkChanged(column);
+        }
+      }
       ImGui::TreePop();
     }
     ImGui::TreePop();
   }
 }
 
+void Entity::MarkChanged(size_t column) const noexcept {
+  archetype_->MarkChanged(location_, column, world_->GetChangeVersion());
+}
+
 void Entity::SetName(const std::string_view& name) { name_ = name; }
\ No newline at end of file
@@ -1,14 +1,19 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string_view>
 #include <vector>
 
 #include "CppReflection/GetStaticTypeInfo.hpp"
 #include "EverydayTools/GUID.hpp"
 #include "components/component.hpp"
+#include "entities/archetype.hpp"
+#include "entities/entity_handle.hpp"
 #include "integer.hpp"
 
+class World;
+
 class Entity {
  public:
   Entity();
@@ -21,6 +26,10 @@ class Entity {
   [[nodiscard]] size_t GetId() const noexcept { return id_; }
   [[nodiscard]] const std::string_view GetName() const { return name_; }
 
+  // Static entities are not expected to move and may be merged into batches
+  void SetStatic(bool is_static) noexcept { is_static_ = is_static; }
+  [[nodiscard]] bool IsStatic() const noexcept { return is_static_; }
+
   Entity& operator=(const Entity&) = delete;
 
   template <typename T = Component, typename F>
@@ -28,35 +37,117 @@ class Entity {
 
   template <typename T>
   T& AddComponent();
+  template <typename T>
+  void RemoveComponent();
   [[nodiscard]] virtual edt::GUID GetTypeGUID() const noexcept;
+
+  // Moves the entity to another archetype, so references to its components
+  // obtained earlier become invalid. Entity can't have two components of the
+  // same type.
   Component* AddComponent(edt::GUID type_guid);
+  // Same for the component of exactly this type, which must exist
+  void RemoveComponent(edt::GUID type_guid);
+
+  [[nodiscard]] World* GetWorld() const noexcept { return world_; }
+  [[nodiscard]] EntityHandle GetHandle() const noexcept { return handle_; }
+  [[nodiscard]] Archetype* GetArchetype() const noexcept { return archetype_; }
+  [[nodiscard]] ArchetypeLocation GetLocation() const noexcept {
+    return location_;
+  }
+
+  // Exact types of components of the entity
+  [[nodiscard]] const TypeMask& GetComponentMask() const noexcept {
+    return archetype_->GetMask();
+  }
+
+  // True if any of components IsA T
+  template <typename T>
+  [[nodiscard]] bool HasComponent() const noexcept;
+
+  // Returns the first component which IsA T and marks it as written, so
+  // that change queries see the modification. Null if there is none.
+  template <typename T>
+  [[nodiscard]] T* ModifyComponent();
+
+  // Same without marking, for reads
+  template <typename T>
+  [[nodiscard]] const T* FindComponent() const;
 
  private:
-  class ComponentDeleter {
-   public:
-    void operator()(Component*) const;
-  };
-  using ComponentPtr = std::unique_ptr<Component, ComponentDeleter>;
+  friend class World;
+
+  template <typename T>
+  [[nodiscard]] std::optional<size_t> FindComponentColumn() const;
+  void MarkChanged(size_t column) const noexcept;
 
  private:
   std::string name_;
-  std::vector<ComponentPtr> components_;
+  World* world_ = nullptr;
+  EntityHandle handle_;
+  // Components live in archetype storage owned by world
+  Archetype* archetype_ = nullptr;
+  ArchetypeLocation location_;
   size_t id_;
+  bool is_static_ = false;
 };
 
 template <typename T, typename F>
 void Entity::ForEachComp(F&& f) {
-  cppreflection::TypeRegistry* type_registry = cppreflection::GetTypeRegistry();
-  constexpr edt::GUID filter_guid = cppreflection::GetStaticTypeGUID<T>();
-  for (auto& component : components_) {
-    const auto type_guid = component->GetTypeGUID();
-    const cppreflection::Type* type = type_registry->FindType(type_guid);
-    if (type->IsA(filter_guid)) {
-      f(*static_cast<T*>(component.get()));
+  const ui32 filter = TypeIndices::IndexOf<T>();
+  [[unlikely]] if (!archetype_ || !archetype_->HasAncestor(filter)) {
+    return;
+  }
+
+  const TypeIndices& type_indices = TypeIndices::Get();
+  const std::span<const ArchetypeColumn> columns = archetype_->GetColumns();
+  for (size_t column = 0; column != columns.size(); ++column) {
+    if (type_indices.IsA(columns[column].type_index, filter)) {
+      void* component = archetype_->GetComponent(location_, column);
+      f(*static_cast<T*>(reinterpret_cast<Component*>(component)));
     }
   }
 }
 
+template <typename T>
+bool Entity::HasComponent() const noexcept {
+  return archetype_ && archetype_->HasAncestor(TypeIndices::IndexOf<T>());
+}
+
+template <typename T>
+std::optional<size_t> Entity::FindComponentColumn() const {
+  const ui32 filter = TypeIndices::IndexOf<T>();
+  [[unlikely]] if (!HasComponent<T>()) { return std::nullopt; }
+
+  const TypeIndices& type_indices = TypeIndices::Get();
+  const std::span<const ArchetypeColumn> columns = archetype_->GetColumns();
+  for (size_t column = 0; column != columns.size(); ++column) {
+    if (type_indices.IsA(columns[column].type_index, filter)) {
+      return column;
+    }
+  }
+
+  return std::nullopt;
+}
+
+template <typename T>
+T* Entity::ModifyComponent() {
+  const std::optional<size_t> column = FindComponentColumn<T>();
+  [[unlikely]] if (!column) { return nullptr; }
+
+  MarkChanged(*column);
+  return static_cast<T*>(reinterpret_cast<Component*>(
+      archetype_->GetComponent(location_, *column)));
+}
+
+template <typename T>
+const T* Entity::FindComponent() const {
+  const std::optional<size_t> column = FindComponentColumn<T>();
+  [[unlikely]] if (!column) { return nullptr; }
+
+  return static_cast<const T*>(reinterpret_cast<const Component*>(
+      archetype_->GetComponent(location_, *column)));
+}
+
 template <typename T>
 T& Entity::AddComponent() {
   const auto type_guid = cppreflection::GetStaticTypeInfo<T>().guid;
@@ -64,6 +155,11 @@ T& Entity::AddComponent() {
   return *static_cast<T*>(component_base);
 }
 
+template <typename T>
+void Entity::RemoveComponent() {
+  RemoveComponent(cppreflection::GetStaticTypeInfo<T>().guid);
+}
+
 template <typename T>
 class SimpleEntityBase : public Entity {
  public:
@@ -0,0 +1,219 @@
+#include "entities/entity_command_buffer.hpp"
+
+#include <fmt/format.h>
+
+#include <stdexcept>
+
+#include "CppReflection/TypeRegistry.hpp"
+#include "EverydayTools/GUID_fmtlib.hpp"
+#include "components/component.hpp"
+#include "entities/entity.hpp"
+#include "entities/prefab.hpp"
+#include "reflection/type_indices.hpp"
+#include "template/on_scope_leave.hpp"
+#include "world.hpp"
+
+EntityCommandBuffer::EntityCommandBuffer() : values_(0, MemoryTag::Ecs) {}
+EntityCommandBuffer::~EntityCommandBuffer() { Clear(); }
+
+PendingEntity EntityCommandBuffer::Spawn(const Prefab& prefab) {
+  commands_.push_back({CommandType::Spawn, EntityHandle{}, nullptr, &prefab});
+  return {num_pending_++};
+}
+
+PendingEntity EntityCommandBuffer::Spawn(edt::GUID entity_type) {
+  constexpr edt::GUID entity_guid =
+      cppreflection::GetStaticTypeInfo<Entity>().guid;
+  const cppreflection::Type* type =
+      cppreflection::GetTypeRegistry()->FindType(entity_type);
+  [[unlikely]] if (!type || !type->IsA(entity_guid)) {
+    throw std::runtime_error(
+        fmt::format("{} is not an entity type", entity_type));
+  }
+
+  commands_.push_back({CommandType::Spawn, EntityHandle{}, type});
+  return {num_pending_++};
+}
+
+void EntityCommandBuffer::Destroy(CommandTarget entity) {
+  commands_.push_back({CommandType::Destroy, entity});
+}
+
+Component& EntityCommandBuffer::AddComponent(CommandTarget entity,
+                                             edt::GUID type_guid) {
+  return StageComponent(CommandType::AddComponent, entity,
+                        FindComponentType(type_guid));
+}
+
+Component& EntityCommandBuffer::SetComponent(CommandTarget entity,
+                                             edt::GUID type_guid) {
+  return StageComponent(CommandType::SetComponent, entity,
+                        FindComponentType(type_guid));
+}
+
+void EntityCommandBuffer::RemoveComponent(CommandTarget entity,
+                                          edt::GUID type_guid) {
+  commands_.push_back(
+      {CommandType::RemoveComponent, entity, &FindComponentType(type_guid)});
+}
+
+void EntityCommandBuffer::Playback(World& world) {
+  auto clear = OnScopeLeave([this]() { Clear(); });
+  SpawnPending(world);
+  for (const Command& command : commands_) {
+    [[likely]] if (command.type != CommandType::Spawn) {
+      Apply(world, command);
+    }
+  }
+}
+
+const cppreflection::Type& EntityCommandBuffer::FindComponentType(
+    edt::GUID type_guid) {
+  constexpr edt::GUID component_guid =
+      cppreflection::GetStaticTypeInfo<Component>().guid;
+  const cppreflection::Type* type =
+      cppreflection::GetTypeRegistry()->FindType(type_guid);
+  [[unlikely]] if (!type || !type->IsA(component_guid)) {
+    throw std::runtime_error(
+        fmt::format("{} is not a component type", type_guid));
+  }
+  return *type;
+}
+
+Component& EntityCommandBuffer::StageComponent(
+    CommandType type, CommandTarget entity,
+    const cppreflection::Type& component_type) {
+  const cppreflection::SpecialMembers& special =
+      component_type.GetSpecialMembers();
+  [[unlikely]] if (!special.defaultConstructor ||
+                   (!special.moveAssign && !special.copyAssign)) {
+    throw std::runtime_error(fmt::format(
+        "{} can't be recorded: it must be default constructible and "
+        "assignable",
+        component_type.GetName()));
+  }
+
+  void* value = values_.allocate(component_type.GetInstanceSize(),
+                                 component_type.GetAlignment());
+  Command& command = commands_.emplace_back(type, entity, &component_type);
+  try {
+    special.defaultConstructor(value);
+  } catch (...) {
+    commands_.pop_back();
+    throw;
+  }
+
+  command.value = reinterpret_cast<Component*>(value);
+  return *command.value;
+}
+
+EntityHandle EntityCommandBuffer::Resolve(
+    CommandTarget target) const noexcept {
+  [[likely]] if (target.pending_ == CommandTarget::kNotPending) {
+    return target.handle_;
+  }
+
+  // Pending entity of another buffer resolves to nothing
+  [[likely]] if (target.pending_ < spawned_.size()) {
+    return spawned_[target.pending_];
+  }
+  return {};
+}
+
+void EntityCommandBuffer::SpawnPending(World& world) {
+  spawned_.resize(num_pending_);
+  size_t pending = 0;
+  size_t i = 0;
+  while (i != commands_.size()) {
+    const Command& command = commands_[i];
+    [[likely]] if (command.type != CommandType::Spawn) {
+      ++i;
+      continue;
+    }
+
+    [[unlikely]] if (!command.prefab) {
+      const edt::GUID type_guid = command.value_type->GetGuid();
+      spawned_[pending++] = world.SpawnEntity(type_guid).GetHandle();
+      ++i;
+      continue;
+    }
+
+    // Spawns are applied before other commands, so those between spawns of
+    // one prefab don't break the batch
+    size_t count = 0;
+    for (; i != commands_.size(); ++i) {
+      const Command& next = commands_[i];
+      if (next.type != CommandType::Spawn) {
+        continue;
+      }
+      if (next.prefab != command.prefab) {
+        break;
+      }
+      ++count;
+    }
+
+    const EntityHandleRange range = world.SpawnMany(*command.prefab, count);
+    for (size_t j = 0; j != count; ++j) {
+      spawned_[pending++] = range[j];
+    }
+  }
+}
+
+void EntityCommandBuffer::Apply(World& world, const Command& command) {
+  Entity* entity = world.GetEntity(Resolve(command.target));
+  [[unlikely]] if (!entity) { return; }
+
+  auto assign = [&](void* component) {
+    const cppreflection::SpecialMembers& special =
+        command.value_type->GetSpecialMembers();
+    [[likely]] if (special.moveAssign) {
+      special.moveAssign(component, command.value);
+    } else {
+      special.copyAssign(component, command.value);
+    }
+  };
+
+  switch (command.type) {
+    case CommandType::Destroy:
+      world.DestroyEntity(entity->GetHandle());
+      break;
+
+    case CommandType::AddComponent:
+      assign(world.AddComponent(*entity, *command.value_type));
+      break;
+
+    case CommandType::SetComponent: {
+      const ui32 type_index = TypeIndices::Get().Register(*command.value_type);
+      const Archetype& archetype = *entity->GetArchetype();
+      const auto column = archetype.FindColumn(type_index);
+      [[unlikely]] if (!column) {
+        throw std::runtime_error(
+            fmt::format("{} doesn't have {}", entity->GetName(),
+                        command.value_type->GetName()));
+      }
+      assign(archetype.GetComponent(entity->GetLocation(), *column));
+      world.MarkChanged(*entity, type_index);
+      break;
+    }
+
+    case CommandType::RemoveComponent:
+      world.RemoveComponent(*entity, *command.value_type);
+      break;
+
+    case CommandType::Spawn:
+      break;
+  }
+}
+
+void EntityCommandBuffer::Clear() noexcept {
+  for (const Command& command : commands_) {
+    if (command.value) {
+      command.value_type->GetSpecialMembers().destructor(command.value);
+    }
+  }
+
+  commands_.clear();
+  spawned_.clear();
+  num_pending_ = 0;
+  values_.Reset();
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+
+#include "CppReflection/GetTypeInfo.hpp"
+#include "EverydayTools/GUID.hpp"
+#include "entities/entity_handle.hpp"
+#include "integer.hpp"
+#include "memory/linear_arena.hpp"
+
+class Component;
+class Prefab;
+class World;
+
+// Entity spawned by a command that has not been played back yet. Valid only
+// in the buffer which recorded the spawn.
+struct PendingEntity {
+  ui32 index = 0;
+};
+
+// Entity that a command applies to: an existing one or a pending one
+class CommandTarget {
+ public:
+  CommandTarget(EntityHandle handle) noexcept : handle_(handle) {}
+  CommandTarget(PendingEntity entity) noexcept : pending_(entity.index) {}
+
+ private:
+  friend class EntityCommandBuffer;
+
+  static constexpr ui32 kNotPending = ~ui32{0};
+
+  EntityHandle handle_;
+  ui32 pending_ = kNotPending;
+};
+
+// Structural changes recorded while the world can't change structurally,
+// e.g. from systems that run concurrently, and applied at a sync point by
+// World::PlaybackCommands. Every job system worker records into its own
+// buffer, see World::GetCommandBuffer, so recording takes no locks.
+//
+// Playback spawns pending entities first, batching consecutive spawns of
+// one prefab into World::SpawnMany. Other commands follow in the order they
+// were recorded. Commands of entities destroyed by then are skipped.
+class EntityCommandBuffer {
+ public:
+  EntityCommandBuffer();
+  EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+  ~EntityCommandBuffer();
+
+  // Prefab must be alive until playback
+  PendingEntity Spawn(const Prefab& prefab);
+  PendingEntity Spawn(edt::GUID entity_type);
+
+  void Destroy(CommandTarget entity);
+
+  // Returns the value the component gets when it is added at playback
+  template <typename T>
+  T& AddComponent(CommandTarget entity);
+  Component& AddComponent(CommandTarget entity, edt::GUID type_guid);
+
+  // Returns the value assigned at playback to the component of exactly this
+  // type, which the entity must have by then
+  template <typename T>
+  T& SetComponent(CommandTarget entity);
+  Component& SetComponent(CommandTarget entity, edt::GUID type_guid);
+
+  template <typename T>
+  void RemoveComponent(CommandTarget entity);
+  void RemoveComponent(CommandTarget entity, edt::GUID type_guid);
+
+  [[nodiscard]] bool IsEmpty() const noexcept { return commands_.empty(); }
+  [[nodiscard]] size_t GetNumCommands() const noexcept {
+    return commands_.size();
+  }
+
+  // Applies and clears the commands. Buffer is cleared even if a command
+  // throws.
+  void Playback(World& world);
+
+  EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+ private:
+  enum class CommandType : ui8 {
+    Spawn,
+    Destroy,
+    AddComponent,
+    SetComponent,
+    RemoveComponent
+  };
+
+  struct Command {
+    CommandType type;
+    CommandTarget target;
+    // Entity type of spawns without a prefab, component type otherwise
+    const cppreflection::Type* value_type = nullptr;
+    const Prefab* prefab = nullptr;
+    // Staged component of add and set commands
+    Component* value = nullptr;
+  };
+
+  [[nodiscard]] static const cppreflection::Type& FindComponentType(
+      edt::GUID type_guid);
+  Component& StageComponent(CommandType type, CommandTarget entity,
+                            const cppreflection::Type& component_type);
+  [[nodiscard]] EntityHandle Resolve(CommandTarget target) const noexcept;
+  void SpawnPending(World& world);
+  void Apply(World& world, const Command& command);
+  void Clear() noexcept;
+
+ private:
+  std::vector<Command> commands_;
+  // Handles of pending entities, filled at playback
+  std::vector<EntityHandle> spawned_;
+  ui32 num_pending_ = 0;
+  // Staged components live here until playback
+  LinearArena values_;
+};
+
+template <typename T>
+T& EntityCommandBuffer::AddComponent(CommandTarget entity) {
+  return static_cast<T&>(StageComponent(CommandType::AddComponent, entity,
+                                        *cppreflection::GetTypeInfo<T>()));
+}
+
+template <typename T>
+T& EntityCommandBuffer::SetComponent(CommandTarget entity) {
+  return static_cast<T&>(StageComponent(CommandType::SetComponent, entity,
+                                        *cppreflection::GetTypeInfo<T>()));
+}
+
+template <typename T>
+void EntityCommandBuffer::RemoveComponent(CommandTarget entity) {
+  commands_.push_back({CommandType::RemoveComponent, entity,
+                       cppreflection::GetTypeInfo<T>()});
+}
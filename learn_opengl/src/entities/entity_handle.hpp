@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "integer.hpp"
+
+// Stable reference to an entity of a world. Slot index is reused after the
+// entity is destroyed, generation tells the new entity apart from the old
+// one, so stale handles fail validation instead of pointing to a stranger.
+struct EntityHandle {
+  static constexpr ui32 kInvalidIndex = ~ui32{0};
+
+  [[nodiscard]] bool IsValid() const noexcept {
+    return index != kInvalidIndex;
+  }
+
+  [[nodiscard]] bool operator==(const EntityHandle&) const = default;
+
+  ui32 index = kInvalidIndex;
+  // Zero is never used by alive entities
+  ui32 generation = 0;
+};
+
+// Handles of entities spawned together: slot indices are consecutive and
+// all slots were never used before
+struct EntityHandleRange {
+  [[nodiscard]] size_t GetSize() const noexcept { return size; }
+  [[nodiscard]] bool IsEmpty() const noexcept { return size == 0; }
+
+  [[nodiscard]] EntityHandle operator[](size_t index) const noexcept {
+    return {first_index + static_cast<ui32>(index), generation};
+  }
+
+  ui32 first_index = 0;
+  ui32 size = 0;
+  ui32 generation = 1;
+};
+
+template <>
+struct std::hash<EntityHandle> {
+  [[nodiscard]] size_t operator()(const EntityHandle& handle) const noexcept {
+    return std::hash<ui64>{}((ui64{handle.generation} << 32) | handle.index);
+  }
+};
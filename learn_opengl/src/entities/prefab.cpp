@@ -0,0 +1,83 @@
+#include "entities/prefab.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+#include "CppReflection/TypeRegistry.hpp"
+#include "EverydayTools/GUID_fmtlib.hpp"
+#include "components/component.hpp"
+#include "memory/memory.hpp"
+#include "reflection/type_indices.hpp"
+
+Prefab::Prefab(edt::GUID entity_type) {
+  constexpr edt::GUID entity_guid =
+      cppreflection::GetStaticTypeInfo<Entity>().guid;
+  entity_type_ = cppreflection::GetTypeRegistry()->FindType(entity_type);
+  [[unlikely]] if (!entity_type_) {
+    throw std::runtime_error(fmt::format("Unknown type: {}", entity_type));
+  }
+  [[unlikely]] if (!entity_type_->IsA(entity_guid)) {
+    throw std::runtime_error(
+        fmt::format("{} is not an entity", entity_type_->GetName()));
+  }
+}
+
+Prefab::~Prefab() {
+  for (size_t i = 0; i != types_.size(); ++i) {
+    types_[i]->GetSpecialMembers().destructor(prototypes_[i]);
+    Memory::AlignedFree(prototypes_[i]);
+  }
+}
+
+Component& Prefab::AddComponent(edt::GUID type_guid) {
+  constexpr edt::GUID component_guid =
+      cppreflection::GetStaticTypeInfo<Component>().guid;
+  const cppreflection::Type* type =
+      cppreflection::GetTypeRegistry()->FindType(type_guid);
+  [[unlikely]] if (!type) {
+    throw std::runtime_error(fmt::format("Unknown type: {}", type_guid));
+  }
+  [[unlikely]] if (!type->IsA(component_guid)) {
+    throw std::runtime_error(
+        fmt::format("{} is not a component", type->GetName()));
+  }
+
+  const cppreflection::SpecialMembers& special = type->GetSpecialMembers();
+  [[unlikely]] if (!special.defaultConstructor || !special.copyConstructor) {
+    throw std::runtime_error(fmt::format(
+        "{} can't be in a prefab: it must be default and copy constructible",
+        type->GetName()));
+  }
+
+  TypeIndices& type_indices = TypeIndices::Get();
+  const ui32 type_index = type_indices.Register(*type);
+  const auto position = std::ranges::lower_bound(
+      types_, type_index, {}, [&](const cppreflection::Type* t) {
+        return type_indices.Register(*t);
+      });
+  [[unlikely]] if (position != types_.end() && *position == type) {
+    throw std::runtime_error(
+        fmt::format("Prefab already has {}", type->GetName()));
+  }
+
+  // Nothing throws once the prototype is constructed
+  const ptrdiff_t index = position - types_.begin();
+  types_.reserve(types_.size() + 1);
+  prototypes_.reserve(prototypes_.size() + 1);
+  void* prototype = Memory::AlignedAlloc(type->GetInstanceSize(),
+                                         type->GetAlignment(), MemoryTag::Ecs);
+  [[unlikely]] if (!prototype) { throw std::bad_alloc(); }
+  try {
+    special.defaultConstructor(prototype);
+  } catch (...) {
+    Memory::AlignedFree(prototype);
+    throw;
+  }
+
+  prototypes_.insert(prototypes_.begin() + index, prototype);
+  types_.insert(types_.begin() + index, type);
+  return *reinterpret_cast<Component*>(prototype);
+}
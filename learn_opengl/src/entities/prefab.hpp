@@ -0,0 +1,66 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CppReflection/GetStaticTypeInfo.hpp"
+#include "EverydayTools/GUID.hpp"
+#include "entities/entity.hpp"
+#include "integer.hpp"
+
+class Component;
+
+// Template of an entity: its type and components with default values.
+// World::SpawnMany copy constructs components of all spawned entities from
+// the prototypes kept here.
+class Prefab {
+ public:
+  explicit Prefab(
+      edt::GUID entity_type = cppreflection::GetStaticTypeInfo<Entity>().guid);
+  Prefab(const Prefab&) = delete;
+  ~Prefab();
+
+  // Returns the prototype to set default values on. Prefab can't have two
+  // components of the same type.
+  template <typename T>
+  T& AddComponent();
+  Component& AddComponent(edt::GUID type_guid);
+
+  // Spawned entities share the name
+  void SetName(std::string_view name) { name_ = name; }
+  [[nodiscard]] std::string_view GetName() const noexcept { return name_; }
+
+  void SetStatic(bool is_static) noexcept { is_static_ = is_static; }
+  [[nodiscard]] bool IsStatic() const noexcept { return is_static_; }
+
+  [[nodiscard]] const cppreflection::Type& GetEntityType() const noexcept {
+    return *entity_type_;
+  }
+
+  // Sorted by TypeIndices index, the same way archetypes keep them
+  [[nodiscard]] std::span<const cppreflection::Type* const> GetTypes()
+      const noexcept {
+    return types_;
+  }
+  // Prototype of the component with type GetTypes()[index]
+  [[nodiscard]] const void* GetPrototype(size_t index) const noexcept {
+    return prototypes_[index];
+  }
+
+  Prefab& operator=(const Prefab&) = delete;
+
+ private:
+  const cppreflection::Type* entity_type_ = nullptr;
+  std::vector<const cppreflection::Type*> types_;
+  std::vector<void*> prototypes_;
+  std::string name_ = "Entity";
+  bool is_static_ = false;
+};
+
+template <typename T>
+T& Prefab::AddComponent() {
+  const auto type_guid = cppreflection::GetStaticTypeInfo<T>().guid;
+  return static_cast<T&>(AddComponent(type_guid));
+}
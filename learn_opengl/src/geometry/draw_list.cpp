@@ -0,0 +1,119 @@
+#include "geometry/draw_list.hpp"
+
+#include <algorithm>
+#include <memory>
+
+#include "opengl/stream_buffer.hpp"
+
+namespace {
+// Assignment would keep the old allocator of a pmr container
+template <typename T>
+void Rebind(std::pmr::vector<T>& vector,
+            std::pmr::memory_resource* resource) noexcept {
+  std::destroy_at(&vector);
+  std::construct_at(&vector, resource);
+}
+}  // namespace
+
+void DrawList::Clear() noexcept {
+  peak_commands_ = std::max(peak_commands_, commands_.size());
+  peak_models_ = std::max(peak_models_, models_.size());
+  commands_.clear();
+  models_.clear();
+}
+
+void DrawList::Reset(std::pmr::memory_resource* resource) {
+  Clear();
+  Rebind(commands_, resource);
+  Rebind(models_, resource);
+  Rebind(counts_, resource);
+  Rebind(offsets_, resource);
+  Rebind(base_vertices_, resource);
+  commands_.reserve(peak_commands_);
+  models_.reserve(peak_models_);
+  peak_commands_ = 0;
+  peak_models_ = 0;
+}
+
+void DrawList::Add(const GeometryAllocation& geometry,
+                   const Eigen::Matrix4f& model) {
+  Add(geometry, 0, geometry.num_indices, model);
+}
+
+void DrawList::Add(const GeometryAllocation& geometry, ui32 first_index,
+                   ui32 num_indices, const Eigen::Matrix4f& model) {
+  [[unlikely]] if (num_indices == 0) { return; }
+
+  if (models_.empty() || models_.back() != model) {
+    models_.push_back(model);
+  }
+
+  DrawElementsIndirectCommand& command = commands_.emplace_back();
+  command.count = num_indices;
+  command.instance_count = 1;
+  command.first_index = geometry.first_index + first_index;
+  command.base_vertex = static_cast<GLint>(geometry.first_vertex);
+  command.base_instance = static_cast<GLuint>(models_.size() - 1);
+}
+
+ui32 DrawList::Submit(GeometryArena& arena, StreamBuffer& stream_buffer,
+                      bool allow_indirect) {
+  [[unlikely]] if (commands_.empty()) { return 0; }
+
+  const StreamAllocation models = stream_buffer.Allocate(
+      sizeof(Eigen::Matrix4f) * models_.size(), alignof(Eigen::Matrix4f));
+  std::ranges::copy(models_, models.As<Eigen::Matrix4f>().begin());
+
+  arena.Bind();
+
+  // base_instance is ignored by glMultiDrawElementsBaseVertex
+  [[unlikely]] if (!allow_indirect || !OpenGl::SupportsMultiDrawIndirect()) {
+    stream_buffer.Commit();
+    return SubmitFallback(models.buffer, models.offset);
+  }
+
+  const StreamAllocation commands = stream_buffer.Allocate(
+      sizeof(DrawElementsIndirectCommand) * commands_.size(),
+      alignof(DrawElementsIndirectCommand));
+  std::ranges::copy(commands_,
+                    commands.As<DrawElementsIndirectCommand>().begin());
+  stream_buffer.Commit();
+
+  GeometryArena::SetInstanceData(models.buffer, models.offset);
+  OpenGl::BindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.buffer);
+  OpenGl::MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                    commands.offset, commands_.size());
+  return 1;
+}
+
+ui32 DrawList::SubmitFallback(GLuint models_buffer, size_t models_offset) {
+  ui32 num_calls = 0;
+  size_t run_begin = 0;
+  while (run_begin != commands_.size()) {
+    const GLuint model_index = commands_[run_begin].base_instance;
+    counts_.clear();
+    offsets_.clear();
+    base_vertices_.clear();
+
+    size_t run_end = run_begin;
+    for (; run_end != commands_.size() &&
+           commands_[run_end].base_instance == model_index;
+         ++run_end) {
+      const DrawElementsIndirectCommand& command = commands_[run_end];
+      counts_.push_back(static_cast<GLsizei>(command.count));
+      offsets_.push_back(reinterpret_cast<const void*>(
+          sizeof(ui32) * command.first_index));
+      base_vertices_.push_back(command.base_vertex);
+    }
+
+    GeometryArena::SetInstanceData(
+        models_buffer, models_offset + sizeof(Eigen::Matrix4f) * model_index);
+    OpenGl::MultiDrawElementsBaseVertex(GL_TRIANGLES, counts_.data(),
+                                        GL_UNSIGNED_INT, offsets_.data(),
+                                        counts_.size(), base_vertices_.data());
+    ++num_calls;
+    run_begin = run_end;
+  }
+
+  return num_calls;
+}
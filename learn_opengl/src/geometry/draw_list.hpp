@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory_resource>
+#include <vector>
+
+#include "geometry/geometry_arena.hpp"
+#include "integer.hpp"
+#include "wrap/wrap_eigen.hpp"
+
+class StreamBuffer;
+
+// Layout is defined by GL specification
+struct DrawElementsIndirectCommand {
+  GLuint count;
+  GLuint instance_count;
+  GLuint first_index;
+  GLint base_vertex;
+  GLuint base_instance;
+};
+
+// Draws of GeometryArena ranges collected during a frame and submitted with
+// as few API calls as possible: one glMultiDrawElementsIndirect if context
+// supports it, otherwise one glMultiDrawElementsBaseVertex per run of draws
+// that share a model matrix.
+class DrawList {
+ public:
+  // Keeps storage
+  void Clear() noexcept;
+
+  // Clears and moves storage to the resource, e.g. FrameAllocator, reserving
+  // as much as the list took at most since the last reset
+  void Reset(std::pmr::memory_resource* resource);
+
+  void Add(const GeometryAllocation& geometry, const Eigen::Matrix4f& model);
+
+  // Draws only [first_index, first_index + num_indices) part of geometry
+  void Add(const GeometryAllocation& geometry, ui32 first_index,
+           ui32 num_indices, const Eigen::Matrix4f& model);
+
+  // Shader and uniforms must be set by the caller. Returns the number of
+  // issued draw calls.
+  ui32 Submit(GeometryArena& arena, StreamBuffer& stream_buffer,
+              bool allow_indirect = true);
+
+  [[nodiscard]] size_t GetSize() const noexcept { return commands_.size(); }
+  [[nodiscard]] bool IsEmpty() const noexcept { return commands_.empty(); }
+
+ private:
+  ui32 SubmitFallback(GLuint models_buffer, size_t models_offset);
+
+ private:
+  std::pmr::vector<DrawElementsIndirectCommand> commands_;
+  // Consecutive draws with equal matrices share one element
+  std::pmr::vector<Eigen::Matrix4f> models_;
+  size_t peak_commands_ = 0;
+  size_t peak_models_ = 0;
+
+  // Scratch arrays for glMultiDrawElementsBaseVertex
+  std::pmr::vector<GLsizei> counts_;
+  std::pmr::vector<const void*> offsets_;
+  std::pmr::vector<GLint> base_vertices_;
+};
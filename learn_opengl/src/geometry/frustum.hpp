@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+
+#include "wrap/wrap_eigen.hpp"
+
+// View frustum as six inward facing planes extracted from a clip matrix
+class Frustum {
+ public:
+  // Default frustum does not cull anything
+  Frustum() { planes_.fill(Eigen::RowVector4f::Zero()); }
+
+  explicit Frustum(const Eigen::Matrix4f& projection_view) noexcept {
+    const auto& m = projection_view;
+    planes_[0] = m.row(3) + m.row(0);  // left
+    planes_[1] = m.row(3) - m.row(0);  // right
+    planes_[2] = m.row(3) + m.row(1);  // bottom
+    planes_[3] = m.row(3) - m.row(1);  // top
+    planes_[4] = m.row(3) + m.row(2);  // near
+    planes_[5] = m.row(3) - m.row(2);  // far
+  }
+
+  [[nodiscard]] bool Intersects(const Eigen::AlignedBox3f& box) const noexcept {
+    for (const Eigen::RowVector4f& plane : planes_) {
+      // The corner of the box which is the farthest along plane normal
+      const Eigen::Vector3f normal = plane.head<3>().transpose();
+      const Eigen::Vector3f positive =
+          (normal.array() >= 0.0f).select(box.max(), box.min());
+      [[unlikely]] if (normal.dot(positive) + plane.w() < 0.0f) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  std::array<Eigen::RowVector4f, 6> planes_;
+};
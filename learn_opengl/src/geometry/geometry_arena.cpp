@@ -0,0 +1,185 @@
+#include "geometry/geometry_arena.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+#include "memory/memory_tracker.hpp"
+
+namespace {
+constexpr size_t kInitialVertexCapacity = size_t{1} << 16;
+constexpr size_t kInitialIndexCapacity = size_t{1} << 18;
+// Neither of these targets is a part of vertex array state
+constexpr GLenum kUploadTarget = GL_COPY_WRITE_BUFFER;
+constexpr GLenum kReadTarget = GL_COPY_READ_BUFFER;
+}  // namespace
+
+GeometryArena::GeometryArena() = default;
+
+GeometryArena::~GeometryArena() = default;
+
+void GeometryArena::Shutdown() noexcept {
+  if (vao_) {
+    OpenGl::DeleteVertexArray(std::exchange(vao_, 0));
+    OpenGl::DeleteBuffer(std::exchange(vbo_, 0));
+    OpenGl::DeleteBuffer(std::exchange(ebo_, 0));
+  }
+}
+
+GeometryArena& GeometryArena::Get() {
+  static GeometryArena geometry_arena;
+  return geometry_arena;
+}
+
+GeometryAllocation GeometryArena::Allocate(std::span<const Vertex> vertices,
+                                           std::span<const ui32> indices) {
+  [[unlikely]] if (vertices.empty() || indices.empty()) {
+    throw std::invalid_argument("Geometry arena can't allocate empty mesh");
+  }
+
+  std::optional<size_t> first_vertex = vertex_ranges_.Allocate(vertices.size());
+  [[unlikely]] if (!first_vertex) {
+    Reserve(vertices.size(), 0);
+    first_vertex = vertex_ranges_.Allocate(vertices.size());
+  }
+
+  std::optional<size_t> first_index = index_ranges_.Allocate(indices.size());
+  [[unlikely]] if (!first_index) {
+    Reserve(0, indices.size());
+    first_index = index_ranges_.Allocate(indices.size());
+  }
+
+  assert(first_vertex && first_index);
+
+  OpenGl::BindBuffer(kUploadTarget, vbo_);
+  OpenGl::BufferSubData(kUploadTarget, *first_vertex, vertices);
+  OpenGl::BindBuffer(kUploadTarget, ebo_);
+  OpenGl::BufferSubData(kUploadTarget, *first_index, indices);
+
+  GeometryAllocation allocation;
+  allocation.first_vertex = static_cast<ui32>(*first_vertex);
+  allocation.num_vertices = static_cast<ui32>(vertices.size());
+  allocation.first_index = static_cast<ui32>(*first_index);
+  allocation.num_indices = static_cast<ui32>(indices.size());
+  ++num_allocations_;
+  return allocation;
+}
+
+void GeometryArena::Free(const GeometryAllocation& allocation) {
+  [[unlikely]] if (!allocation.IsValid()) { return; }
+
+  vertex_ranges_.Free(allocation.first_vertex, allocation.num_vertices);
+  index_ranges_.Free(allocation.first_index, allocation.num_indices);
+  --num_allocations_;
+}
+
+std::shared_ptr<const GeometryAllocation> GeometryArena::AllocateShared(
+    std::span<const Vertex> vertices, std::span<const ui32> indices) {
+  auto owned =
+      std::make_unique<GeometryAllocation>(Allocate(vertices, indices));
+  return std::shared_ptr<const GeometryAllocation>(
+      owned.release(), [this](const GeometryAllocation* allocation) {
+        Free(*allocation);
+        delete allocation;
+      });
+}
+
+void GeometryArena::Read(const GeometryAllocation& allocation,
+                         std::vector<Vertex>& vertices,
+                         std::vector<ui32>& indices) const {
+  vertices.resize(allocation.num_vertices);
+  OpenGl::BindBuffer(kReadTarget, vbo_);
+  OpenGl::GetBufferSubData(kReadTarget, allocation.first_vertex,
+                           std::span(vertices));
+
+  indices.resize(allocation.num_indices);
+  OpenGl::BindBuffer(kReadTarget, ebo_);
+  OpenGl::GetBufferSubData(kReadTarget, allocation.first_index,
+                           std::span(indices));
+}
+
+void GeometryArena::Bind() {
+  [[unlikely]] if (!vao_) { Reserve(0, 0); }
+  OpenGl::BindVertexArray(vao_);
+}
+
+void GeometryArena::SetInstanceData(GLuint buffer, size_t offset) noexcept {
+  constexpr size_t kColumnSize = sizeof(Eigen::Vector4f);
+  OpenGl::BindBuffer(GL_ARRAY_BUFFER, buffer);
+  for (GLuint column = 0; column != 4; ++column) {
+    OpenGl::VertexAttribPointer(
+        kModelAttributeLocation + column, 4, GL_FLOAT, false,
+        sizeof(Eigen::Matrix4f),
+        reinterpret_cast<const void*>(offset + column * kColumnSize));
+  }
+}
+
+GeometryArenaStats GeometryArena::GetStats() const noexcept {
+  GeometryArenaStats stats;
+  stats.vertex_capacity = vertex_ranges_.GetCapacity();
+  stats.used_vertices = vertex_ranges_.GetUsed();
+  stats.index_capacity = index_ranges_.GetCapacity();
+  stats.used_indices = index_ranges_.GetUsed();
+  stats.num_allocations = num_allocations_;
+  stats.grows = grows_;
+  return stats;
+}
+
+void GeometryArena::Reserve(size_t num_vertices, size_t num_indices) {
+  const size_t old_vertex_capacity = vertex_ranges_.GetCapacity();
+  const size_t old_index_capacity = index_ranges_.GetCapacity();
+  const size_t vertex_capacity =
+      std::max({kInitialVertexCapacity, old_vertex_capacity * 2,
+                old_vertex_capacity + num_vertices});
+  const size_t index_capacity =
+      std::max({kInitialIndexCapacity, old_index_capacity * 2,
+                old_index_capacity + num_indices});
+
+  if (vao_) {
+    ++grows_;
+  } else {
+    vao_ = OpenGl::GenVertexArray();
+    OpenGl::BindVertexArray(vao_);
+    for (GLuint column = 0; column != 4; ++column) {
+      OpenGl::EnableVertexAttribArray(kModelAttributeLocation + column);
+      OpenGl::VertexAttribDivisor(kModelAttributeLocation + column, 1);
+    }
+  }
+
+  if (num_vertices || !vbo_) {
+    vbo_ = GrowBuffer(vbo_, sizeof(Vertex) * old_vertex_capacity,
+                      sizeof(Vertex) * vertex_capacity);
+    vertex_ranges_.Grow(vertex_capacity);
+  }
+
+  if (num_indices || !ebo_) {
+    ebo_ = GrowBuffer(ebo_, sizeof(ui32) * old_index_capacity,
+                      sizeof(ui32) * index_capacity);
+    index_ranges_.Grow(index_capacity);
+  }
+
+  // Attach new storage to vertex array
+  OpenGl::BindVertexArray(vao_);
+  OpenGl::BindBuffer(GL_ARRAY_BUFFER, vbo_);
+  Vertex::RegisterAttributes();
+  OpenGl::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+}
+
+GLuint GeometryArena::GrowBuffer(GLuint buffer, size_t old_size,
+                                 size_t new_size) {
+  const MemoryTagScope tag_scope(MemoryTag::Meshes);
+  const GLuint new_buffer = OpenGl::GenBuffer();
+  OpenGl::BindBuffer(kUploadTarget, new_buffer);
+  OpenGl::BufferData(kUploadTarget, static_cast<GLsizeiptr>(new_size),
+                     nullptr, GL_STATIC_DRAW);
+
+  if (buffer) {
+    OpenGl::BindBuffer(kReadTarget, buffer);
+    OpenGl::CopyBufferSubData(kReadTarget, kUploadTarget, 0, 0,
+                              static_cast<GLsizeiptr>(old_size));
+    OpenGl::DeleteBuffer(buffer);
+  }
+
+  return new_buffer;
+}
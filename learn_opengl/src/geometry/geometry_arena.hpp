@@ -0,0 +1,87 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "geometry/vertex.hpp"
+#include "integer.hpp"
+#include "memory/range_allocator.hpp"
+#include "opengl/gl_api.hpp"
+
+// Location of mesh geometry inside of GeometryArena. Indices are relative to
+// first_vertex.
+struct GeometryAllocation {
+  [[nodiscard]] bool IsValid() const noexcept { return num_indices != 0; }
+
+  ui32 first_vertex = 0;
+  ui32 num_vertices = 0;
+  ui32 first_index = 0;
+  ui32 num_indices = 0;
+};
+
+struct GeometryArenaStats {
+  size_t vertex_capacity = 0;
+  size_t used_vertices = 0;
+  size_t index_capacity = 0;
+  size_t used_indices = 0;
+  ui32 num_allocations = 0;
+  ui32 grows = 0;
+};
+
+// Vertex and index storage shared by all meshes. Only one vertex format
+// exists, so there is a single vertex array for everything and meshes are
+// just ranges of it. Model matrix of a draw comes from an instanced
+// attribute, see SetInstanceData().
+class GeometryArena {
+ public:
+  // mat4 takes four consecutive locations
+  static constexpr GLuint kModelAttributeLocation = 4;
+
+  GeometryArena();
+  GeometryArena(const GeometryArena&) = delete;
+  // Doesn't touch GL, the context is gone by static destruction
+  ~GeometryArena();
+
+  static GeometryArena& Get();
+
+  // Deletes GL objects. Must be called while the context is alive, freeing
+  // allocations is still allowed afterwards.
+  void Shutdown() noexcept;
+
+  // Storage is grown (and existing data copied) if there is no room
+  [[nodiscard]] GeometryAllocation Allocate(std::span<const Vertex> vertices,
+                                            std::span<const ui32> indices);
+  void Free(const GeometryAllocation& allocation);
+
+  // Allocation which is returned to the arena when the last owner is gone
+  [[nodiscard]] std::shared_ptr<const GeometryAllocation> AllocateShared(
+      std::span<const Vertex> vertices, std::span<const ui32> indices);
+
+  // Reads geometry back from GPU
+  void Read(const GeometryAllocation& allocation, std::vector<Vertex>& vertices,
+            std::vector<ui32>& indices) const;
+
+  void Bind();
+
+  // Points model matrix attribute of bound arena to an array of
+  // Eigen::Matrix4f that starts at offset in buffer
+  static void SetInstanceData(GLuint buffer, size_t offset) noexcept;
+
+  [[nodiscard]] GeometryArenaStats GetStats() const noexcept;
+
+  GeometryArena& operator=(const GeometryArena&) = delete;
+
+ private:
+  void Reserve(size_t num_vertices, size_t num_indices);
+  static GLuint GrowBuffer(GLuint buffer, size_t old_size, size_t new_size);
+
+ private:
+  RangeAllocator vertex_ranges_;
+  RangeAllocator index_ranges_;
+  GLuint vao_ = 0;
+  GLuint vbo_ = 0;
+  GLuint ebo_ = 0;
+  ui32 num_allocations_ = 0;
+  ui32 grows_ = 0;
+};
@@ -0,0 +1,152 @@
+#include "geometry/trs_batch.hpp"
+
+#include <cassert>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+// Register types with the same set of operations so that the conversion is
+// written once for every instruction set
+struct ScalarLanes {
+  using Reg = float;
+  static constexpr size_t kWidth = 1;
+
+  static Reg Load(const float* p) noexcept { return *p; }
+  static void Store(float* p, Reg v) noexcept { *p = v; }
+  static Reg Set(float v) noexcept { return v; }
+  static Reg Add(Reg a, Reg b) noexcept { return a + b; }
+  static Reg Sub(Reg a, Reg b) noexcept { return a - b; }
+  static Reg Mul(Reg a, Reg b) noexcept { return a * b; }
+};
+
+#if defined(__AVX2__)
+struct SimdLanes {
+  using Reg = __m256;
+  static constexpr size_t kWidth = 8;
+
+  static Reg Load(const float* p) noexcept { return _mm256_loadu_ps(p); }
+  static void Store(float* p, Reg v) noexcept { _mm256_store_ps(p, v); }
+  static Reg Set(float v) noexcept { return _mm256_set1_ps(v); }
+  static Reg Add(Reg a, Reg b) noexcept { return _mm256_add_ps(a, b); }
+  static Reg Sub(Reg a, Reg b) noexcept { return _mm256_sub_ps(a, b); }
+  static Reg Mul(Reg a, Reg b) noexcept { return _mm256_mul_ps(a, b); }
+};
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+struct SimdLanes {
+  using Reg = float32x4_t;
+  static constexpr size_t kWidth = 4;
+
+  static Reg Load(const float* p) noexcept { return vld1q_f32(p); }
+  static void Store(float* p, Reg v) noexcept { vst1q_f32(p, v); }
+  static Reg Set(float v) noexcept { return vdupq_n_f32(v); }
+  static Reg Add(Reg a, Reg b) noexcept { return vaddq_f32(a, b); }
+  static Reg Sub(Reg a, Reg b) noexcept { return vsubq_f32(a, b); }
+  static Reg Mul(Reg a, Reg b) noexcept { return vmulq_f32(a, b); }
+};
+#else
+using SimdLanes = ScalarLanes;
+#endif
+
+using Channels = std::array<const float*, TrsBatch::kNumChannels>;
+
+// Converts L::kWidth transforms starting from first
+template <typename L>
+void ComputeLanes(const Channels& c, size_t first,
+                  Eigen::Matrix4f* models) noexcept {
+  using R = typename L::Reg;
+  const R x = L::Load(c[TrsBatch::kRotationX] + first);
+  const R y = L::Load(c[TrsBatch::kRotationY] + first);
+  const R z = L::Load(c[TrsBatch::kRotationZ] + first);
+  const R w = L::Load(c[TrsBatch::kRotationW] + first);
+  const R scale[3] = {L::Load(c[TrsBatch::kScaleX] + first),
+                      L::Load(c[TrsBatch::kScaleY] + first),
+                      L::Load(c[TrsBatch::kScaleZ] + first)};
+
+  const R one = L::Set(1.0f);
+  const R two = L::Set(2.0f);
+  const R x2 = L::Mul(x, two);
+  const R y2 = L::Mul(y, two);
+  const R z2 = L::Mul(z, two);
+  const R xx = L::Mul(x, x2);
+  const R yy = L::Mul(y, y2);
+  const R zz = L::Mul(z, z2);
+  const R xy = L::Mul(x, y2);
+  const R xz = L::Mul(x, z2);
+  const R yz = L::Mul(y, z2);
+  const R wx = L::Mul(w, x2);
+  const R wy = L::Mul(w, y2);
+  const R wz = L::Mul(w, z2);
+
+  // Rotation matrix by columns
+  const R rotation[3][3] = {
+      {L::Sub(one, L::Add(yy, zz)), L::Add(xy, wz), L::Sub(xz, wy)},
+      {L::Sub(xy, wz), L::Sub(one, L::Add(xx, zz)), L::Add(yz, wx)},
+      {L::Add(xz, wy), L::Sub(yz, wx), L::Sub(one, L::Add(xx, yy))},
+  };
+
+  // Lanes are transposed into matrices through memory
+  alignas(32) float model[12][L::kWidth];
+  for (size_t column = 0; column != 3; ++column) {
+    for (size_t row = 0; row != 3; ++row) {
+      L::Store(model[column * 3 + row],
+               L::Mul(rotation[column][row], scale[column]));
+    }
+  }
+  L::Store(model[9], L::Load(c[TrsBatch::kTranslationX] + first));
+  L::Store(model[10], L::Load(c[TrsBatch::kTranslationY] + first));
+  L::Store(model[11], L::Load(c[TrsBatch::kTranslationZ] + first));
+
+  for (size_t lane = 0; lane != L::kWidth; ++lane) {
+    Eigen::Matrix4f& m = models[first + lane];
+    for (Eigen::Index column = 0; column != 4; ++column) {
+      for (Eigen::Index row = 0; row != 3; ++row) {
+        m(row, column) = model[column * 3 + row][lane];
+      }
+    }
+    m.row(3) << 0.0f, 0.0f, 0.0f, 1.0f;
+  }
+}
+}  // namespace
+
+void TrsBatch::Clear() noexcept {
+  for (auto& channel : channels_) {
+    channel.clear();
+  }
+}
+
+void TrsBatch::Add(const Eigen::Quaternionf& rotation,
+                   const Eigen::Vector3f& translation,
+                   const Eigen::Vector3f& scale) {
+  channels_[kRotationX].push_back(rotation.x());
+  channels_[kRotationY].push_back(rotation.y());
+  channels_[kRotationZ].push_back(rotation.z());
+  channels_[kRotationW].push_back(rotation.w());
+  channels_[kTranslationX].push_back(translation.x());
+  channels_[kTranslationY].push_back(translation.y());
+  channels_[kTranslationZ].push_back(translation.z());
+  channels_[kScaleX].push_back(scale.x());
+  channels_[kScaleY].push_back(scale.y());
+  channels_[kScaleZ].push_back(scale.z());
+}
+
+void TrsBatch::ComputeMatrices(std::span<Eigen::Matrix4f> models) const {
+  const size_t size = GetSize();
+  assert(models.size() == size);
+
+  Channels channels;
+  for (size_t i = 0; i != kNumChannels; ++i) {
+    channels[i] = channels_[i].data();
+  }
+
+  size_t first = 0;
+  for (; first + SimdLanes::kWidth <= size; first += SimdLanes::kWidth) {
+    ComputeLanes<SimdLanes>(channels, first, models.data());
+  }
+  for (; first != size; ++first) {
+    ComputeLanes<ScalarLanes>(channels, first, models.data());
+  }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "wrap/wrap_eigen.hpp"
+
+// Rotations, translations and scales of many transforms stored as one array
+// per scalar, so that every SIMD lane converts its own transform. With AVX2
+// (ENABLE_AVX2, off by default) eight transforms are converted at once, with
+// NEON four, otherwise one by one.
+class TrsBatch {
+ public:
+  void Clear() noexcept;
+  void Add(const Eigen::Quaternionf& rotation,
+           const Eigen::Vector3f& translation, const Eigen::Vector3f& scale);
+
+  [[nodiscard]] size_t GetSize() const noexcept {
+    return channels_.front().size();
+  }
+
+  // Model matrices are rotation * scale with translation. The span must
+  // have GetSize() elements.
+  void ComputeMatrices(std::span<Eigen::Matrix4f> models) const;
+
+  // Unit quaternion (x, y, z, w)
+  enum Channel : size_t {
+    kRotationX,
+    kRotationY,
+    kRotationZ,
+    kRotationW,
+    kTranslationX,
+    kTranslationY,
+    kTranslationZ,
+    kScaleX,
+    kScaleY,
+    kScaleZ,
+    kNumChannels
+  };
+
+ private:
+  std::array<std::vector<float>, kNumChannels> channels_;
+};
@@ -0,0 +1,25 @@
+#include "geometry/vertex.hpp"
+
+#include "template/class_member_traits.hpp"
+#include "template/member_offset.hpp"
+#include "template/type_to_gl_type.hpp"
+
+template <auto MemberVariablePtr>
+void RegisterAttribute(GLuint location, bool normalized) {
+  using MemberTraits = ClassMemberTraits<decltype(MemberVariablePtr)>;
+  using GlTypeTraits = TypeToGlType<typename MemberTraits::Member>;
+  const size_t vertex_stride = sizeof(typename MemberTraits::Class);
+  const size_t member_stride = MemberOffset<MemberVariablePtr>();
+  OpenGl::VertexAttribPointer(location, GlTypeTraits::Size, GlTypeTraits::Type,
+                              normalized, vertex_stride,
+                              reinterpret_cast<void*>(member_stride));
+  OpenGl::EnableVertexAttribArray(location);
+}
+
+void Vertex::RegisterAttributes() {
+  GLuint location = 0;
+  RegisterAttribute<&Vertex::position>(location++, false);
+  RegisterAttribute<&Vertex::tex_coord>(location++, false);
+  RegisterAttribute<&Vertex::color>(location++, false);
+  RegisterAttribute<&Vertex::normal>(location++, false);
+}
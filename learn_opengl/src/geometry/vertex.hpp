@@ -0,0 +1,15 @@
+#pragma once
+
+#include "opengl/gl_api.hpp"
+#include "wrap/wrap_eigen.hpp"
+
+class Vertex {
+ public:
+  // Describes vertex layout for currently bound vertex array
+  static void RegisterAttributes();
+
+  Eigen::Vector3f position;
+  Eigen::Vector2f tex_coord;
+  Eigen::Vector3f color;
+  Eigen::Vector3f normal;
+};
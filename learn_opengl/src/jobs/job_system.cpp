@@ -0,0 +1,255 @@
+#include "jobs/job_system.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cassert>
+#include <chrono>
+#include <utility>
+
+#include "wrap/wrap_imgui.h"
+
+namespace {
+thread_local ui32 t_current_worker = JobSystem::kNotAWorker;
+}  // namespace
+
+JobSystem& JobSystem::Get() {
+  static JobSystem instance;
+  return instance;
+}
+
+JobSystem::JobSystem(ui32 num_threads) {
+  [[likely]] if (num_threads == 0) {
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  workers_.reserve(num_threads);
+  for (ui32 i = 0; i != num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+
+  t_current_worker = kMainThreadWorker;
+  for (ui32 i = 1; i != num_threads; ++i) {
+    workers_[i]->thread = std::thread([this, i] { WorkerMain(i); });
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard lock(sleep_mutex_);
+    stop_ = true;
+  }
+  sleep_cv_.notify_all();
+
+  for (auto& worker : workers_) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+void JobSystem::Schedule(Job job, JobCounter* depends_on) {
+  if (job.counter) {
+    job.counter->value_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  if (depends_on) {
+    std::lock_guard lock(depends_on->mutex_);
+    if (depends_on->value_.load(std::memory_order_acquire) != 0) {
+      depends_on->dependents_.push_back(std::move(job));
+      return;
+    }
+  }
+
+  Push(std::move(job));
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+  const ui32 worker = GetCurrentWorker();
+  while (!counter.IsDone()) {
+    if (worker == kMainThreadWorker) {
+      ExecuteMainThreadJobs();
+    }
+
+    [[unlikely]] if (worker == kNotAWorker || !RunOneJob(worker)) {
+      std::this_thread::yield();
+    }
+  }
+
+  // The last job may still be inside Complete()
+  std::exception_ptr exception;
+  {
+    std::lock_guard lock(counter.mutex_);
+    exception = std::exchange(counter.exception_, nullptr);
+  }
+
+  [[unlikely]] if (exception) { std::rethrow_exception(exception); }
+}
+
+void JobSystem::ScheduleOnMainThread(Job job) {
+  if (job.counter) {
+    job.counter->value_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::lock_guard lock(main_thread_mutex_);
+  main_thread_jobs_.push_back(std::move(job));
+}
+
+void JobSystem::ExecuteMainThreadJobs() {
+  assert(GetCurrentWorker() == kMainThreadWorker);
+
+  // Jobs may schedule more main thread jobs or wait for them
+  std::vector<Job> jobs;
+  {
+    std::lock_guard lock(main_thread_mutex_);
+    [[likely]] if (main_thread_jobs_.empty()) { return; }
+    jobs.swap(main_thread_jobs_);
+  }
+
+  for (Job& job : jobs) {
+    Execute(kMainThreadWorker, job);
+  }
+}
+
+void JobSystem::SetProfilingHooks(JobProfilingHooks hooks) {
+  hooks_ = std::move(hooks);
+}
+
+ui32 JobSystem::GetCurrentWorker() noexcept { return t_current_worker; }
+
+void JobSystem::DrawDetails() const {
+  for (ui32 i = 0; i != workers_.size(); ++i) {
+    const JobWorkerStats& stats = workers_[i]->stats;
+    ImGui::Text(
+        "worker %u: %llu jobs, %llu stolen, %.1f ms busy", i,
+        static_cast<unsigned long long>(stats.executed.load()),
+        static_cast<unsigned long long>(stats.stolen.load()),
+        static_cast<double>(stats.busy_ns.load()) / 1'000'000.0);
+  }
+}
+
+void JobSystem::WorkerMain(ui32 worker) {
+  t_current_worker = worker;
+  while (!stop_) {
+    if (RunOneJob(worker)) {
+      continue;
+    }
+
+    std::unique_lock lock(sleep_mutex_);
+    sleep_cv_.wait(lock, [&] { return stop_ || num_queued_ != 0; });
+  }
+}
+
+void JobSystem::Push(Job job) {
+  ui32 worker = GetCurrentWorker();
+  [[unlikely]] if (worker == kNotAWorker) { worker = kMainThreadWorker; }
+
+  // Counted before the push so that a pop never drives it below zero.
+  // Taking the mutex orders the increment with the check of a sleeping
+  // worker, so the notification can't be lost.
+  {
+    std::lock_guard lock(sleep_mutex_);
+    ++num_queued_;
+  }
+
+  {
+    Worker& w = *workers_[worker];
+    std::lock_guard lock(w.mutex);
+    w.jobs.push_back(std::move(job));
+  }
+  sleep_cv_.notify_one();
+}
+
+bool JobSystem::TryPop(ui32 worker, Job& job) {
+  Worker& w = *workers_[worker];
+  std::lock_guard lock(w.mutex);
+  [[unlikely]] if (w.jobs.empty()) { return false; }
+
+  job = std::move(w.jobs.back());
+  w.jobs.pop_back();
+  --num_queued_;
+  return true;
+}
+
+bool JobSystem::TrySteal(ui32 thief, Job& job) {
+  const auto num_workers = static_cast<ui32>(workers_.size());
+  for (ui32 i = 1; i != num_workers; ++i) {
+    Worker& victim = *workers_[(thief + i) % num_workers];
+    std::lock_guard lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      job = std::move(victim.jobs.front());
+      victim.jobs.pop_front();
+      --num_queued_;
+      ++workers_[thief]->stats.stolen;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool JobSystem::RunOneJob(ui32 worker) {
+  Job job;
+  [[unlikely]] if (!TryPop(worker, job) && !TrySteal(worker, job)) {
+    return false;
+  }
+
+  Execute(worker, job);
+  return true;
+}
+
+void JobSystem::Execute(ui32 worker, Job& job) {
+  if (hooks_.on_begin) {
+    hooks_.on_begin(job.name, worker);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  std::exception_ptr exception;
+  try {
+    job.function();
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  const auto duration = std::chrono::steady_clock::now() - start;
+
+  JobWorkerStats& stats = workers_[worker]->stats;
+  ++stats.executed;
+  stats.busy_ns += static_cast<ui64>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+
+  if (hooks_.on_end) {
+    hooks_.on_end(
+        job.name, worker,
+        std::chrono::duration<float, std::milli>(duration).count());
+  }
+
+  if (job.counter) {
+    Complete(*job.counter, exception);
+  } else if (exception) {
+    try {
+      std::rethrow_exception(exception);
+    } catch (const std::exception& e) {
+      spdlog::error("Job {} failed: {}", job.name, e.what());
+    } catch (...) {
+      spdlog::error("Job {} failed", job.name);
+    }
+  }
+}
+
+void JobSystem::Complete(JobCounter& counter, std::exception_ptr exception) {
+  std::vector<Job> dependents;
+  {
+    std::lock_guard lock(counter.mutex_);
+    [[unlikely]] if (exception && !counter.exception_) {
+      counter.exception_ = std::move(exception);
+    }
+
+    if (counter.value_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      dependents.swap(counter.dependents_);
+    }
+  }
+
+  // Counter may be destroyed by now
+  for (Job& job : dependents) {
+    Push(std::move(job));
+  }
+}
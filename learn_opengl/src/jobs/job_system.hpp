@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "integer.hpp"
+
+class JobCounter;
+
+struct Job {
+  std::function<void()> function;
+  // Decremented when the job completes
+  JobCounter* counter = nullptr;
+  // Static string, reported to profiling hooks
+  const char* name = "Job";
+};
+
+// Number of unfinished jobs of a group. Jobs that depend on the group are
+// held by the counter until it drops to zero. Must outlive the jobs that
+// signal it, Wait() for them before destroying the counter.
+class JobCounter {
+ public:
+  JobCounter() = default;
+  JobCounter(const JobCounter&) = delete;
+
+  [[nodiscard]] bool IsDone() const noexcept {
+    return value_.load(std::memory_order_acquire) == 0;
+  }
+
+  JobCounter& operator=(const JobCounter&) = delete;
+
+ private:
+  friend class JobSystem;
+
+  std::atomic<ui32> value_ = 0;
+  std::mutex mutex_;
+  std::vector<Job> dependents_;
+  // The first exception thrown by a job, rethrown by Wait()
+  std::exception_ptr exception_;
+};
+
+struct JobProfilingHooks {
+  std::function<void(const char* name, ui32 worker)> on_begin;
+  std::function<void(const char* name, ui32 worker, float ms)> on_end;
+};
+
+struct JobWorkerStats {
+  std::atomic<ui64> executed = 0;
+  std::atomic<ui64> stolen = 0;
+  std::atomic<ui64> busy_ns = 0;
+};
+
+// Work-stealing thread pool. Every worker has its own deque: it pushes and
+// pops jobs at the back, idle workers steal from the front of other deques.
+// The thread that creates the system (main thread) is worker 0, it has no
+// thread of its own and runs jobs only inside Wait(). Jobs that need the GL
+// context go to a separate queue executed on the main thread.
+class JobSystem {
+ public:
+  static constexpr ui32 kMainThreadWorker = 0;
+
+  static JobSystem& Get();
+
+  // Zero means one worker per hardware thread
+  explicit JobSystem(ui32 num_threads = 0);
+  JobSystem(const JobSystem&) = delete;
+  ~JobSystem();
+
+  // Job starts after depends_on reaches zero
+  void Schedule(Job job, JobCounter* depends_on = nullptr);
+
+  // Runs other jobs while waiting. Rethrows an exception of a failed job.
+  void Wait(JobCounter& counter);
+
+  // Calls fn(first, last) for subranges of at most grain_size elements.
+  // Zero grain size splits the range into a few parts per worker.
+  template <typename F>
+  void ParallelFor(size_t begin, size_t end, size_t grain_size, F&& fn,
+                   const char* name = "ParallelFor");
+
+  // GL calls and other work bound to the main thread
+  void ScheduleOnMainThread(Job job);
+  void ExecuteMainThreadJobs();
+
+  // Must not be changed while jobs are running
+  void SetProfilingHooks(JobProfilingHooks hooks);
+
+  [[nodiscard]] ui32 GetNumWorkers() const noexcept {
+    return static_cast<ui32>(workers_.size());
+  }
+  // kNotAWorker for threads not owned by the system
+  [[nodiscard]] static ui32 GetCurrentWorker() noexcept;
+  [[nodiscard]] const JobWorkerStats& GetWorkerStats(
+      ui32 worker) const noexcept {
+    return workers_[worker]->stats;
+  }
+
+  void DrawDetails() const;
+
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  static constexpr ui32 kNotAWorker = ~ui32{0};
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+    JobWorkerStats stats;
+    std::thread thread;
+  };
+
+  void WorkerMain(ui32 worker);
+  void Push(Job job);
+  [[nodiscard]] bool TryPop(ui32 worker, Job& job);
+  [[nodiscard]] bool TrySteal(ui32 thief, Job& job);
+  // Returns false if there was nothing to do
+  bool RunOneJob(ui32 worker);
+  void Execute(ui32 worker, Job& job);
+  void Complete(JobCounter& counter, std::exception_ptr exception);
+
+ private:
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<ui32> num_queued_ = 0;
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  std::mutex main_thread_mutex_;
+  std::vector<Job> main_thread_jobs_;
+  JobProfilingHooks hooks_;
+  std::atomic<bool> stop_ = false;
+};
+
+template <typename F>
+void JobSystem::ParallelFor(size_t begin, size_t end, size_t grain_size,
+                            F&& fn, const char* name) {
+  [[unlikely]] if (begin >= end) { return; }
+
+  constexpr size_t kPartsPerWorker = 4;
+  [[unlikely]] if (grain_size == 0) {
+    grain_size = std::max<size_t>(
+        (end - begin) / (workers_.size() * kPartsPerWorker), 1);
+  }
+
+  [[unlikely]] if (end - begin <= grain_size) {
+    fn(begin, end);
+    return;
+  }
+
+  JobCounter counter;
+  for (size_t first = begin; first < end; first += grain_size) {
+    const size_t last = std::min(first + grain_size, end);
+    Schedule({[&fn, first, last] { fn(first, last); }, &counter, name});
+  }
+  Wait(counter);
+}
@@ -2,8 +2,12 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
 #include <filesystem>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -15,7 +19,12 @@
 #include "components/mesh_component.hpp"
 #include "components/transform_component.hpp"
 #include "entities/entity.hpp"
+#include "entities/prefab.hpp"
 #include "integer.hpp"
+#include "jobs/job_system.hpp"
+#include "memory/frame_allocator.hpp"
+#include "memory/memory.hpp"
+#include "memory/memory_tracker.hpp"
 #include "name_cache/name_cache.hpp"
 #include "opengl/debug/annotations.hpp"
 #include "opengl/debug/gl_debug_messenger.hpp"
@@ -25,6 +34,9 @@
 #include "reflection/register_types.hpp"
 #include "render_system.hpp"
 #include "shader/shader.hpp"
+#include "snapshot/world_snapshot.hpp"
+#include "systems/system_scheduler.hpp"
+#include "systems/transform_system.hpp"
 #include "template/class_member_traits.hpp"
 #include "texture/texture.hpp"
 #include "texture/texture_manager.hpp"
@@ -103,23 +115,26 @@ void CreateMeshes(World& world, const std::shared_ptr<Shader>& shader) {
   constexpr size_t nx = 10;
   constexpr size_t ny = 10;
 
-  // Create entity with mesh component
+  // Cubes share geometry of the prototype
+  Prefab prefab;
+  prefab.SetStatic(true);
+  const Eigen::Vector3f cube_color(1.0f, 1.0f, 1.0f);
+  prefab.AddComponent<MeshComponent>().MakeCube(1.0f, cube_color, shader);
+  prefab.AddComponent<TransformComponent>();
+
+  const EntityHandleRange cubes = world.SpawnMany(prefab, nx * ny);
   for (size_t x = 0; x < nx; ++x) {
     for (size_t y = 0; y < ny; ++y) {
-      auto& entity = world.SpawnEntity<Entity>();
+      Entity& entity = *world.GetEntity(cubes[x * ny + y]);
       entity.SetName(fmt::format("mesh [x:{}, y:{}]", x, y));
-      MeshComponent& mesh = entity.AddComponent<MeshComponent>();
-      const Eigen::Vector3f cube_color(1.0f, 1.0f, 1.0f);
-      mesh.MakeCube(1.0f, cube_color, shader);  //
-      auto& t = entity.AddComponent<TransformComponent>();
-
       const float px =
           (static_cast<float>(x) * width / static_cast<float>(nx)) -
           (width / 2);
       const float py =
           (static_cast<float>(y) * height / static_cast<float>(ny)) -
           (height / 2);
-      t.transform *= Eigen::Translate(px, py, 0.0f);
+      entity.ModifyComponent<TransformComponent>()->translation =
+          Eigen::Vector3f(px, py, 0.0f);
     }
   }
 }
@@ -153,18 +168,57 @@ void CreatePointLights(World& world, RenderSystem& render_system) {
 
     const Eigen::Vector3f location = Eigen::Vector3f(0.0f, 0.0f, 1.0f) +
                                      Eigen::Vector3f(x, y, 0.0f) * radius;
-    transform.transform *=
-        Eigen::Translate(location.x(), location.y(), location.z());
+    transform.translation = location;
+  }
+}
 
-    render_system.point_lights_.push_back({&transform, &light});
+// Saves the world or adds entities of the saved one to it
+void SnapshotWidget(World& world, const std::filesystem::path& path) {
+  static std::string status;
+  const auto start_time = std::chrono::steady_clock::now();
+  auto elapsed_ms = [&]() {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start_time)
+        .count();
+  };
+
+  try {
+    if (ImGui::Button("save")) {
+      WorldSnapshot::Save(world, path);
+      status = fmt::format("saved {} entities in {:.1f} ms",
+                           world.GetNumEntities(), elapsed_ms());
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("load")) {
+      const size_t num_entities = WorldSnapshot::Load(world, path);
+      status = fmt::format("loaded {} entities in {:.1f} ms", num_entities,
+                           elapsed_ms());
+    }
+  } catch (const std::exception& e) {
+    status = e.what();
   }
+
+  ImGui::TextUnformatted(status.data());
 }
 
+void* ImGuiAlloc(size_t size, void*) {
+  // Ui budget is never enforced, so only the system can be out of memory.
+  // ImGui would dereference null.
+  void* ptr =
+      Memory::AlignedAlloc(size, alignof(std::max_align_t), MemoryTag::Ui);
+  [[unlikely]] if (!ptr) {
+    spdlog::critical("Out of memory: ImGui failed to allocate {} bytes", size);
+    std::abort();
+  }
+  return ptr;
+}
+
+void ImGuiFree(void* ptr, void*) { Memory::AlignedFree(ptr); }
+
 void Main([[maybe_unused]] int argc, char** argv) {
   spdlog::set_level(spdlog::level::warn);
   const std::filesystem::path exe_file = std::filesystem::path(argv[0]);
   RegisterReflectionTypes();
-  std::vector<std::unique_ptr<Window>> windows;
 
   const auto content_dir = exe_file.parent_path() / "content";
   const auto shaders_dir = content_dir / "shaders";
@@ -172,8 +226,17 @@ void Main([[maybe_unused]] int argc, char** argv) {
   const auto models_dir = content_dir / "models";
   Shader::shaders_dir_ = content_dir / "shaders";
 
+  MemoryTracker& memory_tracker = MemoryTracker::Get();
+  if (const auto budgets_path = content_dir / "memory_budgets.json";
+      std::filesystem::exists(budgets_path)) {
+    memory_tracker.LoadBudgets(budgets_path);
+  }
+  memory_tracker.SetDumpInterval(std::chrono::seconds(30));
+
   GlfwState glfw_state;
   glfw_state.Initialize();
+  // Destroyed before GLFW and after everything owning GL objects
+  std::vector<std::unique_ptr<Window>> windows;
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -207,6 +270,7 @@ void Main([[maybe_unused]] int argc, char** argv) {
   OpenGl::EnableDepthTest();
 
   glfwSwapInterval(0);
+  ImGui::SetAllocatorFunctions(ImGuiAlloc, ImGuiFree);
   ImGui::CreateContext();
   ImGui::StyleColorsDark();
   ImGui_ImplGlfw_InitForOpenGL(windows.back()->GetGlfwWindow(), true);
@@ -230,6 +294,8 @@ void Main([[maybe_unused]] int argc, char** argv) {
   World world;
 
   RenderSystem render_system(texture_manager);
+  SystemScheduler systems;
+  systems.AddSystem<TransformSystem>();
 
   //// Create entity with directional light component
   //{
@@ -244,8 +310,6 @@ void Main([[maybe_unused]] int argc, char** argv) {
   //  auto& transform = entity.AddComponent<TransformComponent>();
   //  transform.transform = glm::yawPitchRoll(
   //      edt::DegToRad(0.0f), edt::DegToRad(0.0f), edt::DegToRad(0.0f));
-  //
-  //  render_system.directional_lights_.push_back({&transform, &light});
   //}
   //
   //// Create entity with spot light component
@@ -265,17 +329,15 @@ void Main([[maybe_unused]] int argc, char** argv) {
   //      0.0, 1.0f));
   //  transform.transform *= glm::yawPitchRoll(
   //      edt::DegToRad(0.0f), edt::DegToRad(-90.0f), edt::DegToRad(0.0f));
-  //
-  //  render_system.spot_lights_.push_back({&transform, &light});
   //}
 
   // Create entity with camera component and link it with window
   {
     auto& entity = world.SpawnEntity<Entity>();
     entity.SetName("Camera");
-    CameraComponent& camera = entity.AddComponent<CameraComponent>();
-    windows.back()->SetCamera(&camera);
     entity.AddComponent<TransformComponent>();
+    entity.AddComponent<CameraComponent>();
+    windows.back()->SetCamera(world, entity.GetHandle());
   }
 
   CreateMeshes(world, render_system.shader_);
@@ -285,24 +347,36 @@ void Main([[maybe_unused]] int argc, char** argv) {
 
   auto prev_frame_time = std::chrono::high_resolution_clock::now();
 
-  while (!windows.empty()) {
+  bool keep_running = true;
+  while (keep_running) {
     ScopeAnnotation frame_annotation("Frame");
+    FrameAllocator::Get().BeginFrame();
+    texture_manager.Update();
     const auto current_frame_time = std::chrono::high_resolution_clock::now();
     const auto frame_delta_time =
         std::chrono::duration<float, std::chrono::seconds::period>(
             current_frame_time - prev_frame_time)
             .count();
 
+    world.AdvanceChangeVersion();
+    systems.Update(world, frame_delta_time);
+
     for (size_t i = 0; i < windows.size();) {
       auto& window = windows[i];
 
       [[unlikely]] if (window->ShouldClose()) {
+        // The last window keeps the context alive for the teardown
+        if (windows.size() == 1) {
+          keep_running = false;
+          break;
+        }
         auto erase_it = windows.begin();
         std::advance(erase_it, i);
         windows.erase(erase_it);
         continue;
       }
       window->ProcessInput(frame_delta_time);
+      JobSystem::Get().ExecuteMainThreadJobs();
 
       ImGui_ImplOpenGL3_NewFrame();
       ImGui_ImplGlfw_NewFrame();
@@ -339,14 +413,39 @@ void Main([[maybe_unused]] int argc, char** argv) {
           selected_entity->DrawDetails();
         }
       }
+      if (ImGui::CollapsingHeader("Memory")) {
+        world.GetPools().DrawDetails();
+        if (ImGui::TreeNode("Frame Allocator")) {
+          FrameAllocator::Get().DrawDetails();
+          ImGui::TreePop();
+        }
+        if (ImGui::TreeNode("Tags")) {
+          memory_tracker.DrawDetails();
+          ImGui::TreePop();
+        }
+      }
+      if (ImGui::CollapsingHeader("Textures")) {
+        texture_manager.DrawDetails();
+      }
+      if (ImGui::CollapsingHeader("Systems")) {
+        systems.DrawDetails();
+      }
+      if (ImGui::CollapsingHeader("Jobs")) {
+        JobSystem::Get().DrawDetails();
+      }
+      if (ImGui::CollapsingHeader("Snapshot")) {
+        SnapshotWidget(world, exe_file.parent_path() / "world.snapshot");
+      }
       ImGui::End();
 
+      render_system.DrawDetails();
       render_system.Render(*window, world, selected_entity);
 
       {
         ScopeAnnotation imgui_render("ImGUI");
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        OpenGl::InvalidateStateCache();
       }
 
       window->SwapBuffers();
@@ -354,8 +453,13 @@ void Main([[maybe_unused]] int argc, char** argv) {
     }
 
     glfwPollEvents();
+    OpenGl::FlushCallCounters();
+    memory_tracker.EndFrame();
     prev_frame_time = current_frame_time;
   }
+
+  // Static, so its GL objects have to go while the context is alive
+  GeometryArena::Get().Shutdown();
 }
 
 int main(int argc, char** argv) {
@@ -0,0 +1,103 @@
+#include "mapped_file.hpp"
+
+#include <fmt/format.h>
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  [[unlikely]] if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error(
+        fmt::format("failed to open file {}", path.string()));
+  }
+  file_ = file;
+
+  LARGE_INTEGER size;
+  [[unlikely]] if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    throw std::runtime_error(
+        fmt::format("failed to get size of file {}", path.string()));
+  }
+  size_ = static_cast<size_t>(size.QuadPart);
+  // Empty files can't be mapped
+  [[unlikely]] if (size_ == 0) { return; }
+
+  mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  [[likely]] if (mapping_) {
+    data_ = static_cast<const ui8*>(
+        MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  }
+
+  [[unlikely]] if (!data_) {
+    if (mapping_) {
+      CloseHandle(mapping_);
+    }
+    CloseHandle(file);
+    throw std::runtime_error(
+        fmt::format("failed to map file {}", path.string()));
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+  }
+  CloseHandle(file_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+  const int file = open(path.c_str(), O_RDONLY);
+  [[unlikely]] if (file < 0) {
+    throw std::runtime_error(
+        fmt::format("failed to open file {}", path.string()));
+  }
+
+  struct stat file_stat {};
+  [[unlikely]] if (fstat(file, &file_stat) != 0) {
+    close(file);
+    throw std::runtime_error(
+        fmt::format("failed to get size of file {}", path.string()));
+  }
+  size_ = static_cast<size_t>(file_stat.st_size);
+
+  // Mapping keeps its own reference to the file. Empty files can't be mapped.
+  void* data = size_ ? mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0)
+                     : nullptr;
+  close(file);
+  [[unlikely]] if (data == MAP_FAILED) {
+    throw std::runtime_error(
+        fmt::format("failed to map file {}", path.string()));
+  }
+
+  // Readers go through the file once, let the OS read ahead
+  [[likely]] if (data) { madvise(data, size_, MADV_WILLNEED); }
+  data_ = static_cast<const ui8*>(data);
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    munmap(const_cast<ui8*>(data_), size_);
+  }
+}
+
+#endif
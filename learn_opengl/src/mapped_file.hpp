@@ -0,0 +1,29 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "integer.hpp"
+
+// Read-only view of a whole file mapped into memory. Pages are read by the
+// OS on first access, so there is no copy into a user buffer.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::filesystem::path& path);
+  MappedFile(const MappedFile&) = delete;
+  ~MappedFile();
+
+  [[nodiscard]] std::span<const ui8> GetData() const noexcept {
+    return std::span(data_, size_);
+  }
+
+  MappedFile& operator=(const MappedFile&) = delete;
+
+ private:
+  const ui8* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+};
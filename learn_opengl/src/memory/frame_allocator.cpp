@@ -0,0 +1,30 @@
+#include "memory/frame_allocator.hpp"
+
+#include "wrap/wrap_imgui.h"
+
+FrameAllocator& FrameAllocator::Get() {
+  static FrameAllocator frame_allocator;
+  return frame_allocator;
+}
+
+FrameAllocator::FrameAllocator()
+    : arenas_{LinearArena(kInitialCapacity, MemoryTag::Frame),
+              LinearArena(kInitialCapacity, MemoryTag::Frame)} {}
+
+void FrameAllocator::BeginFrame() noexcept {
+  current_ ^= 1;
+  arenas_[current_].Reset();
+  ++frame_index_;
+}
+
+void FrameAllocator::DrawDetails() const {
+  for (size_t i = 0; i != arenas_.size(); ++i) {
+    const LinearArenaStats& stats = arenas_[i].GetStats();
+    ImGui::Text("arena %zu%s: %zu / %zu bytes in %zu blocks", i,
+                i == current_ ? " (current)" : "", stats.used_bytes,
+                stats.capacity, stats.num_blocks);
+    ImGui::Text("  high-water mark: %zu bytes", stats.peak_used_bytes);
+    ImGui::Text("  system allocations: %llu",
+                static_cast<unsigned long long>(stats.num_block_allocations));
+  }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <memory_resource>
+
+#include "integer.hpp"
+#include "memory/linear_arena.hpp"
+
+// Scratch memory for data that lives at most until the end of the next
+// frame: render queues, culling output, ImGui temporaries. Two arenas are
+// used in turns, so data of the previous frame is still readable while the
+// current one is built. Containers take it through the std::pmr interface.
+// Main thread only.
+class FrameAllocator {
+ public:
+  static constexpr size_t kInitialCapacity = 1024 * 1024;
+
+  static FrameAllocator& Get();
+
+  FrameAllocator(const FrameAllocator&) = delete;
+
+  // Rewinds the arena of the frame before the previous one
+  void BeginFrame() noexcept;
+
+  [[nodiscard]] std::pmr::memory_resource* GetResource() noexcept {
+    return &arenas_[current_];
+  }
+
+  [[nodiscard]] const LinearArenaStats& GetStats() const noexcept {
+    return arenas_[current_].GetStats();
+  }
+  [[nodiscard]] ui64 GetFrameIndex() const noexcept { return frame_index_; }
+
+  void DrawDetails() const;
+
+  FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+ private:
+  FrameAllocator();
+
+ private:
+  std::array<LinearArena, 2> arenas_;
+  size_t current_ = 0;
+  ui64 frame_index_ = 0;
+};
@@ -0,0 +1,88 @@
+#include "memory/linear_arena.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <new>
+
+#include "memory/memory.hpp"
+
+namespace {
+constexpr size_t kBlockAlignment = alignof(std::max_align_t);
+
+[[nodiscard]] constexpr size_t AlignUp(size_t value,
+                                       size_t alignment) noexcept {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+}  // namespace
+
+LinearArena::LinearArena(size_t initial_capacity, MemoryTag tag)
+    : tag_(tag) {
+  [[likely]] if (initial_capacity != 0) { AddBlock(initial_capacity); }
+}
+
+LinearArena::~LinearArena() { FreeBlocks(); }
+
+void LinearArena::Reset() noexcept {
+  [[unlikely]] if (blocks_.size() > 1) {
+    // Merged block is allocated on the next request, Reset can't throw
+    FreeBlocks();
+  }
+
+  [[likely]] if (!blocks_.empty()) {
+    head_ = blocks_.front().begin;
+    end_ = head_ + blocks_.front().size;
+  }
+  stats_.used_bytes = 0;
+}
+
+void* LinearArena::do_allocate(size_t bytes, size_t alignment) {
+  assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+  auto address = reinterpret_cast<uintptr_t>(head_);
+  size_t padding = AlignUp(address, alignment) - address;
+  const auto available = static_cast<size_t>(end_ - head_);
+  [[unlikely]] if (!head_ || padding + bytes > available) {
+    AddBlock(bytes + alignment);
+    address = reinterpret_cast<uintptr_t>(head_);
+    padding = AlignUp(address, alignment) - address;
+  }
+
+  ui8* result = head_ + padding;
+  head_ = result + bytes;
+  stats_.used_bytes += padding + bytes;
+  stats_.peak_used_bytes = std::max(stats_.peak_used_bytes, stats_.used_bytes);
+  ++stats_.num_allocations;
+  return result;
+}
+
+void LinearArena::AddBlock(size_t min_bytes) {
+  // The first block after a reset gets everything the arena has used so far
+  const size_t wanted = blocks_.empty()
+                            ? std::max(min_bytes, stats_.peak_used_bytes)
+                            : std::max(min_bytes, blocks_.back().size * 2);
+  const size_t size = AlignUp(std::max(wanted, kMinBlockBytes),
+                              kBlockAlignment);
+  blocks_.reserve(blocks_.size() + 1);
+  auto begin =
+      reinterpret_cast<ui8*>(Memory::AlignedAlloc(size, kBlockAlignment, tag_));
+  [[unlikely]] if (!begin) { throw std::bad_alloc(); }
+
+  blocks_.push_back({begin, size});
+  head_ = begin;
+  end_ = begin + size;
+  stats_.capacity += size;
+  ++stats_.num_blocks;
+  ++stats_.num_block_allocations;
+}
+
+void LinearArena::FreeBlocks() noexcept {
+  for (const Block& block : blocks_) {
+    Memory::AlignedFree(block.begin);
+  }
+
+  blocks_.clear();
+  head_ = nullptr;
+  end_ = nullptr;
+  stats_.capacity = 0;
+  stats_.num_blocks = 0;
+}
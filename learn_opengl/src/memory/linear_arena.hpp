@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "integer.hpp"
+#include "memory/memory_tag.hpp"
+
+struct LinearArenaStats {
+  size_t used_bytes = 0;
+  size_t capacity = 0;
+  // The most bytes used between two resets
+  size_t peak_used_bytes = 0;
+  size_t num_blocks = 0;
+  // Blocks requested from the system allocator
+  ui64 num_block_allocations = 0;
+  ui64 num_allocations = 0;
+};
+
+// Bump allocator for memory that dies all at once. Deallocation does
+// nothing, Reset rewinds the arena and keeps its memory. When one frame took
+// more than one block, they are merged into a block of the peak size, so
+// that a steady workload runs in a single block without touching the system
+// allocator. Not thread safe.
+class LinearArena : public std::pmr::memory_resource {
+ public:
+  static constexpr size_t kMinBlockBytes = 64 * 1024;
+
+  explicit LinearArena(size_t initial_capacity = 0,
+                       MemoryTag tag = MemoryTag::Untagged);
+  LinearArena(const LinearArena&) = delete;
+  ~LinearArena() override;
+
+  // Memory allocated earlier must not be used after this
+  void Reset() noexcept;
+
+  [[nodiscard]] const LinearArenaStats& GetStats() const noexcept {
+    return stats_;
+  }
+
+  LinearArena& operator=(const LinearArena&) = delete;
+
+ protected:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void*, size_t, size_t) noexcept override {}
+  [[nodiscard]] bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+ private:
+  void AddBlock(size_t min_bytes);
+  void FreeBlocks() noexcept;
+
+ private:
+  struct Block {
+    ui8* begin;
+    size_t size;
+  };
+
+  std::vector<Block> blocks_;
+  ui8* head_ = nullptr;
+  ui8* end_ = nullptr;
+  LinearArenaStats stats_;
+  MemoryTag tag_;
+};
@@ -1,7 +1,11 @@
 #include "memory/memory.hpp"
 
-#include <cassert>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+
+#include "integer.hpp"
+#include "memory/memory_tracker.hpp"
 
 /* C11 - The Universal CRT implemented the parts of the C11 Standard Library
  * that are required by C++17, with the exception of C99 strftime() E/O
@@ -12,30 +16,89 @@
  * aligned allocations.
  */
 
-void* Memory::AlignedAlloc(size_t size, [[maybe_unused]] size_t alignment) {
+namespace {
+// Precedes every allocation, so that it can be uncounted when freed
+struct AllocationHeader {
+  size_t size;
+  // From the start of the system allocation to the user pointer
+  size_t offset;
+  MemoryTag tag;
+};
+
+[[nodiscard]] constexpr size_t AlignUp(size_t value,
+                                       size_t alignment) noexcept {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+[[nodiscard]] AllocationHeader& GetHeader(void* ptr) noexcept {
+  return *(reinterpret_cast<AllocationHeader*>(ptr) - 1);
+}
+
+void* SystemAlignedAlloc(size_t size, size_t alignment) {
 #ifdef _MSC_VER
   return _aligned_malloc(size, alignment);
 #else
-  // compiles but fires an exception...
-  void* pointer = std::malloc(size);
-  assert((reinterpret_cast<size_t>(pointer) % alignment) == 0);
+  // posix_memalign wants a multiple of pointer size and returns memory that
+  // can be released with free
+  void* pointer = nullptr;
+  [[unlikely]] if (posix_memalign(&pointer, std::max(alignment, sizeof(void*)),
+                                  size) != 0) {
+    return nullptr;
+  }
   return pointer;
 #endif
 }
 
-void* Memory::AlignedRealloc(void* ptr, size_t new_size,
-                             [[maybe_unused]] size_t alignment) {
+void SystemAlignedFree(void* ptr) {
 #ifdef _MSC_VER
-  return _aligned_realloc(ptr, new_size, alignment);
+  _aligned_free(ptr);
 #else
-  return std::realloc(ptr, new_size);
+  std::free(ptr);
 #endif
 }
+}  // namespace
+
+void* Memory::AlignedAlloc(size_t size, size_t alignment) {
+  return AlignedAlloc(size, alignment, MemoryTracker::GetCurrentTag());
+}
+
+void* Memory::AlignedAlloc(size_t size, size_t alignment, MemoryTag tag) {
+  MemoryTracker& tracker = MemoryTracker::Get();
+  [[unlikely]] if (!tracker.TryAllocate(tag, MemoryDomain::Cpu, size)) {
+    return nullptr;
+  }
+
+  alignment = std::max(alignment, alignof(AllocationHeader));
+  const size_t offset = AlignUp(sizeof(AllocationHeader), alignment);
+  auto base = reinterpret_cast<ui8*>(SystemAlignedAlloc(offset + size,
+                                                        alignment));
+  [[unlikely]] if (!base) {
+    tracker.OnFree(tag, MemoryDomain::Cpu, size);
+    return nullptr;
+  }
+
+  void* ptr = base + offset;
+  GetHeader(ptr) = {size, offset, tag};
+  return ptr;
+}
+
+void* Memory::AlignedRealloc(void* ptr, [[maybe_unused]] size_t old_size,
+                             size_t new_size, size_t alignment) {
+  [[unlikely]] if (!ptr) { return AlignedAlloc(new_size, alignment); }
+
+  const AllocationHeader& header = GetHeader(ptr);
+  void* new_ptr = AlignedAlloc(new_size, alignment, header.tag);
+  [[likely]] if (new_ptr) {
+    std::memcpy(new_ptr, ptr, std::min(header.size, new_size));
+    AlignedFree(ptr);
+  }
+  return new_ptr;
+}
 
 void Memory::AlignedFree(void* ptr) {
-#ifdef _MSC_VER
-  return _aligned_free(ptr);
-#else
-  return std::free(ptr);
-#endif
-}
\ No newline at end of file
+  [[unlikely]] if (!ptr) { return; }
+
+  const AllocationHeader header = GetHeader(ptr);
+  MemoryTracker::Get().OnFree(header.tag, MemoryDomain::Cpu, header.size);
+  SystemAlignedFree(reinterpret_cast<ui8*>(ptr) - header.offset);
+}
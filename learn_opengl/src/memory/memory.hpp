@@ -3,10 +3,18 @@
 #include <cstdint>
 #include <cstddef>
 
+#include "memory/memory_tag.hpp"
+
 class Memory {
  public:
+  // alignment must be a power of two. Memory is counted in MemoryTracker
+  // under the tag of the current MemoryTagScope. Returns null if the system
+  // is out of memory or the tag is out of its enforced budget.
   static void* AlignedAlloc(std::size_t size, std::size_t alignment);
-  static void* AlignedRealloc(void* ptr, std::size_t new_size,
-                              std::size_t alignment);
+  static void* AlignedAlloc(std::size_t size, std::size_t alignment,
+                            MemoryTag tag);
+  // Contents up to min(old_size, new_size) are preserved. Keeps the tag.
+  static void* AlignedRealloc(void* ptr, std::size_t old_size,
+                              std::size_t new_size, std::size_t alignment);
   static void AlignedFree(void* ptr);
-};
\ No newline at end of file
+};
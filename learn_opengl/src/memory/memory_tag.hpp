@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CppReflection/GetStaticTypeInfo.hpp"
+#include "integer.hpp"
+
+// Subsystem that owns memory, for accounting and budgets
+enum class MemoryTag : ui8 {
+  Untagged,
+  Ecs,
+  Meshes,
+  Textures,
+  Shaders,
+  Names,
+  Ui,
+  // Render targets and per-frame GPU buffers
+  Render,
+  // FrameAllocator arenas
+  Frame,
+  Max
+};
+
+enum class MemoryDomain : ui8 { Cpu, Gpu, Max };
+
+namespace cppreflection {
+template <>
+struct TypeReflectionProvider<MemoryTag> {
+  [[nodiscard]] inline constexpr static auto ReflectType() {
+    return cppreflection::StaticEnumTypeInfo<MemoryTag>(
+               "MemoryTag",
+               edt::GUID::Create("78A6BFBB-CF4E-443E-B88C-7437919A84CF"))
+        .Value(MemoryTag::Untagged, "Untagged")
+        .Value(MemoryTag::Ecs, "Ecs")
+        .Value(MemoryTag::Meshes, "Meshes")
+        .Value(MemoryTag::Textures, "Textures")
+        .Value(MemoryTag::Shaders, "Shaders")
+        .Value(MemoryTag::Names, "Names")
+        .Value(MemoryTag::Ui, "Ui")
+        .Value(MemoryTag::Render, "Render")
+        .Value(MemoryTag::Frame, "Frame")
+        .Value(MemoryTag::Max, "Max");
+  }
+};
+
+template <>
+struct TypeReflectionProvider<MemoryDomain> {
+  [[nodiscard]] inline constexpr static auto ReflectType() {
+    return cppreflection::StaticEnumTypeInfo<MemoryDomain>(
+               "MemoryDomain",
+               edt::GUID::Create("70AC4F80-1B38-4E5F-B6D6-16AAE3AC79F9"))
+        .Value(MemoryDomain::Cpu, "Cpu")
+        .Value(MemoryDomain::Gpu, "Gpu")
+        .Value(MemoryDomain::Max, "Max");
+  }
+};
+}  // namespace cppreflection
@@ -0,0 +1,249 @@
+#include "memory/memory_tracker.hpp"
+
+#include <fmt/format.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+#include "nlohmann/json.hpp"
+#include "spdlog/spdlog.h"
+#include "wrap/wrap_imgui.h"
+
+namespace {
+constexpr ui64 kMiB = 1024 * 1024;
+
+thread_local MemoryTag t_current_tag = MemoryTag::Untagged;
+
+[[nodiscard]] double ToMiB(ui64 bytes) noexcept {
+  return static_cast<double>(bytes) / static_cast<double>(kMiB);
+}
+}  // namespace
+
+MemoryTracker& MemoryTracker::Get() {
+  // Never destroyed: static destructors free tracked memory too
+  static MemoryTracker& memory_tracker = *new MemoryTracker();
+  return memory_tracker;
+}
+
+MemoryTracker::MemoryTracker()
+#ifdef ENFORCE_MEMORY_BUDGETS
+    : enforce_budgets_(true),
+#else
+    : enforce_budgets_(false),
+#endif
+      last_dump_time_(std::chrono::steady_clock::now()) {
+}
+
+bool MemoryTracker::TryAllocate(MemoryTag tag, MemoryDomain domain,
+                                size_t bytes) noexcept {
+  Counters& counters = GetCounters(tag, domain);
+  const ui64 budget = counters.budget.load(std::memory_order_relaxed);
+  // ImGui doesn't check allocations, so UI can only be warned about
+  [[likely]] if (budget == 0 || tag == MemoryTag::Ui ||
+                 !enforce_budgets_.load(std::memory_order_relaxed)) {
+    OnAllocate(tag, domain, bytes);
+    return true;
+  }
+
+  ui64 live = counters.live_bytes.load(std::memory_order_relaxed);
+  do {
+    [[unlikely]] if (live + bytes > budget) {
+      counters.budget_overruns.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  } while (!counters.live_bytes.compare_exchange_weak(
+      live, live + bytes, std::memory_order_relaxed));
+
+  Count(tag, domain, counters, live, bytes);
+  return true;
+}
+
+void MemoryTracker::OnAllocate(MemoryTag tag, MemoryDomain domain,
+                               size_t bytes) noexcept {
+  Counters& counters = GetCounters(tag, domain);
+  const ui64 live =
+      counters.live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  Count(tag, domain, counters, live, bytes);
+}
+
+void MemoryTracker::OnFree(MemoryTag tag, MemoryDomain domain,
+                           size_t bytes) noexcept {
+  Counters& counters = GetCounters(tag, domain);
+  counters.live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+  counters.live_allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::Count(MemoryTag tag, MemoryDomain domain,
+                          Counters& counters, ui64 live_before,
+                          ui64 bytes) noexcept {
+  const ui64 live = live_before + bytes;
+  counters.live_allocations.fetch_add(1, std::memory_order_relaxed);
+  counters.num_allocations.fetch_add(1, std::memory_order_relaxed);
+  counters.total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+  ui64 peak = counters.peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !counters.peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+
+  // Warn once per crossing, not on every allocation above the budget
+  const ui64 budget = counters.budget.load(std::memory_order_relaxed);
+  [[unlikely]] if (budget != 0 && live > budget && live_before <= budget) {
+    counters.budget_overruns.fetch_add(1, std::memory_order_relaxed);
+    const std::string_view tag_name = cppreflection::EnumToString(tag);
+    const std::string_view domain_name = cppreflection::EnumToString(domain);
+    spdlog::warn("{} {} memory is over budget: {:.2f} of {:.2f} MiB",
+                 tag_name, domain_name, ToMiB(live), ToMiB(budget));
+  }
+}
+
+MemoryStats MemoryTracker::GetStats(MemoryTag tag,
+                                    MemoryDomain domain) const noexcept {
+  const Counters& counters = GetCounters(tag, domain);
+  MemoryStats stats;
+  stats.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+  stats.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+  stats.live_allocations =
+      counters.live_allocations.load(std::memory_order_relaxed);
+  stats.num_allocations =
+      counters.num_allocations.load(std::memory_order_relaxed);
+  stats.frame_allocations = counters.frame_allocations;
+  stats.frame_bytes = counters.frame_bytes;
+  stats.budget = counters.budget.load(std::memory_order_relaxed);
+  stats.budget_overruns =
+      counters.budget_overruns.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void MemoryTracker::SetBudget(MemoryTag tag, MemoryDomain domain,
+                              ui64 bytes) noexcept {
+  GetCounters(tag, domain).budget.store(bytes, std::memory_order_relaxed);
+}
+
+void MemoryTracker::LoadBudgets(const std::filesystem::path& path) {
+  std::ifstream file(path);
+  [[unlikely]] if (!file.is_open()) {
+    throw std::runtime_error(
+        fmt::format("Failed to open file {}", path.string()));
+  }
+
+  nlohmann::json json;
+  file >> json;
+  for (size_t i = 0; i != kNumTags; ++i) {
+    const auto tag = static_cast<MemoryTag>(i);
+    const std::string key(cppreflection::EnumToString(tag));
+    [[likely]] if (!json.contains(key)) { continue; }
+
+    const nlohmann::json& budgets = json[key];
+    if (budgets.contains("cpu_mib")) {
+      SetBudget(tag, MemoryDomain::Cpu, budgets["cpu_mib"].get<ui64>() * kMiB);
+    }
+    if (budgets.contains("gpu_mib")) {
+      SetBudget(tag, MemoryDomain::Gpu, budgets["gpu_mib"].get<ui64>() * kMiB);
+    }
+  }
+}
+
+void MemoryTracker::SetBudgetsEnforced(bool enforced) noexcept {
+  enforce_budgets_.store(enforced, std::memory_order_relaxed);
+}
+
+bool MemoryTracker::AreBudgetsEnforced() const noexcept {
+  return enforce_budgets_.load(std::memory_order_relaxed);
+}
+
+MemoryTag MemoryTracker::GetCurrentTag() noexcept { return t_current_tag; }
+
+void MemoryTracker::EndFrame() {
+  for (auto& domains : counters_) {
+    for (Counters& counters : domains) {
+      const ui64 num_allocations =
+          counters.num_allocations.load(std::memory_order_relaxed);
+      const ui64 total_bytes =
+          counters.total_bytes.load(std::memory_order_relaxed);
+      counters.frame_allocations =
+          num_allocations - counters.last_num_allocations;
+      counters.frame_bytes = total_bytes - counters.last_total_bytes;
+      counters.last_num_allocations = num_allocations;
+      counters.last_total_bytes = total_bytes;
+    }
+  }
+
+  [[likely]] if (dump_interval_.count() == 0) { return; }
+  const auto now = std::chrono::steady_clock::now();
+  [[unlikely]] if (now - last_dump_time_ >= dump_interval_) {
+    last_dump_time_ = now;
+    Dump();
+  }
+}
+
+void MemoryTracker::Dump() const {
+  // Warning level passes the default log level of the application
+  spdlog::warn("Memory by tag:");
+  for (size_t i = 0; i != kNumTags; ++i) {
+    const auto tag = static_cast<MemoryTag>(i);
+    for (size_t j = 0; j != kNumDomains; ++j) {
+      const auto domain = static_cast<MemoryDomain>(j);
+      const MemoryStats stats = GetStats(tag, domain);
+      [[likely]] if (stats.peak_bytes == 0) { continue; }
+
+      spdlog::warn(
+          "  {} {}: {:.2f} MiB live in {} allocations, {:.2f} MiB peak, "
+          "{} allocations last frame, budget {:.2f} MiB, {} overruns",
+          cppreflection::EnumToString(tag),
+          cppreflection::EnumToString(domain), ToMiB(stats.live_bytes),
+          stats.live_allocations, ToMiB(stats.peak_bytes),
+          stats.frame_allocations, ToMiB(stats.budget),
+          stats.budget_overruns);
+    }
+  }
+}
+
+void MemoryTracker::DrawDetails() {
+  bool enforced = AreBudgetsEnforced();
+  if (ImGui::Checkbox("enforce budgets", &enforced)) {
+    SetBudgetsEnforced(enforced);
+  }
+
+  int interval = static_cast<int>(dump_interval_.count());
+  if (ImGui::SliderInt("dump interval, s", &interval, 0, 300)) {
+    dump_interval_ = std::chrono::seconds(interval);
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Dump")) {
+    Dump();
+  }
+
+  for (size_t i = 0; i != kNumTags; ++i) {
+    const auto tag = static_cast<MemoryTag>(i);
+    const std::string_view tag_name = cppreflection::EnumToString(tag);
+    for (size_t j = 0; j != kNumDomains; ++j) {
+      const auto domain = static_cast<MemoryDomain>(j);
+      const MemoryStats stats = GetStats(tag, domain);
+      [[likely]] if (stats.peak_bytes == 0) { continue; }
+
+      const std::string_view domain_name =
+          cppreflection::EnumToString(domain);
+      ImGui::Text("%.*s %.*s: %.2f / %.2f MiB peak, %llu allocations",
+                  static_cast<int>(tag_name.size()), tag_name.data(),
+                  static_cast<int>(domain_name.size()), domain_name.data(),
+                  ToMiB(stats.live_bytes), ToMiB(stats.peak_bytes),
+                  static_cast<unsigned long long>(stats.live_allocations));
+      ImGui::Text("  frame: %llu allocations, %.3f MiB",
+                  static_cast<unsigned long long>(stats.frame_allocations),
+                  ToMiB(stats.frame_bytes));
+      [[unlikely]] if (stats.budget != 0) {
+        ImGui::Text("  budget: %.2f MiB, %u overruns", ToMiB(stats.budget),
+                    stats.budget_overruns);
+      }
+    }
+  }
+}
+
+MemoryTagScope::MemoryTagScope(MemoryTag tag) noexcept
+    : previous_(t_current_tag) {
+  t_current_tag = tag;
+}
+
+MemoryTagScope::~MemoryTagScope() { t_current_tag = previous_; }
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+
+#include "integer.hpp"
+#include "memory/memory_tag.hpp"
+
+struct MemoryStats {
+  ui64 live_bytes = 0;
+  ui64 peak_bytes = 0;
+  ui64 live_allocations = 0;
+  ui64 num_allocations = 0;
+  // Of the last complete frame
+  ui64 frame_allocations = 0;
+  ui64 frame_bytes = 0;
+  // Zero means no budget
+  ui64 budget = 0;
+  ui32 budget_overruns = 0;
+};
+
+// Live and peak bytes per memory tag, separately for CPU memory and GPU
+// objects. Memory::AlignedAlloc reports here, as do OpenGl buffer and texture
+// calls and owners of memory allocated elsewhere (stb, ImGui). Crossing a
+// budget logs a warning. With enforcement on, Memory::AlignedAlloc fails
+// instead of going over a CPU budget, except for MemoryTag::Ui. Thread safe.
+class MemoryTracker {
+ public:
+  static constexpr size_t kNumTags = static_cast<size_t>(MemoryTag::Max);
+  static constexpr size_t kNumDomains = static_cast<size_t>(MemoryDomain::Max);
+
+  static MemoryTracker& Get();
+
+  MemoryTracker(const MemoryTracker&) = delete;
+
+  // Returns false without counting if the allocation would exceed the budget
+  // while enforcement is on
+  [[nodiscard]] bool TryAllocate(MemoryTag tag, MemoryDomain domain,
+                                 size_t bytes) noexcept;
+  // Counts memory that can't be refused
+  void OnAllocate(MemoryTag tag, MemoryDomain domain, size_t bytes) noexcept;
+  void OnFree(MemoryTag tag, MemoryDomain domain, size_t bytes) noexcept;
+
+  [[nodiscard]] MemoryStats GetStats(MemoryTag tag,
+                                     MemoryDomain domain) const noexcept;
+
+  void SetBudget(MemoryTag tag, MemoryDomain domain, ui64 bytes) noexcept;
+  // Object of tag names with optional "cpu_mib" and "gpu_mib" numbers
+  void LoadBudgets(const std::filesystem::path& path);
+  void SetBudgetsEnforced(bool enforced) noexcept;
+  [[nodiscard]] bool AreBudgetsEnforced() const noexcept;
+
+  // Tag of untagged allocations made by this thread
+  [[nodiscard]] static MemoryTag GetCurrentTag() noexcept;
+
+  // Publishes per-frame counters and dumps stats if the interval passed.
+  // Main thread only.
+  void EndFrame();
+  // Zero disables periodic dumps
+  void SetDumpInterval(std::chrono::seconds interval) noexcept {
+    dump_interval_ = interval;
+  }
+  void Dump() const;
+
+  void DrawDetails();
+
+  MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+ private:
+  struct Counters {
+    std::atomic<ui64> live_bytes = 0;
+    std::atomic<ui64> peak_bytes = 0;
+    std::atomic<ui64> live_allocations = 0;
+    std::atomic<ui64> num_allocations = 0;
+    std::atomic<ui64> total_bytes = 0;
+    std::atomic<ui64> budget = 0;
+    std::atomic<ui32> budget_overruns = 0;
+    // Totals at the end of the previous frame, main thread only
+    ui64 last_num_allocations = 0;
+    ui64 last_total_bytes = 0;
+    ui64 frame_allocations = 0;
+    ui64 frame_bytes = 0;
+  };
+
+  MemoryTracker();
+
+  [[nodiscard]] Counters& GetCounters(MemoryTag tag,
+                                      MemoryDomain domain) noexcept {
+    return counters_[static_cast<size_t>(tag)]
+                    [static_cast<size_t>(domain)];
+  }
+  [[nodiscard]] const Counters& GetCounters(
+      MemoryTag tag, MemoryDomain domain) const noexcept {
+    return counters_[static_cast<size_t>(tag)]
+                    [static_cast<size_t>(domain)];
+  }
+
+  // Counts an allocation which live bytes are already added
+  void Count(MemoryTag tag, MemoryDomain domain, Counters& counters,
+             ui64 live_before, ui64 bytes) noexcept;
+
+ private:
+  std::array<std::array<Counters, kNumDomains>, kNumTags> counters_;
+  std::atomic<bool> enforce_budgets_;
+  std::chrono::seconds dump_interval_{0};
+  std::chrono::steady_clock::time_point last_dump_time_;
+};
+
+// Makes untagged allocations and GPU objects created by this thread in the
+// scope belong to the tag
+class MemoryTagScope {
+ public:
+  explicit MemoryTagScope(MemoryTag tag) noexcept;
+  MemoryTagScope(const MemoryTagScope&) = delete;
+  ~MemoryTagScope();
+  MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+ private:
+  MemoryTag previous_;
+};
@@ -0,0 +1,65 @@
+#include "memory/range_allocator.hpp"
+
+#include <cassert>
+#include <iterator>
+
+RangeAllocator::RangeAllocator(size_t capacity) { Grow(capacity); }
+
+std::optional<size_t> RangeAllocator::Allocate(size_t count) {
+  [[unlikely]] if (count == 0) { return std::optional<size_t>(); }
+
+  for (auto it = free_ranges_.begin(); it != free_ranges_.end(); ++it) {
+    auto [offset, size] = *it;
+    if (size < count) {
+      continue;
+    }
+
+    free_ranges_.erase(it);
+    if (size != count) {
+      free_ranges_.emplace(offset + count, size - count);
+    }
+
+    used_ += count;
+    return offset;
+  }
+
+  return std::optional<size_t>();
+}
+
+void RangeAllocator::Free(size_t offset, size_t count) {
+  [[unlikely]] if (count == 0) { return; }
+
+  assert(offset + count <= capacity_);
+  assert(used_ >= count);
+  used_ -= count;
+
+  auto next = free_ranges_.lower_bound(offset);
+  assert(next == free_ranges_.end() || next->first >= offset + count);
+
+  // Merge with the following range
+  if (next != free_ranges_.end() && next->first == offset + count) {
+    count += next->second;
+    next = free_ranges_.erase(next);
+  }
+
+  // Merge with the preceding range
+  if (next != free_ranges_.begin()) {
+    auto prev = std::prev(next);
+    assert(prev->first + prev->second <= offset);
+    if (prev->first + prev->second == offset) {
+      prev->second += count;
+      return;
+    }
+  }
+
+  free_ranges_.emplace_hint(next, offset, count);
+}
+
+void RangeAllocator::Grow(size_t new_capacity) {
+  [[unlikely]] if (new_capacity <= capacity_) { return; }
+
+  const size_t old_capacity = capacity_;
+  capacity_ = new_capacity;
+  used_ += new_capacity - old_capacity;
+  Free(old_capacity, new_capacity - old_capacity);
+}
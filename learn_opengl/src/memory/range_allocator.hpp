@@ -0,0 +1,29 @@
+#pragma once
+
+#include <map>
+#include <optional>
+
+// First-fit suballocator of [0, capacity) ranges. Does not own any memory,
+// only tracks which units are in use. Adjacent free ranges are coalesced.
+class RangeAllocator {
+ public:
+  explicit RangeAllocator(size_t capacity = 0);
+
+  [[nodiscard]] std::optional<size_t> Allocate(size_t count);
+  void Free(size_t offset, size_t count);
+
+  // Appends free space to the end
+  void Grow(size_t new_capacity);
+
+  [[nodiscard]] size_t GetCapacity() const noexcept { return capacity_; }
+  [[nodiscard]] size_t GetUsed() const noexcept { return used_; }
+  [[nodiscard]] size_t GetNumFreeRanges() const noexcept {
+    return free_ranges_.size();
+  }
+
+ private:
+  // offset -> size
+  std::map<size_t, size_t> free_ranges_;
+  size_t capacity_ = 0;
+  size_t used_ = 0;
+};
@@ -0,0 +1,78 @@
+#include "memory/slab_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+#include "memory/memory.hpp"
+
+namespace {
+[[nodiscard]] constexpr size_t AlignUp(size_t value,
+                                       size_t alignment) noexcept {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+}  // namespace
+
+SlabPool::SlabPool(size_t block_size, size_t alignment, MemoryTag tag)
+    : tag_(tag) {
+  assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+  stats_.alignment = std::max(alignment, alignof(FreeBlock));
+  stats_.block_size =
+      AlignUp(std::max(block_size, sizeof(FreeBlock)), stats_.alignment);
+  blocks_per_slab_ =
+      std::max(kMinSlabBytes / stats_.block_size, kMinBlocksPerSlab);
+}
+
+SlabPool::~SlabPool() { Release(); }
+
+void* SlabPool::Allocate() {
+  void* block = nullptr;
+  if (free_list_) {
+    block = free_list_;
+    free_list_ = free_list_->next;
+  } else {
+    [[unlikely]] if (tail_ == tail_end_) { AddSlab(); }
+    block = tail_;
+    tail_ += stats_.block_size;
+  }
+
+  ++stats_.num_allocations;
+  stats_.peak_used_blocks =
+      std::max(stats_.peak_used_blocks, ++stats_.used_blocks);
+  return block;
+}
+
+void SlabPool::Free(void* block) noexcept {
+  [[unlikely]] if (!block) { return; }
+  assert(stats_.used_blocks != 0);
+
+  auto free_block = reinterpret_cast<FreeBlock*>(block);
+  free_block->next = free_list_;
+  free_list_ = free_block;
+  --stats_.used_blocks;
+}
+
+void SlabPool::Release() noexcept {
+  for (void* slab : slabs_) {
+    Memory::AlignedFree(slab);
+  }
+
+  slabs_.clear();
+  free_list_ = nullptr;
+  tail_ = nullptr;
+  tail_end_ = nullptr;
+  stats_.num_slabs = 0;
+  stats_.used_blocks = 0;
+}
+
+void SlabPool::AddSlab() {
+  const size_t slab_bytes = stats_.block_size * blocks_per_slab_;
+  slabs_.reserve(slabs_.size() + 1);
+  void* slab = Memory::AlignedAlloc(slab_bytes, stats_.alignment, tag_);
+  [[unlikely]] if (!slab) { throw std::bad_alloc(); }
+
+  slabs_.push_back(slab);
+  tail_ = reinterpret_cast<ui8*>(slab);
+  tail_end_ = tail_ + slab_bytes;
+  ++stats_.num_slabs;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "integer.hpp"
+#include "memory/memory_tag.hpp"
+
+struct SlabPoolStats {
+  size_t block_size = 0;
+  size_t alignment = 0;
+  size_t num_slabs = 0;
+  size_t used_blocks = 0;
+  size_t peak_used_blocks = 0;
+  ui64 num_allocations = 0;
+};
+
+// Allocator of fixed size blocks carved out of large slabs. Freed blocks go
+// to an intrusive free list and are reused first. Memory goes back to the
+// system only when the whole pool is released. Not thread safe.
+class SlabPool {
+ public:
+  static constexpr size_t kMinSlabBytes = 64 * 1024;
+  static constexpr size_t kMinBlocksPerSlab = 8;
+
+  // alignment must be a power of two
+  SlabPool(size_t block_size, size_t alignment,
+           MemoryTag tag = MemoryTag::Untagged);
+  SlabPool(const SlabPool&) = delete;
+  ~SlabPool();
+
+  [[nodiscard]] void* Allocate();
+  void Free(void* block) noexcept;
+
+  // Frees all slabs at once. Blocks allocated earlier must not be used.
+  void Release() noexcept;
+
+  [[nodiscard]] const SlabPoolStats& GetStats() const noexcept {
+    return stats_;
+  }
+
+  SlabPool& operator=(const SlabPool&) = delete;
+
+ private:
+  void AddSlab();
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  std::vector<void*> slabs_;
+  FreeBlock* free_list_ = nullptr;
+  // Never used part of the last slab
+  ui8* tail_ = nullptr;
+  ui8* tail_end_ = nullptr;
+  size_t blocks_per_slab_ = 0;
+  SlabPoolStats stats_;
+  MemoryTag tag_;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "memory/memory.hpp"
+#include "memory/memory_tag.hpp"
+
+// Standard allocator that counts memory of a container under the tag
+template <typename T, MemoryTag Tag>
+class TaggedAllocator {
+ public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = TaggedAllocator<U, Tag>;
+  };
+
+  TaggedAllocator() noexcept = default;
+  template <typename U>
+  TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept {}
+
+  [[nodiscard]] T* allocate(size_t n) {
+    [[unlikely]] if (n > SIZE_MAX / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    void* ptr = Memory::AlignedAlloc(n * sizeof(T), alignof(T), Tag);
+    [[unlikely]] if (!ptr) { throw std::bad_alloc(); }
+    return static_cast<T*>(ptr);
+  }
+
+  void deallocate(T* ptr, size_t) noexcept { Memory::AlignedFree(ptr); }
+
+  template <typename U>
+  [[nodiscard]] bool operator==(const TaggedAllocator<U, Tag>&) const noexcept {
+    return true;
+  }
+};
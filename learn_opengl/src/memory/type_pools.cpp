@@ -0,0 +1,125 @@
+#include "memory/type_pools.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <new>
+#include <string>
+
+#include "memory/memory.hpp"
+#include "reflection/type_indices.hpp"
+#include "wrap/wrap_imgui.h"
+
+namespace {
+constexpr size_t kMinAlignment = 16;
+constexpr ui32 kNoSlot = ~ui32{0};
+
+// Multiples of 16 bytes for small objects, powers of two for the rest
+[[nodiscard]] constexpr size_t GetSizeClass(size_t size) noexcept {
+  [[likely]] if (size <= 256) { return (size + 15) & ~size_t{15}; }
+  return std::bit_ceil(size);
+}
+}  // namespace
+
+TypePools::TypePools() = default;
+TypePools::~TypePools() = default;
+
+void* TypePools::Allocate(size_t size, size_t alignment) {
+  [[likely]] if (SlabPool* pool = FindOrCreatePool(size, alignment)) {
+    return pool->Allocate();
+  }
+
+  void* block = Memory::AlignedAlloc(size, alignment, MemoryTag::Ecs);
+  [[unlikely]] if (!block) { throw std::bad_alloc(); }
+  return block;
+}
+
+void TypePools::Free(void* block, size_t size, size_t alignment) noexcept {
+  [[likely]] if (SlabPool* pool = FindPool(size, alignment)) {
+    pool->Free(block);
+  } else {
+    Memory::AlignedFree(block);
+  }
+}
+
+void* TypePools::Allocate(const cppreflection::Type& type) {
+  const size_t slot = GetTypeSlot(type);
+  void* block = nullptr;
+  [[likely]] if (SlabPool* pool = type_pools_[slot]) {
+    block = pool->Allocate();
+  } else {
+    block = Allocate(type.GetInstanceSize(), type.GetAlignment());
+  }
+
+  TypeAllocationStats& stats = type_stats_[slot];
+  ++stats.total;
+  stats.peak = std::max(stats.peak, ++stats.live);
+  return block;
+}
+
+void TypePools::Free(const cppreflection::Type& type, void* block) noexcept {
+  const ui32 slot = type_slots_[*TypeIndices::Get().FindIndex(type)];
+  [[likely]] if (SlabPool* pool = type_pools_[slot]) {
+    pool->Free(block);
+  } else {
+    Memory::AlignedFree(block);
+  }
+
+  --type_stats_[slot].live;
+}
+
+void TypePools::DrawDetails() const {
+  if (ImGui::TreeNode("Types")) {
+    for (const TypeAllocationStats& stats : type_stats_) {
+      const std::string_view name = stats.type->GetName();
+      ImGui::Text("%.*s: %zu live, %zu peak, %llu total",
+                  static_cast<int>(name.size()), name.data(), stats.live,
+                  stats.peak,
+                  static_cast<unsigned long long>(stats.total));
+    }
+    ImGui::TreePop();
+  }
+
+  if (ImGui::TreeNode("Pools")) {
+    for (const auto& [key, pool] : pools_) {
+      const SlabPoolStats& stats = pool->GetStats();
+      ImGui::Text("%zu bytes (align %zu): %zu / %zu blocks, %zu slabs",
+                  stats.block_size, stats.alignment, stats.used_blocks,
+                  stats.peak_used_blocks, stats.num_slabs);
+    }
+    ImGui::TreePop();
+  }
+}
+
+SlabPool* TypePools::FindOrCreatePool(size_t size, size_t alignment) {
+  [[unlikely]] if (size > kMaxPooledSize) { return nullptr; }
+
+  const auto key =
+      std::make_pair(GetSizeClass(size), std::max(alignment, kMinAlignment));
+  std::unique_ptr<SlabPool>& pool = pools_[key];
+  [[unlikely]] if (!pool) {
+    pool = std::make_unique<SlabPool>(key.first, key.second, MemoryTag::Ecs);
+  }
+  return pool.get();
+}
+
+SlabPool* TypePools::FindPool(size_t size, size_t alignment) const noexcept {
+  const auto it = pools_.find(
+      std::make_pair(GetSizeClass(size), std::max(alignment, kMinAlignment)));
+  return it != pools_.end() ? it->second.get() : nullptr;
+}
+
+size_t TypePools::GetTypeSlot(const cppreflection::Type& type) {
+  const ui32 type_index = TypeIndices::Get().Register(type);
+  [[unlikely]] if (type_index >= type_slots_.size()) {
+    type_slots_.resize(type_index + 1, kNoSlot);
+  }
+
+  ui32& slot = type_slots_[type_index];
+  [[unlikely]] if (slot == kNoSlot) {
+    slot = static_cast<ui32>(type_stats_.size());
+    type_stats_.push_back({&type});
+    type_pools_.push_back(
+        FindOrCreatePool(type.GetInstanceSize(), type.GetAlignment()));
+  }
+  return slot;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "CppReflection/TypeRegistry.hpp"
+#include "integer.hpp"
+#include "memory/slab_pool.hpp"
+
+struct TypeAllocationStats {
+  const cppreflection::Type* type = nullptr;
+  size_t live = 0;
+  size_t peak = 0;
+  ui64 total = 0;
+};
+
+// Slab pools for objects of reflected types. Sizes are rounded up to size
+// classes so that types of similar size share blocks. Everything is released
+// at once when the pools are destroyed, objects must be destroyed before
+// that. Not thread safe.
+class TypePools {
+ public:
+  // Larger blocks go directly to the system allocator
+  static constexpr size_t kMaxPooledSize = 64 * 1024;
+
+  TypePools();
+  TypePools(const TypePools&) = delete;
+  ~TypePools();
+
+  [[nodiscard]] void* Allocate(size_t size, size_t alignment);
+  void Free(void* block, size_t size, size_t alignment) noexcept;
+
+  // Memory for an instance of the type. Tracked in per type stats.
+  [[nodiscard]] void* Allocate(const cppreflection::Type& type);
+  void Free(const cppreflection::Type& type, void* block) noexcept;
+
+  // Stats of types that were allocated at least once
+  [[nodiscard]] std::span<const TypeAllocationStats> GetTypeStats()
+      const noexcept {
+    return type_stats_;
+  }
+
+  void DrawDetails() const;
+
+  TypePools& operator=(const TypePools&) = delete;
+
+ private:
+  // Null for sizes above kMaxPooledSize
+  [[nodiscard]] SlabPool* FindOrCreatePool(size_t size, size_t alignment);
+  [[nodiscard]] SlabPool* FindPool(size_t size,
+                                   size_t alignment) const noexcept;
+  [[nodiscard]] size_t GetTypeSlot(const cppreflection::Type& type);
+
+ private:
+  // (size class, alignment) -> pool
+  std::map<std::pair<size_t, size_t>, std::unique_ptr<SlabPool>> pools_;
+  // Indexed by TypeIndices index
+  std::vector<ui32> type_slots_;
+  std::vector<SlabPool*> type_pools_;
+  std::vector<TypeAllocationStats> type_stats_;
+};
@@ -13,6 +13,11 @@ Name::Name(const std::string_view& view) {
   id_ = NameCache::Get().GetId(view);
 }
 
+Name::Name(std::string_view view, ui64 hash) {
+  using namespace name_cache_impl;
+  id_ = NameCache::Get().GetId(view, hash);
+}
+
 [[nodiscard]] bool Name::IsValid() const noexcept {
   return id_ != kInvalidNameId;
 }
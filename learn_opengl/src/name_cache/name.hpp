@@ -16,6 +16,8 @@ class Name {
   Name(const std::string_view& view);
   Name(const std::string& string);
   Name(const char* strptr);
+  // Hash must be HashName(view), see "..."_name literals
+  Name(std::string_view view, ui64 hash);
 
   std::string_view GetView() const;
 
@@ -1,30 +1,116 @@
 #include "name_cache/name_cache.hpp"
 
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 
 namespace name_cache_impl {
-NameId NameCache::GetId(std::string_view view) {
-  auto it = view_to_id_.find(view);
-  if (it == view_to_id_.end()) {
-    const NameId id = next_id_++;
+NameCache::~NameCache() {
+  for (size_t i = 0; i != kNumSegments; ++i) {
+    if (Entry* segment = segments_[i].load(std::memory_order_relaxed)) {
+      const size_t size = GetSegmentSize(i);
+      std::destroy_n(segment, size);
+      Allocator<Entry>().deallocate(segment, size);
+    }
+  }
+}
+
+NameId NameCache::GetId(std::string_view view, ui64 hash) {
+  const HashedView key{view, hash};
+  // Low bits select the bucket inside the shard
+  Shard& shard = shards_[(hash >> 32) % kNumShards];
+
+  {
+    std::shared_lock lock(shard.mutex);
+    auto it = shard.view_to_id.find(key);
+    [[likely]] if (it != shard.view_to_id.end()) { return it->second; }
+  }
 
-    std::string& str = id_to_str_[id];
-    str = view;
+  std::unique_lock lock(shard.mutex);
+  // Another thread could add the same string between the locks
+  auto it = shard.view_to_id.find(key);
+  [[unlikely]] if (it != shard.view_to_id.end()) { return it->second; }
 
-    view_to_id_[str] = id;
-    it = view_to_id_.find(view);
+  const NameId id = next_id_.fetch_add(1, std::memory_order_relaxed);
+  [[unlikely]] if (id == Name::kInvalidNameId) {
+    throw std::overflow_error("Too many names");
   }
 
-  return it->second;
+  // Terminated so that views can be passed to C APIs
+  auto chars = static_cast<char*>(shard.chars.allocate(view.size() + 1, 1));
+  std::memcpy(chars, view.data(), view.size());
+  chars[view.size()] = '\0';
+
+  const HashedView stored{std::string_view(chars, view.size()), hash};
+  Publish(id, stored);
+  shard.view_to_id.emplace(stored, id);
+  return id;
+}
+
+std::optional<std::string_view> NameCache::FindView(
+    NameId id) const noexcept {
+  const Entry* entry = FindEntry(id);
+  [[unlikely]] if (!entry) { return std::nullopt; }
+  return std::string_view(entry->data.load(std::memory_order_relaxed),
+                          entry->size);
+}
+
+std::optional<ui64> NameCache::FindHash(NameId id) const noexcept {
+  const Entry* entry = FindEntry(id);
+  [[unlikely]] if (!entry) { return std::nullopt; }
+  return entry->hash;
+}
+
+const NameCache::Entry* NameCache::FindEntry(NameId id) const noexcept {
+  const EntryLocation location = LocateEntry(id);
+  const Entry* segment =
+      segments_[location.segment].load(std::memory_order_acquire);
+  [[unlikely]] if (!segment) { return nullptr; }
+
+  const Entry& entry = segment[location.offset];
+  [[unlikely]] if (!entry.data.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return &entry;
 }
 
-std::optional<std::string_view> NameCache::FindView(NameId id) const {
-  auto it = id_to_str_.find(id);
-  if (it != id_to_str_.end()) {
-    return it->second;
+NameCache::Entry& NameCache::GetOrAddEntry(NameId id) {
+  const EntryLocation location = LocateEntry(id);
+  std::atomic<Entry*>& slot = segments_[location.segment];
+  Entry* segment = slot.load(std::memory_order_acquire);
+  [[unlikely]] if (!segment) {
+    // Threads of different shards may race to create the segment
+    const size_t size = GetSegmentSize(location.segment);
+    Entry* created = Allocator<Entry>().allocate(size);
+    std::uninitialized_default_construct_n(created, size);
+    if (slot.compare_exchange_strong(segment, created,
+                                     std::memory_order_acq_rel)) {
+      segment = created;
+    } else {
+      std::destroy_n(created, size);
+      Allocator<Entry>().deallocate(created, size);
+    }
   }
 
-  return std::optional<std::string_view>();
+  return segment[location.offset];
+}
+
+NameCache::EntryLocation NameCache::LocateEntry(NameId id) noexcept {
+  // Biasing by the first segment size makes segment boundaries powers of two
+  const ui64 biased = ui64{id} + (ui64{1} << kFirstSegmentBits);
+  const auto top_bit = static_cast<size_t>(std::bit_width(biased) - 1);
+  return EntryLocation{
+      .segment = top_bit - kFirstSegmentBits,
+      .offset = static_cast<size_t>(biased - (ui64{1} << top_bit))};
+}
+
+void NameCache::Publish(NameId id, const HashedView& key) {
+  Entry& entry = GetOrAddEntry(id);
+  entry.size = key.view.size();
+  entry.hash = key.hash;
+  entry.data.store(key.view.data(), std::memory_order_release);
 }
 
 NameCache& NameCache::Get() {
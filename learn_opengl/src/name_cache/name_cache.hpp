@@ -1,24 +1,107 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <functional>
 #include <limits>
 #include <optional>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
+#include "memory/linear_arena.hpp"
+#include "memory/tagged_allocator.hpp"
 #include "name_cache/name.hpp"
+#include "name_cache/name_hash.hpp"
 
 namespace name_cache_impl {
 using NameId = Name::NameId;
+
+// Interns strings from any thread. Strings are spread over shards by hash,
+// each guarded by its own reader-writer lock, so parallel loaders rarely
+// contend. Ids come from a single counter and never change. Characters live
+// in per-shard chunk arenas and are never moved or freed. Id to string
+// lookups index a dense table of fixed segments which is never reallocated,
+// which makes FindView wait-free.
 class NameCache {
  public:
   static NameCache& Get();
 
-  NameId GetId(std::string_view view);
-  std::optional<std::string_view> FindView(NameId id) const;
+  NameCache() = default;
+  NameCache(const NameCache&) = delete;
+  ~NameCache();
+
+  NameId GetId(std::string_view view) { return GetId(view, HashName(view)); }
+  // Hash must be HashName(view)
+  NameId GetId(std::string_view view, ui64 hash);
+  std::optional<std::string_view> FindView(NameId id) const noexcept;
+  std::optional<ui64> FindHash(NameId id) const noexcept;
+
+  NameCache& operator=(const NameCache&) = delete;
+
+ private:
+  template <typename T>
+  using Allocator = TaggedAllocator<T, MemoryTag::Names>;
+  static constexpr size_t kNumShards = 16;
+  static constexpr size_t kFirstSegmentBits = 10;
+  // Segment i holds 2^(kFirstSegmentBits + i) entries which covers all ids
+  static constexpr size_t kNumSegments =
+      std::numeric_limits<NameId>::digits - kFirstSegmentBits + 1;
+
+  // Rehashing reuses the stored hash instead of reading the characters
+  struct HashedView {
+    std::string_view view;
+    ui64 hash = 0;
+
+    [[nodiscard]] friend bool operator==(const HashedView& a,
+                                         const HashedView& b) noexcept {
+      return a.hash == b.hash && a.view == b.view;
+    }
+  };
+
+  struct HashedViewHasher {
+    [[nodiscard]] size_t operator()(const HashedView& key) const noexcept {
+      return static_cast<size_t>(key.hash);
+    }
+  };
+
+  struct Shard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<HashedView, NameId, HashedViewHasher,
+                       std::equal_to<HashedView>,
+                       Allocator<std::pair<const HashedView, NameId>>>
+        view_to_id;
+    // Views above and entries below point into it. Grows by chunks of at
+    // least LinearArena::kMinBlockBytes.
+    LinearArena chars{0, MemoryTag::Names};
+  };
+
+  // Data is published after size and hash
+  struct Entry {
+    std::atomic<const char*> data = nullptr;
+    size_t size = 0;
+    ui64 hash = 0;
+  };
+
+  struct EntryLocation {
+    size_t segment = 0;
+    size_t offset = 0;
+  };
+
+  [[nodiscard]] static EntryLocation LocateEntry(NameId id) noexcept;
+  [[nodiscard]] static constexpr size_t GetSegmentSize(
+      size_t segment) noexcept {
+    return size_t{1} << (kFirstSegmentBits + segment);
+  }
+
+  [[nodiscard]] const Entry* FindEntry(NameId id) const noexcept;
+  [[nodiscard]] Entry& GetOrAddEntry(NameId id);
+  void Publish(NameId id, const HashedView& key);
 
  private:
-  NameId next_id_ = 0;
-  std::unordered_map<std::string_view, NameId> view_to_id_;
-  std::unordered_map<NameId, std::string> id_to_str_;
+  std::array<Shard, kNumShards> shards_;
+  std::array<std::atomic<Entry*>, kNumSegments> segments_{};
+  std::atomic<NameId> next_id_ = 0;
 };
 }  // namespace name_cache_impl
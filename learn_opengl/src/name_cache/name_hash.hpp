@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string_view>
+
+#include "integer.hpp"
+
+// 64-bit FNV-1a. Usable at compile time, so name literals can carry the same
+// hash the cache computes at runtime.
+[[nodiscard]] constexpr ui64 HashName(std::string_view view) noexcept {
+  ui64 hash = 0xcbf29ce484222325;
+  for (const char c : view) {
+    hash ^= static_cast<ui8>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
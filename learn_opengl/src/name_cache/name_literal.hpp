@@ -0,0 +1,32 @@
+#pragma once
+
+#include <algorithm>
+#include <string_view>
+
+#include "integer.hpp"
+#include "name_cache/name.hpp"
+#include "name_cache/name_hash.hpp"
+
+// Characters and hash of a string literal, computed by the compiler
+template <size_t N>
+struct NameLiteral {
+  consteval NameLiteral(const char (&str)[N]) {
+    std::copy_n(str, N, chars);
+    hash = HashName(GetView());
+  }
+
+  [[nodiscard]] constexpr std::string_view GetView() const noexcept {
+    return std::string_view(chars, N - 1);
+  }
+
+  char chars[N]{};
+  ui64 hash = 0;
+};
+
+// "model"_name interns the literal on first use without hashing it. Later
+// uses return the cached Name.
+template <NameLiteral kLiteral>
+[[nodiscard]] Name operator""_name() {
+  static const Name name(kLiteral.GetView(), kLiteral.hash);
+  return name;
+}
@@ -2,7 +2,296 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "memory/memory_tracker.hpp"
+
+namespace {
+// Marks a binding which state is not known to the cache
+constexpr GLuint kUnknownBinding = std::numeric_limits<GLuint>::max();
+constexpr size_t kMaxTextureUnits = 32;
+constexpr std::array kCachedBufferTargets{
+    GLenum{GL_ARRAY_BUFFER},      GLenum{GL_ELEMENT_ARRAY_BUFFER},
+    GLenum{GL_UNIFORM_BUFFER},    GLenum{GL_PIXEL_UNPACK_BUFFER},
+    GLenum{GL_COPY_READ_BUFFER},  GLenum{GL_COPY_WRITE_BUFFER},
+    GLenum{GL_DRAW_INDIRECT_BUFFER}};
+
+// Shadow copy of the bindings made through OpenGl wrapper. Assumes a single
+// GL context which is the case for this application.
+struct GlStateCache {
+  GlStateCache() { Invalidate(); }
+
+  void Invalidate() noexcept {
+    vertex_array = kUnknownBinding;
+    program = kUnknownBinding;
+    active_texture_unit = kUnknownBinding;
+    buffers.fill(kUnknownBinding);
+    textures_2d.fill(kUnknownBinding);
+  }
+
+  [[nodiscard]] static std::optional<size_t> FindBufferSlot(
+      GLenum target) noexcept {
+    auto it = std::find(kCachedBufferTargets.begin(),
+                        kCachedBufferTargets.end(), target);
+    [[likely]] if (it != kCachedBufferTargets.end()) {
+      return static_cast<size_t>(std::distance(kCachedBufferTargets.begin(),
+                                               it));
+    }
+    return std::nullopt;
+  }
+
+  // Returns true if call must be forwarded to the driver
+  [[nodiscard]] bool Update(GlApiCall call, GLuint& cached,
+                            GLuint value) noexcept {
+    GlCallCounter& counter = frame_counters[static_cast<size_t>(call)];
+    [[likely]] if (enabled && cached == value) {
+      ++counter.skipped;
+      return false;
+    }
+
+    cached = value;
+    ++counter.issued;
+    return true;
+  }
+
+  GLuint vertex_array;
+  GLuint program;
+  GLuint active_texture_unit;
+  std::array<GLuint, kCachedBufferTargets.size()> buffers;
+  std::array<GLuint, kMaxTextureUnits> textures_2d;
+  GlCallCounters frame_counters{};
+  GlCallCounters last_frame_counters{};
+  bool enabled = true;
+};
+
+GlStateCache& GetStateCache() noexcept {
+  static GlStateCache cache;
+  return cache;
+}
+
+// Storage of a buffer or of one image of a texture
+struct GpuAllocation {
+  MemoryTag tag = MemoryTag::Untagged;
+  ui64 bytes = 0;
+};
+
+struct TextureImage {
+  // Cube map face * kMaxTextureLevels + mip level
+  ui32 key = 0;
+  ui32 width = 0;
+  ui32 height = 0;
+  ui32 texel_size = 0;
+  GpuAllocation allocation;
+};
+
+// Sizes of GL objects created through the wrapper, reported to
+// MemoryTracker. Objects get the tag of MemoryTagScope active when their
+// storage is specified.
+struct GpuMemory {
+  static constexpr ui32 kMaxTextureLevels = 32;
+
+  std::unordered_map<GLuint, GpuAllocation> buffers;
+  std::unordered_map<GLuint, std::vector<TextureImage>> textures;
+};
+
+GpuMemory& GetGpuMemory() noexcept {
+  static GpuMemory gpu_memory;
+  return gpu_memory;
+}
+
+void Reallocate(GpuAllocation& allocation, ui64 bytes) noexcept {
+  MemoryTracker& tracker = MemoryTracker::Get();
+  [[likely]] if (allocation.bytes != 0) {
+    tracker.OnFree(allocation.tag, MemoryDomain::Gpu, allocation.bytes);
+  }
+
+  allocation.tag = MemoryTracker::GetCurrentTag();
+  allocation.bytes = bytes;
+  [[likely]] if (bytes != 0) {
+    tracker.OnAllocate(allocation.tag, MemoryDomain::Gpu, bytes);
+  }
+}
+
+void Free(GpuAllocation& allocation) noexcept {
+  [[likely]] if (allocation.bytes != 0) {
+    MemoryTracker::Get().OnFree(allocation.tag, MemoryDomain::Gpu,
+                                allocation.bytes);
+    allocation.bytes = 0;
+  }
+}
+
+[[nodiscard]] constexpr GLenum GetBindingQuery(GLenum target) noexcept {
+  switch (target) {
+    case GL_ARRAY_BUFFER:
+      return GL_ARRAY_BUFFER_BINDING;
+    case GL_ELEMENT_ARRAY_BUFFER:
+      return GL_ELEMENT_ARRAY_BUFFER_BINDING;
+    case GL_UNIFORM_BUFFER:
+      return GL_UNIFORM_BUFFER_BINDING;
+    case GL_PIXEL_PACK_BUFFER:
+      return GL_PIXEL_PACK_BUFFER_BINDING;
+    case GL_PIXEL_UNPACK_BUFFER:
+      return GL_PIXEL_UNPACK_BUFFER_BINDING;
+    case GL_COPY_READ_BUFFER:
+      return GL_COPY_READ_BUFFER_BINDING;
+    case GL_COPY_WRITE_BUFFER:
+      return GL_COPY_WRITE_BUFFER_BINDING;
+    case GL_DRAW_INDIRECT_BUFFER:
+      return GL_DRAW_INDIRECT_BUFFER_BINDING;
+    case GL_SHADER_STORAGE_BUFFER:
+      return GL_SHADER_STORAGE_BUFFER_BINDING;
+    case GL_TEXTURE_2D:
+      return GL_TEXTURE_BINDING_2D;
+    case GL_TEXTURE_CUBE_MAP:
+      return GL_TEXTURE_BINDING_CUBE_MAP;
+    default:
+      return GL_NONE;
+  }
+}
+
+// Asks the driver only when the cache doesn't know the binding
+[[nodiscard]] GLuint GetBoundObject(GLenum target,
+                                    GLuint cached) noexcept {
+  [[likely]] if (cached != kUnknownBinding) { return cached; }
+
+  const GLenum query = GetBindingQuery(target);
+  [[unlikely]] if (query == GL_NONE) { return 0; }
+  GLint object = 0;
+  glGetIntegerv(query, &object);
+  return static_cast<GLuint>(object);
+}
+
+[[nodiscard]] GLuint GetBoundBuffer(GLenum target) noexcept {
+  const GlStateCache& cache = GetStateCache();
+  const std::optional<size_t> slot = GlStateCache::FindBufferSlot(target);
+  return GetBoundObject(target, slot && cache.enabled ? cache.buffers[*slot]
+                                                      : kUnknownBinding);
+}
+
+void TrackBufferStorage(GLenum target, GLsizeiptr size) noexcept {
+  const GLuint buffer = GetBoundBuffer(target);
+  [[unlikely]] if (buffer == 0) { return; }
+  Reallocate(GetGpuMemory().buffers[buffer], static_cast<ui64>(size));
+}
+
+[[nodiscard]] constexpr bool IsCubeMapFace(GLenum target) noexcept {
+  return target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X &&
+         target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z;
+}
+
+[[nodiscard]] GLuint GetBoundTexture(GLenum target) noexcept {
+  const GlStateCache& cache = GetStateCache();
+  GLuint cached = kUnknownBinding;
+  const size_t unit_index = cache.active_texture_unit - GL_TEXTURE0;
+  [[likely]] if (target == GL_TEXTURE_2D && cache.enabled &&
+                 cache.active_texture_unit != kUnknownBinding &&
+                 unit_index < kMaxTextureUnits) {
+    cached = cache.textures_2d[unit_index];
+  }
+  return GetBoundObject(IsCubeMapFace(target) ? GL_TEXTURE_CUBE_MAP : target,
+                        cached);
+}
+
+// Bytes per texel of uncompressed formats
+[[nodiscard]] constexpr ui32 GetTexelSize(GLint internal_format) noexcept {
+  switch (internal_format) {
+    case GL_RED:
+    case GL_R8:
+      return 1;
+    case GL_RG:
+    case GL_RG8:
+    case GL_R16F:
+      return 2;
+    case GL_RG32F:
+    case GL_RGB16F:
+    case GL_RGBA16F:
+      return 8;
+    case GL_RGB32F:
+    case GL_RGBA32F:
+      return 16;
+    // Three 8 bit channels are padded to four by drivers
+    default:
+      return 4;
+  }
+}
+
+// Texel size is zero for compressed images
+void SetTextureImage(GLuint texture, ui32 key, ui32 width, ui32 height,
+                     ui32 texel_size, ui64 bytes) noexcept {
+  std::vector<TextureImage>& images = GetGpuMemory().textures[texture];
+  auto it = std::ranges::find(images, key, &TextureImage::key);
+  [[likely]] if (it == images.end()) {
+    it = images.emplace(images.end());
+    it->key = key;
+  }
+
+  it->width = width;
+  it->height = height;
+  it->texel_size = texel_size;
+  Reallocate(it->allocation, bytes);
+}
+
+void TrackImage(GLenum target, size_t level, size_t width, size_t height,
+                ui32 texel_size, ui64 bytes) noexcept {
+  const GLuint texture = GetBoundTexture(target);
+  [[unlikely]] if (texture == 0 || level >= GpuMemory::kMaxTextureLevels) {
+    return;
+  }
+
+  const ui32 face =
+      IsCubeMapFace(target) ? target - GL_TEXTURE_CUBE_MAP_POSITIVE_X : 0;
+  const ui32 key =
+      face * GpuMemory::kMaxTextureLevels + static_cast<ui32>(level);
+  SetTextureImage(texture, key, static_cast<ui32>(width),
+                  static_cast<ui32>(height), texel_size, bytes);
+}
+
+void TrackTextureImage(GLenum target, size_t level, GLint internal_format,
+                       size_t width, size_t height) noexcept {
+  const ui32 texel_size = GetTexelSize(internal_format);
+  TrackImage(target, level, width, height, texel_size,
+             ui64{width} * height * texel_size);
+}
+
+void TrackCompressedTextureImage(GLenum target, size_t level, size_t width,
+                                 size_t height, size_t image_size) noexcept {
+  TrackImage(target, level, width, height, 0, image_size);
+}
+
+// Mip levels below the base level of every face
+void TrackMipmaps(GLenum target) noexcept {
+  const GLuint texture = GetBoundTexture(target);
+  auto it = GetGpuMemory().textures.find(texture);
+  [[unlikely]] if (it == GetGpuMemory().textures.end()) { return; }
+
+  // Copied because SetTextureImage may add images
+  std::vector<TextureImage> base_images;
+  for (const TextureImage& image : it->second) {
+    // Compressed images can't have generated mip levels
+    if (image.key % GpuMemory::kMaxTextureLevels == 0 &&
+        image.texel_size != 0) {
+      base_images.push_back(image);
+    }
+  }
+
+  for (const TextureImage& base : base_images) {
+    ui32 width = base.width;
+    ui32 height = base.height;
+    for (ui32 level = 1;
+         (width > 1 || height > 1) && level != GpuMemory::kMaxTextureLevels;
+         ++level) {
+      width = std::max(width / 2, 1u);
+      height = std::max(height / 2, 1u);
+      SetTextureImage(texture, base.key + level, width, height,
+                      base.texel_size, ui64{width} * height * base.texel_size);
+    }
+  }
+}
+}  // namespace
 
 template <typename T>
 void GenObjects(T api_fn, const std::span<GLuint>& objects) {
@@ -37,16 +326,260 @@ void OpenGl::GenTextures(const std::span<GLuint>& textures) noexcept {
 }
 
 void OpenGl::BindVertexArray(GLuint array) noexcept {
-  glBindVertexArray(array);
+  GlStateCache& cache = GetStateCache();
+  [[unlikely]] if (cache.Update(GlApiCall::BindVertexArray, cache.vertex_array,
+                                array)) {
+    // Element array buffer binding is a part of vertex array state
+    const size_t element_slot = *GlStateCache::FindBufferSlot(
+        GL_ELEMENT_ARRAY_BUFFER);
+    cache.buffers[element_slot] = kUnknownBinding;
+    glBindVertexArray(array);
+  }
+}
+
+void OpenGl::DeleteVertexArray(GLuint array) noexcept {
+  GlStateCache& cache = GetStateCache();
+  if (cache.vertex_array == array) {
+    cache.vertex_array = kUnknownBinding;
+  }
+  glDeleteVertexArrays(1, &array);
 }
 
 void OpenGl::BindBuffer(GLenum target, GLuint buffer) noexcept {
-  glBindBuffer(target, buffer);
+  GlStateCache& cache = GetStateCache();
+  const std::optional<size_t> slot = GlStateCache::FindBufferSlot(target);
+  [[unlikely]] if (!slot) {
+    ++cache.frame_counters[static_cast<size_t>(GlApiCall::BindBuffer)].issued;
+    glBindBuffer(target, buffer);
+    return;
+  }
+
+  if (cache.Update(GlApiCall::BindBuffer, cache.buffers[*slot], buffer)) {
+    glBindBuffer(target, buffer);
+  }
+}
+
+void OpenGl::DeleteBuffer(GLuint buffer) noexcept {
+  // Deleted buffer gets unbound from all targets
+  for (GLuint& bound_buffer : GetStateCache().buffers) {
+    if (bound_buffer == buffer) {
+      bound_buffer = kUnknownBinding;
+    }
+  }
+  glDeleteBuffers(1, &buffer);
+
+  GpuMemory& gpu_memory = GetGpuMemory();
+  [[likely]] if (auto it = gpu_memory.buffers.find(buffer);
+                 it != gpu_memory.buffers.end()) {
+    Free(it->second);
+    gpu_memory.buffers.erase(it);
+  }
 }
 
 void OpenGl::BufferData(GLenum target, GLsizeiptr size, const void* data,
                         GLenum usage) noexcept {
   glBufferData(target, size, data, usage);
+  TrackBufferStorage(target, size);
+}
+
+void OpenGl::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size,
+                           const void* data) noexcept {
+  glBufferSubData(target, offset, size, data);
+}
+
+void OpenGl::CopyBufferSubData(GLenum read_target, GLenum write_target,
+                               GLintptr read_offset, GLintptr write_offset,
+                               GLsizeiptr size) noexcept {
+  glCopyBufferSubData(read_target, write_target, read_offset, write_offset,
+                      size);
+}
+
+void OpenGl::GetBufferSubData(GLenum target, GLintptr offset,
+                              GLsizeiptr size, void* data) noexcept {
+  glGetBufferSubData(target, offset, size, data);
+}
+
+void OpenGl::BufferStorage(GLenum target, GLsizeiptr size, const void* data,
+                           GLbitfield flags) noexcept {
+  glBufferStorage(target, size, data, flags);
+  TrackBufferStorage(target, size);
+}
+
+void* OpenGl::MapBufferRange(GLenum target, GLintptr offset,
+                             GLsizeiptr length, GLbitfield access) noexcept {
+  return glMapBufferRange(target, offset, length, access);
+}
+
+void OpenGl::FlushMappedBufferRange(GLenum target, GLintptr offset,
+                                    GLsizeiptr length) noexcept {
+  glFlushMappedBufferRange(target, offset, length);
+}
+
+bool OpenGl::UnmapBuffer(GLenum target) noexcept {
+  return glUnmapBuffer(target) == GL_TRUE;
+}
+
+void OpenGl::BindBufferRange(GLenum target, GLuint index, GLuint buffer,
+                             GLintptr offset, GLsizeiptr size) noexcept {
+  glBindBufferRange(target, index, buffer, offset, size);
+  // Indexed bind also changes the generic binding point
+  if (auto slot = GlStateCache::FindBufferSlot(target); slot) {
+    GetStateCache().buffers[*slot] = buffer;
+  }
+}
+
+GLsync OpenGl::FenceSync() noexcept {
+  return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool OpenGl::ClientWaitSync(GLsync sync, ui64 timeout_ns) noexcept {
+  const GLenum result =
+      glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns);
+  return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void OpenGl::DeleteSync(GLsync sync) noexcept { glDeleteSync(sync); }
+
+GLint OpenGl::GetInteger(GLenum pname) noexcept {
+  GLint value = 0;
+  glGetIntegerv(pname, &value);
+  return value;
+}
+
+GLuint OpenGl::GenFramebuffer() noexcept {
+  GLuint framebuffer = 0;
+  glGenFramebuffers(1, &framebuffer);
+  return framebuffer;
+}
+
+void OpenGl::DeleteFramebuffer(GLuint framebuffer) noexcept {
+  glDeleteFramebuffers(1, &framebuffer);
+}
+
+void OpenGl::BindFramebuffer(GLenum target, GLuint framebuffer) noexcept {
+  glBindFramebuffer(target, framebuffer);
+}
+
+void OpenGl::FramebufferTexture2d(GLenum target, GLenum attachment,
+                                  GLuint texture) noexcept {
+  glFramebufferTexture2D(target, attachment, GL_TEXTURE_2D, texture, 0);
+}
+
+void OpenGl::DrawBuffers(std::span<const GLenum> buffers) noexcept {
+  glDrawBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
+}
+
+GLenum OpenGl::CheckFramebufferStatus(GLenum target) noexcept {
+  return glCheckFramebufferStatus(target);
+}
+
+void OpenGl::ClearBuffer(GLenum buffer, GLint draw_buffer,
+                         const Eigen::Vector4f& value) noexcept {
+  glClearBufferfv(buffer, draw_buffer, value.data());
+}
+
+void OpenGl::BlitFramebuffer(GLint width, GLint height, GLbitfield mask,
+                             GLenum filter) noexcept {
+  glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, mask, filter);
+}
+
+std::optional<GLuint> OpenGl::FindUniformBlockIndex(GLuint shader_program,
+                                                    const char* name) noexcept {
+  const GLuint index = glGetUniformBlockIndex(shader_program, name);
+  [[likely]] if (index != GL_INVALID_INDEX) { return index; }
+  return std::optional<GLuint>();
+}
+
+void OpenGl::UniformBlockBinding(GLuint shader_program, GLuint block_index,
+                                 GLuint binding) noexcept {
+  glUniformBlockBinding(shader_program, block_index, binding);
+}
+
+GLuint OpenGl::GenQuery() noexcept {
+  GLuint query = 0;
+  glGenQueries(1, &query);
+  return query;
+}
+
+void OpenGl::DeleteQuery(GLuint query) noexcept { glDeleteQueries(1, &query); }
+
+void OpenGl::BeginQuery(GLenum target, GLuint query) noexcept {
+  glBeginQuery(target, query);
+}
+
+void OpenGl::EndQuery(GLenum target) noexcept { glEndQuery(target); }
+
+ui64 OpenGl::GetQueryObject(GLuint query, GLenum pname) noexcept {
+  GLuint64 value = 0;
+  glGetQueryObjectui64v(query, pname, &value);
+  return value;
+}
+
+bool OpenGl::SupportsBufferStorage() noexcept {
+  return GLAD_GL_VERSION_4_4 != 0;
+}
+
+bool OpenGl::SupportsCompressedFormat(GLenum format) noexcept {
+  [[likely]] if (GLAD_GL_VERSION_4_3) {
+    GLint supported = GL_FALSE;
+    glGetInternalformativ(GL_TEXTURE_2D, format, GL_INTERNALFORMAT_SUPPORTED,
+                          1, &supported);
+    return supported == GL_TRUE;
+  }
+
+  bool supported = false;
+  switch (format) {
+    case GL_COMPRESSED_RED_RGTC1:
+    case GL_COMPRESSED_RG_RGTC2:
+      // Core since 3.0
+      return true;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+      supported = GLAD_GL_VERSION_4_2 ||
+                  HasExtension("GL_ARB_texture_compression_bptc");
+      break;
+    case GL_COMPRESSED_RGB8_ETC2:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:
+      supported = HasExtension("GL_ARB_ES3_compatibility");
+      break;
+    case kGlCompressedRgbaS3tcDxt1:
+    case kGlCompressedRgbaS3tcDxt5:
+      supported = HasExtension("GL_EXT_texture_compression_s3tc");
+      break;
+    default:
+      break;
+  }
+  [[likely]] if (supported) { return true; }
+
+  static const std::vector<GLint> formats = [] {
+    std::vector<GLint> result(
+        static_cast<size_t>(GetInteger(GL_NUM_COMPRESSED_TEXTURE_FORMATS)));
+    [[likely]] if (!result.empty()) {
+      glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, result.data());
+    }
+    return result;
+  }();
+  return std::ranges::find(formats, static_cast<GLint>(format)) !=
+         formats.end();
+}
+
+bool OpenGl::HasExtension(std::string_view name) noexcept {
+  // Strings stay valid while the context lives
+  static const std::vector<std::string_view> extensions = [] {
+    const auto num_extensions =
+        static_cast<GLuint>(GetInteger(GL_NUM_EXTENSIONS));
+    std::vector<std::string_view> result;
+    result.reserve(num_extensions);
+    for (GLuint i = 0; i != num_extensions; ++i) {
+      result.emplace_back(
+          reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)));
+    }
+    return result;
+  }();
+  return std::ranges::find(extensions, name) != extensions.end();
+}
+
+bool OpenGl::SupportsMultiDrawIndirect() noexcept {
+  return GLAD_GL_VERSION_4_3 != 0;
 }
 
 constexpr GLboolean OpenGl::CastBool(bool value) noexcept {
@@ -65,6 +598,10 @@ void OpenGl::EnableVertexAttribArray(GLuint index) noexcept {
   glEnableVertexAttribArray(index);
 }
 
+void OpenGl::VertexAttribDivisor(GLuint index, GLuint divisor) noexcept {
+  glVertexAttribDivisor(index, divisor);
+}
+
 void OpenGl::Viewport(GLint x, GLint y, GLsizei width,
                       GLsizei height) noexcept {
   glViewport(x, y, width, height);
@@ -80,13 +617,63 @@ void OpenGl::SetClearColor(const Eigen::Vector4f& color) noexcept {
 
 void OpenGl::Clear(GLbitfield mask) noexcept { glClear(mask); }
 
-void OpenGl::UseProgram(GLuint program) noexcept { glUseProgram(program); }
+void OpenGl::UseProgram(GLuint program) noexcept {
+  GlStateCache& cache = GetStateCache();
+  if (cache.Update(GlApiCall::UseProgram, cache.program, program)) {
+    glUseProgram(program);
+  }
+}
+
+void OpenGl::DeleteProgram(GLuint program) noexcept {
+  GlStateCache& cache = GetStateCache();
+  if (cache.program == program) {
+    cache.program = kUnknownBinding;
+  }
+  glDeleteProgram(program);
+}
 
 void OpenGl::DrawElements(GLenum mode, size_t num, GLenum indices_type,
                           const void* indices) noexcept {
   glDrawElements(mode, static_cast<GLsizei>(num), indices_type, indices);
 }
 
+void OpenGl::DrawElementsInstancedBaseVertex(GLenum mode, size_t num,
+                                             GLenum indices_type,
+                                             const void* indices,
+                                             size_t num_instances,
+                                             GLint base_vertex) noexcept {
+  glDrawElementsInstancedBaseVertex(mode, static_cast<GLsizei>(num),
+                                    indices_type, indices,
+                                    static_cast<GLsizei>(num_instances),
+                                    base_vertex);
+}
+
+void OpenGl::DrawArraysInstanced(GLenum mode, size_t first, size_t num,
+                                 size_t num_instances) noexcept {
+  glDrawArraysInstanced(mode, static_cast<GLint>(first),
+                        static_cast<GLsizei>(num),
+                        static_cast<GLsizei>(num_instances));
+}
+
+void OpenGl::MultiDrawElementsBaseVertex(GLenum mode, const GLsizei* counts,
+                                         GLenum indices_type,
+                                         const void* const* indices,
+                                         size_t num_draws,
+                                         const GLint* base_vertices) noexcept {
+  glMultiDrawElementsBaseVertex(mode, counts, indices_type, indices,
+                                static_cast<GLsizei>(num_draws),
+                                base_vertices);
+}
+
+void OpenGl::MultiDrawElementsIndirect(GLenum mode, GLenum indices_type,
+                                       size_t offset, size_t num_draws,
+                                       size_t stride) noexcept {
+  glMultiDrawElementsIndirect(mode, indices_type,
+                              reinterpret_cast<const void*>(offset),
+                              static_cast<GLsizei>(num_draws),
+                              static_cast<GLsizei>(stride));
+}
+
 std::optional<ui32> OpenGl::FindUniformLocation(GLuint shader_program,
                                                 const char* name) noexcept {
   int result = glGetUniformLocation(shader_program, name);
@@ -159,14 +746,54 @@ void OpenGl::SetTexture2dMagFilter(GlTextureFilter filter) noexcept {
   SetTextureParameter2d(GL_TEXTURE_MAG_FILTER, ConvertEnum(filter));
 }
 
+void OpenGl::ActiveTexture(GLenum texture_unit) noexcept {
+  GlStateCache& cache = GetStateCache();
+  if (cache.Update(GlApiCall::ActiveTexture, cache.active_texture_unit,
+                   texture_unit)) {
+    glActiveTexture(texture_unit);
+  }
+}
+
 void OpenGl::BindTexture(GLenum target, GLuint texture) noexcept {
-  glBindTexture(target, texture);
+  GlStateCache& cache = GetStateCache();
+  const size_t unit_index = cache.active_texture_unit - GL_TEXTURE0;
+  [[unlikely]] if (target != GL_TEXTURE_2D ||
+                   cache.active_texture_unit == kUnknownBinding ||
+                   unit_index >= kMaxTextureUnits) {
+    ++cache.frame_counters[static_cast<size_t>(GlApiCall::BindTexture)].issued;
+    glBindTexture(target, texture);
+    return;
+  }
+
+  if (cache.Update(GlApiCall::BindTexture, cache.textures_2d[unit_index],
+                   texture)) {
+    glBindTexture(target, texture);
+  }
 }
 
 void OpenGl::BindTexture2d(GLuint texture) {
   BindTexture(GL_TEXTURE_2D, texture);
 }
 
+void OpenGl::DeleteTexture(GLuint texture) noexcept {
+  // Deleted texture gets unbound from all texture units
+  for (GLuint& bound_texture : GetStateCache().textures_2d) {
+    if (bound_texture == texture) {
+      bound_texture = kUnknownBinding;
+    }
+  }
+  glDeleteTextures(1, &texture);
+
+  GpuMemory& gpu_memory = GetGpuMemory();
+  [[likely]] if (auto it = gpu_memory.textures.find(texture);
+                 it != gpu_memory.textures.end()) {
+    for (TextureImage& image : it->second) {
+      Free(image.allocation);
+    }
+    gpu_memory.textures.erase(it);
+  }
+}
+
 void OpenGl::TexImage2d(GLenum target, size_t level_of_detail,
                         GLint internal_format, size_t width, size_t height,
                         GLenum data_format, GLenum pixel_data_type,
@@ -174,10 +801,24 @@ void OpenGl::TexImage2d(GLenum target, size_t level_of_detail,
   glTexImage2D(target, static_cast<GLint>(level_of_detail), internal_format,
                static_cast<GLsizei>(width), static_cast<GLsizei>(height), 0,
                data_format, pixel_data_type, pixels);
+  TrackTextureImage(target, level_of_detail, internal_format, width, height);
+}
+
+void OpenGl::CompressedTexImage2d(GLenum target, size_t level_of_detail,
+                                  GLenum internal_format, size_t width,
+                                  size_t height, size_t image_size,
+                                  const void* data) noexcept {
+  glCompressedTexImage2D(target, static_cast<GLint>(level_of_detail),
+                         internal_format, static_cast<GLsizei>(width),
+                         static_cast<GLsizei>(height), 0,
+                         static_cast<GLsizei>(image_size), data);
+  TrackCompressedTextureImage(target, level_of_detail, width, height,
+                              image_size);
 }
 
 void OpenGl::GenerateMipmap(GLenum target) noexcept {
   glGenerateMipmap(target);
+  TrackMipmaps(target);
 }
 
 void OpenGl::GenerateMipmap2d() noexcept { GenerateMipmap(GL_TEXTURE_2D); }
@@ -188,4 +829,26 @@ void OpenGl::PolygonMode(GlPolygonMode mode) noexcept {
 }
 
 void OpenGl::PointSize(float size) noexcept { glPointSize(size); }
-void OpenGl::LineWidth(float width) noexcept { glLineWidth(width); }
\ No newline at end of file
+void OpenGl::LineWidth(float width) noexcept { glLineWidth(width); }
+
+void OpenGl::InvalidateStateCache() noexcept { GetStateCache().Invalidate(); }
+
+void OpenGl::SetStateCacheEnabled(bool enabled) noexcept {
+  GlStateCache& cache = GetStateCache();
+  cache.enabled = enabled;
+  cache.Invalidate();
+}
+
+bool OpenGl::IsStateCacheEnabled() noexcept {
+  return GetStateCache().enabled;
+}
+
+const GlCallCounters& OpenGl::GetCallCounters() noexcept {
+  return GetStateCache().last_frame_counters;
+}
+
+void OpenGl::FlushCallCounters() noexcept {
+  GlStateCache& cache = GetStateCache();
+  cache.last_frame_counters = cache.frame_counters;
+  cache.frame_counters = GlCallCounters{};
+}
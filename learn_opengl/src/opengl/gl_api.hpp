@@ -21,6 +21,10 @@
 #include "template/get_enum_underlying.hpp"
 #include "wrap/wrap_eigen.hpp"
 
+// GL_EXT_texture_compression_s3tc enums are not in the loader
+inline constexpr GLenum kGlCompressedRgbaS3tcDxt1 = 0x83F1;
+inline constexpr GLenum kGlCompressedRgbaS3tcDxt5 = 0x83F3;
+
 enum class GlPolygonMode : ui8 { Point, Line, Fill, Max };
 enum class GlTextureWrap : ui8 { S, T, R, Max };
 enum class GlTextureWrapMode : ui8 {
@@ -42,12 +46,31 @@ enum class GlTextureFilter : ui8 {
   Max
 };
 
+// Entry points that go through the state cache
+enum class GlApiCall : ui8 {
+  BindVertexArray,
+  UseProgram,
+  BindBuffer,
+  ActiveTexture,
+  BindTexture,
+  Max
+};
+
+struct GlCallCounter {
+  ui32 issued = 0;
+  ui32 skipped = 0;
+};
+
+using GlCallCounters =
+    std::array<GlCallCounter, static_cast<size_t>(GlApiCall::Max)>;
+
 class OpenGl {
  public:
   [[nodiscard]] static GLuint GenVertexArray() noexcept;
   static void GenVertexArrays(const std::span<GLuint>& arrays) noexcept;
 
   static void BindVertexArray(GLuint array) noexcept;
+  static void DeleteVertexArray(GLuint array) noexcept;
 
   [[nodiscard]] static GLuint GenBuffer() noexcept;
   static void GenBuffers(const std::span<GLuint>& buffers) noexcept;
@@ -56,6 +79,7 @@ class OpenGl {
   static void GenTextures(const std::span<GLuint>& textures) noexcept;
 
   static void BindBuffer(GLenum target, GLuint buffer) noexcept;
+  static void DeleteBuffer(GLuint buffer) noexcept;
 
   static void BufferData(GLenum target, GLsizeiptr size, const void* data,
                          GLenum usage) noexcept;
@@ -74,6 +98,92 @@ class OpenGl {
                data.data(), usage);
   }
 
+  static void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size,
+                            const void* data) noexcept;
+
+  template <typename T, size_t Extent>
+  static void BufferSubData(GLenum target, size_t first,
+                            const std::span<const T, Extent>& data) noexcept {
+    BufferSubData(target, static_cast<GLintptr>(sizeof(T) * first),
+                  static_cast<GLsizeiptr>(sizeof(T) * data.size()),
+                  data.data());
+  }
+
+  static void CopyBufferSubData(GLenum read_target, GLenum write_target,
+                                GLintptr read_offset, GLintptr write_offset,
+                                GLsizeiptr size) noexcept;
+
+  static void GetBufferSubData(GLenum target, GLintptr offset,
+                               GLsizeiptr size, void* data) noexcept;
+
+  template <typename T>
+  static void GetBufferSubData(GLenum target, size_t first,
+                               const std::span<T>& data) noexcept {
+    GetBufferSubData(target, static_cast<GLintptr>(sizeof(T) * first),
+                     static_cast<GLsizeiptr>(sizeof(T) * data.size()),
+                     data.data());
+  }
+
+  static void BufferStorage(GLenum target, GLsizeiptr size, const void* data,
+                            GLbitfield flags) noexcept;
+
+  [[nodiscard]] static void* MapBufferRange(GLenum target, GLintptr offset,
+                                            GLsizeiptr length,
+                                            GLbitfield access) noexcept;
+
+  static void FlushMappedBufferRange(GLenum target, GLintptr offset,
+                                     GLsizeiptr length) noexcept;
+
+  static bool UnmapBuffer(GLenum target) noexcept;
+
+  static void BindBufferRange(GLenum target, GLuint index, GLuint buffer,
+                              GLintptr offset, GLsizeiptr size) noexcept;
+
+  [[nodiscard]] static GLsync FenceSync() noexcept;
+  // Returns true if fence was signaled before timeout
+  static bool ClientWaitSync(GLsync sync, ui64 timeout_ns) noexcept;
+  static void DeleteSync(GLsync sync) noexcept;
+
+  [[nodiscard]] static GLint GetInteger(GLenum pname) noexcept;
+
+  [[nodiscard]] static GLuint GenFramebuffer() noexcept;
+  static void DeleteFramebuffer(GLuint framebuffer) noexcept;
+  static void BindFramebuffer(GLenum target, GLuint framebuffer) noexcept;
+  static void FramebufferTexture2d(GLenum target, GLenum attachment,
+                                   GLuint texture) noexcept;
+  static void DrawBuffers(std::span<const GLenum> buffers) noexcept;
+  [[nodiscard]] static GLenum CheckFramebufferStatus(GLenum target) noexcept;
+  static void ClearBuffer(GLenum buffer, GLint draw_buffer,
+                          const Eigen::Vector4f& value) noexcept;
+  static void BlitFramebuffer(GLint width, GLint height, GLbitfield mask,
+                              GLenum filter) noexcept;
+
+  [[nodiscard]] static std::optional<GLuint> FindUniformBlockIndex(
+      GLuint shader_program, const char* name) noexcept;
+  static void UniformBlockBinding(GLuint shader_program, GLuint block_index,
+                                  GLuint binding) noexcept;
+
+  [[nodiscard]] static GLuint GenQuery() noexcept;
+  static void DeleteQuery(GLuint query) noexcept;
+  static void BeginQuery(GLenum target, GLuint query) noexcept;
+  static void EndQuery(GLenum target) noexcept;
+  [[nodiscard]] static ui64 GetQueryObject(GLuint query,
+                                           GLenum pname) noexcept;
+
+  // GL_ARB_buffer_storage is a part of core since 4.4
+  [[nodiscard]] static bool SupportsBufferStorage() noexcept;
+
+  // Asks the driver about the internal format on 4.3, otherwise relies on
+  // core versions and extensions. GL_COMPRESSED_TEXTURE_FORMATS is the last
+  // resort: it may omit formats that are supported. Needs the GL context.
+  [[nodiscard]] static bool SupportsCompressedFormat(GLenum format) noexcept;
+
+  // Extension list is queried once. Needs the GL context.
+  [[nodiscard]] static bool HasExtension(std::string_view name) noexcept;
+
+  // GL_ARB_multi_draw_indirect is a part of core since 4.3
+  [[nodiscard]] static bool SupportsMultiDrawIndirect() noexcept;
+
   [[nodiscard]] static constexpr GLboolean CastBool(bool value) noexcept;
 
   static void VertexAttribPointer(GLuint index, size_t size, GLenum type,
@@ -81,6 +191,7 @@ class OpenGl {
                                   const void* pointer) noexcept;
 
   static void EnableVertexAttribArray(GLuint index) noexcept;
+  static void VertexAttribDivisor(GLuint index, GLuint divisor) noexcept;
   static void EnableDepthTest() noexcept;
 
   static void Viewport(GLint x, GLint y, GLsizei width,
@@ -93,10 +204,31 @@ class OpenGl {
   static void Clear(GLbitfield mask) noexcept;
 
   static void UseProgram(GLuint program) noexcept;
+  static void DeleteProgram(GLuint program) noexcept;
 
   static void DrawElements(GLenum mode, size_t num, GLenum indices_type,
                            const void* indices) noexcept;
 
+  static void DrawElementsInstancedBaseVertex(GLenum mode, size_t num,
+                                              GLenum indices_type,
+                                              const void* indices,
+                                              size_t num_instances,
+                                              GLint base_vertex) noexcept;
+
+  static void DrawArraysInstanced(GLenum mode, size_t first, size_t num,
+                                  size_t num_instances) noexcept;
+
+  static void MultiDrawElementsBaseVertex(GLenum mode, const GLsizei* counts,
+                                          GLenum indices_type,
+                                          const void* const* indices,
+                                          size_t num_draws,
+                                          const GLint* base_vertices) noexcept;
+
+  // Reads commands from buffer bound to GL_DRAW_INDIRECT_BUFFER
+  static void MultiDrawElementsIndirect(GLenum mode, GLenum indices_type,
+                                        size_t offset, size_t num_draws,
+                                        size_t stride = 0) noexcept;
+
   [[nodiscard]] constexpr static GLenum ConvertEnum(
       GlPolygonMode mode) noexcept;
 
@@ -143,15 +275,25 @@ class OpenGl {
 
   static void SetTexture2dMagFilter(GlTextureFilter filter) noexcept;
 
+  static void ActiveTexture(GLenum texture_unit) noexcept;
+
   static void BindTexture(GLenum target, GLuint texture) noexcept;
 
   static void BindTexture2d(GLuint texture);
 
+  static void DeleteTexture(GLuint texture) noexcept;
+
   static void TexImage2d(GLenum target, size_t level_of_detail,
                          GLint internal_format, size_t width, size_t height,
                          GLenum data_format, GLenum pixel_data_type,
                          const void* pixels) noexcept;
 
+  // Data is in the format's blocks, or an offset with an unpack buffer bound
+  static void CompressedTexImage2d(GLenum target, size_t level_of_detail,
+                                   GLenum internal_format, size_t width,
+                                   size_t height, size_t image_size,
+                                   const void* data) noexcept;
+
   static void GenerateMipmap(GLenum target) noexcept;
 
   static void GenerateMipmap2d() noexcept;
@@ -165,6 +307,18 @@ class OpenGl {
   static void PolygonMode(GlPolygonMode mode) noexcept;
   static void PointSize(float size) noexcept;
   static void LineWidth(float width) noexcept;
+
+  // The wrapper keeps a shadow copy of the bindings it has issued and skips
+  // redundant binds. Call this after third party code (ImGui backend)
+  // touched the GL state behind our back.
+  static void InvalidateStateCache() noexcept;
+  static void SetStateCacheEnabled(bool enabled) noexcept;
+  [[nodiscard]] static bool IsStateCacheEnabled() noexcept;
+
+  // Counters of the previous complete frame
+  [[nodiscard]] static const GlCallCounters& GetCallCounters() noexcept;
+  // Publishes counters of the current frame and starts a new one
+  static void FlushCallCounters() noexcept;
 };
 
 constexpr GLenum OpenGl::ConvertEnum(GlPolygonMode mode) noexcept {
@@ -300,4 +454,19 @@ struct TypeReflectionProvider<GlTextureFilter> {
         .Value(GlTextureFilter::Max, "Max");
   }
 };
+
+template <>
+struct TypeReflectionProvider<GlApiCall> {
+  [[nodiscard]] inline constexpr static auto ReflectType() {
+    return cppreflection::StaticEnumTypeInfo<GlApiCall>(
+               "GlApiCall",
+               edt::GUID::Create("5A0C3E71-2F7D-4B1B-9C86-3F0E4D0B7A52"))
+        .Value(GlApiCall::BindVertexArray, "BindVertexArray")
+        .Value(GlApiCall::UseProgram, "UseProgram")
+        .Value(GlApiCall::BindBuffer, "BindBuffer")
+        .Value(GlApiCall::ActiveTexture, "ActiveTexture")
+        .Value(GlApiCall::BindTexture, "BindTexture")
+        .Value(GlApiCall::Max, "Max");
+  }
+};
 }  // namespace cppreflection
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "opengl/gpu_mirror.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "memory/memory_tracker.hpp"
+
+namespace {
+// Not a part of vertex array state, same as for stream buffer
+constexpr GLenum kUploadTarget = GL_COPY_WRITE_BUFFER;
+}  // namespace
+
+GpuMirror::GpuMirror() = default;
+
+GpuMirror::~GpuMirror() {
+  if (buffer_) {
+    OpenGl::DeleteBuffer(buffer_);
+  }
+}
+
+void GpuMirror::Resize(size_t size) {
+  data_.resize(size);
+  dirty_end_ = std::min(dirty_end_, size);
+  dirty_begin_ = std::min(dirty_begin_, dirty_end_);
+
+  [[likely]] if (size <= stats_.capacity) { return; }
+
+  if (buffer_) {
+    OpenGl::DeleteBuffer(buffer_);
+    ++stats_.num_grows;
+  }
+
+  // Grows geometrically, contents go with the next upload
+  stats_.capacity = std::max(size, stats_.capacity * 2);
+  const MemoryTagScope tag_scope(MemoryTag::Render);
+  buffer_ = OpenGl::GenBuffer();
+  OpenGl::BindBuffer(kUploadTarget, buffer_);
+  OpenGl::BufferData(kUploadTarget,
+                     static_cast<GLsizeiptr>(stats_.capacity), nullptr,
+                     GL_DYNAMIC_DRAW);
+  MarkDirty(0, size);
+}
+
+bool GpuMirror::Write(size_t offset, std::span<const ui8> data) {
+  assert(offset + data.size() <= data_.size());
+  ui8* destination = data_.data() + offset;
+  [[likely]] if (std::memcmp(destination, data.data(), data.size()) == 0) {
+    return false;
+  }
+
+  std::memcpy(destination, data.data(), data.size());
+  MarkDirty(offset, offset + data.size());
+  return true;
+}
+
+void GpuMirror::Upload() {
+  stats_.last_upload_bytes = 0;
+  [[likely]] if (dirty_begin_ == dirty_end_) { return; }
+
+  OpenGl::BindBuffer(kUploadTarget, buffer_);
+  OpenGl::BufferSubData(kUploadTarget, static_cast<GLintptr>(dirty_begin_),
+                        static_cast<GLsizeiptr>(dirty_end_ - dirty_begin_),
+                        data_.data() + dirty_begin_);
+  stats_.last_upload_bytes = dirty_end_ - dirty_begin_;
+  ++stats_.num_uploads;
+  dirty_begin_ = 0;
+  dirty_end_ = 0;
+}
+
+void GpuMirror::MarkDirty(size_t begin, size_t end) noexcept {
+  [[likely]] if (dirty_begin_ == dirty_end_) {
+    dirty_begin_ = begin;
+    dirty_end_ = end;
+  } else {
+    dirty_begin_ = std::min(dirty_begin_, begin);
+    dirty_end_ = std::max(dirty_end_, end);
+  }
+}
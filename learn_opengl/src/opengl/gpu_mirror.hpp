@@ -0,0 +1,57 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "integer.hpp"
+#include "opengl/gl_api.hpp"
+
+struct GpuMirrorStats {
+  size_t capacity = 0;
+  size_t last_upload_bytes = 0;
+  ui32 num_uploads = 0;
+  ui32 num_grows = 0;
+};
+
+// GPU buffer with a CPU copy of its contents for data which rarely changes.
+// Writes that change bytes extend the dirty range and Upload() sends only
+// that range instead of streaming everything every frame.
+class GpuMirror {
+ public:
+  GpuMirror();
+  GpuMirror(const GpuMirror&) = delete;
+  ~GpuMirror();
+
+  // Keeps contents. Growing recreates GPU storage with all of them.
+  void Resize(size_t size);
+
+  // Returns true if bytes changed
+  bool Write(size_t offset, std::span<const ui8> data);
+
+  template <typename T>
+  bool Write(size_t offset, const T& value) {
+    return Write(offset, std::span(reinterpret_cast<const ui8*>(&value),
+                                   sizeof(T)));
+  }
+
+  // Sends the dirty range, if any
+  void Upload();
+
+  [[nodiscard]] GLuint GetBuffer() const noexcept { return buffer_; }
+  [[nodiscard]] size_t GetSize() const noexcept { return data_.size(); }
+  [[nodiscard]] const GpuMirrorStats& GetStats() const noexcept {
+    return stats_;
+  }
+
+  GpuMirror& operator=(const GpuMirror&) = delete;
+
+ private:
+  void MarkDirty(size_t begin, size_t end) noexcept;
+
+ private:
+  std::vector<ui8> data_;
+  GLuint buffer_ = 0;
+  size_t dirty_begin_ = 0;
+  size_t dirty_end_ = 0;
+  GpuMirrorStats stats_;
+};
@@ -0,0 +1,54 @@
+#include "opengl/samples_passed_query.hpp"
+
+#include <cassert>
+
+SamplesPassedQuery::SamplesPassedQuery() {
+  for (GLuint& query : queries_) {
+    query = OpenGl::GenQuery();
+  }
+}
+
+SamplesPassedQuery::~SamplesPassedQuery() {
+  for (const GLuint query : queries_) {
+    OpenGl::DeleteQuery(query);
+  }
+}
+
+void SamplesPassedQuery::Begin() {
+  assert(!active_);
+  Poll();
+
+  const size_t next_index = (index_ + 1) % kNumQueries;
+  [[unlikely]] if (pending_[next_index]) { return; }
+
+  index_ = next_index;
+  OpenGl::BeginQuery(GL_SAMPLES_PASSED, queries_[index_]);
+  active_ = true;
+}
+
+void SamplesPassedQuery::End() {
+  [[unlikely]] if (!active_) { return; }
+
+  OpenGl::EndQuery(GL_SAMPLES_PASSED);
+  pending_[index_] = true;
+  active_ = false;
+}
+
+void SamplesPassedQuery::Poll() {
+  // From the oldest to the newest so that the latest result wins
+  for (size_t i = 1; i <= kNumQueries; ++i) {
+    const size_t query_index = (index_ + i) % kNumQueries;
+    if (!pending_[query_index]) {
+      continue;
+    }
+
+    const GLuint query = queries_[query_index];
+    if (!OpenGl::GetQueryObject(query, GL_QUERY_RESULT_AVAILABLE)) {
+      // Later queries can't be ready either
+      break;
+    }
+
+    result_ = OpenGl::GetQueryObject(query, GL_QUERY_RESULT);
+    pending_[query_index] = false;
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <optional>
+
+#include "integer.hpp"
+#include "opengl/gl_api.hpp"
+
+// Counts fragments that passed depth and stencil tests between Begin() and
+// End(). Results are read back a few frames later, so measuring never
+// stalls the pipeline.
+class SamplesPassedQuery {
+ public:
+  static constexpr size_t kNumQueries = 3;
+
+  SamplesPassedQuery();
+  SamplesPassedQuery(const SamplesPassedQuery&) = delete;
+  ~SamplesPassedQuery();
+
+  // The measurement is skipped if all queries are still in flight
+  void Begin();
+  void End();
+
+  // The most recent available result
+  [[nodiscard]] std::optional<ui64> GetResult() const noexcept {
+    return result_;
+  }
+
+  SamplesPassedQuery& operator=(const SamplesPassedQuery&) = delete;
+
+ private:
+  void Poll();
+
+ private:
+  std::array<GLuint, kNumQueries> queries_{};
+  std::array<bool, kNumQueries> pending_{};
+  std::optional<ui64> result_;
+  size_t index_ = 0;
+  bool active_ = false;
+};
@@ -0,0 +1,218 @@
+#include "opengl/stream_buffer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+#include "memory/memory_tracker.hpp"
+
+namespace {
+// Stream buffer is never bound to a target which is a part of vertex array
+// state, so mapping and orphaning don't disturb the current draw setup
+constexpr GLenum kStagingTarget = GL_COPY_WRITE_BUFFER;
+constexpr GLbitfield kPersistentFlags =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+constexpr GLbitfield kUnsynchronizedMapFlags =
+    GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+    GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+constexpr ui64 kFenceWaitStep =
+    std::chrono::nanoseconds(std::chrono::milliseconds(1)).count();
+
+[[nodiscard]] constexpr size_t AlignUp(size_t value,
+                                       size_t alignment) noexcept {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+}  // namespace
+
+StreamBuffer::StreamBuffer(size_t frame_capacity, bool allow_persistent)
+    : frame_capacity_(frame_capacity),
+      persistent_(allow_persistent && OpenGl::SupportsBufferStorage()) {
+  CreateStorage();
+}
+
+StreamBuffer::~StreamBuffer() {
+  Unmap();
+  DeleteFences();
+  for (const RetiredBuffer& retired : retired_) {
+    OpenGl::DeleteBuffer(retired.buffer);
+  }
+  OpenGl::DeleteBuffer(buffer_);
+}
+
+void StreamBuffer::BeginFrame() {
+  assert(!frame_started_);
+  segment_index_ = (segment_index_ + 1) % kFramesInFlight;
+
+  if (GLsync& fence = fences_[segment_index_]; fence) {
+    [[unlikely]] if (!OpenGl::ClientWaitSync(fence, 0)) {
+      if (persistent_) {
+        ++stats_.fence_waits;
+        while (!OpenGl::ClientWaitSync(fence, kFenceWaitStep)) {
+        }
+      } else {
+        // Driver gives us fresh storage instead of waiting for GPU
+        Orphan();
+      }
+    }
+
+    if (fence) {
+      OpenGl::DeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  head_ = GetSegmentBegin();
+  stats_.frame_bytes = 0;
+  stats_.frame_allocations = 0;
+  frame_started_ = true;
+}
+
+StreamAllocation StreamBuffer::Allocate(size_t size, size_t alignment) {
+  assert(frame_started_);
+  assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+  [[unlikely]] if (AlignUp(head_, alignment) + size > GetSegmentEnd()) {
+    // Earlier allocations keep pointing to the old storage
+    RetireStorage();
+    frame_capacity_ = std::max(frame_capacity_ * 2, size + alignment);
+    CreateStorage();
+    head_ = GetSegmentBegin();
+    ++stats_.grows;
+  }
+
+  if (!persistent_ && !mapped_) {
+    Map();
+  }
+
+  const size_t offset = AlignUp(head_, alignment);
+  head_ = offset + size;
+  stats_.frame_bytes += size;
+  ++stats_.frame_allocations;
+
+  StreamAllocation allocation;
+  allocation.buffer = buffer_;
+  allocation.offset = offset;
+  allocation.size = size;
+  allocation.data = mapped_ + (offset - map_begin_);
+  return allocation;
+}
+
+void StreamBuffer::Commit() {
+  Unmap();
+
+  for (RetiredBuffer& retired : retired_) {
+    if (retired.mapped) {
+      OpenGl::BindBuffer(kStagingTarget, retired.buffer);
+      if (retired.flush_length) {
+        OpenGl::FlushMappedBufferRange(
+            kStagingTarget, 0, static_cast<GLsizeiptr>(retired.flush_length));
+      }
+      OpenGl::UnmapBuffer(kStagingTarget);
+      retired.mapped = false;
+    }
+  }
+}
+
+void StreamBuffer::EndFrame() {
+  assert(frame_started_);
+  Commit();
+
+  fences_[segment_index_] = OpenGl::FenceSync();
+
+  // Commands that read retired buffers are already submitted so GL keeps
+  // their storage alive until they complete
+  for (const RetiredBuffer& retired : retired_) {
+    OpenGl::DeleteBuffer(retired.buffer);
+  }
+  retired_.clear();
+
+  stats_.peak_frame_bytes =
+      std::max(stats_.peak_frame_bytes, stats_.frame_bytes);
+  frame_started_ = false;
+}
+
+void StreamBuffer::BindRange(GLenum target, GLuint index,
+                             const StreamAllocation& allocation) noexcept {
+  OpenGl::BindBufferRange(target, index, allocation.buffer,
+                          static_cast<GLintptr>(allocation.offset),
+                          static_cast<GLsizeiptr>(allocation.size));
+}
+
+void StreamBuffer::CreateStorage() {
+  const MemoryTagScope tag_scope(MemoryTag::Render);
+  const auto total_size =
+      static_cast<GLsizeiptr>(frame_capacity_ * kFramesInFlight);
+  buffer_ = OpenGl::GenBuffer();
+  OpenGl::BindBuffer(kStagingTarget, buffer_);
+  map_begin_ = 0;
+
+  if (persistent_) {
+    OpenGl::BufferStorage(kStagingTarget, total_size, nullptr,
+                          kPersistentFlags);
+    mapped_ = reinterpret_cast<ui8*>(OpenGl::MapBufferRange(
+        kStagingTarget, 0, total_size, kPersistentFlags));
+  } else {
+    OpenGl::BufferData(kStagingTarget, total_size, nullptr, GL_STREAM_DRAW);
+    mapped_ = nullptr;
+  }
+
+  stats_.capacity = static_cast<size_t>(total_size);
+}
+
+void StreamBuffer::RetireStorage() {
+  RetiredBuffer retired;
+  retired.buffer = buffer_;
+  retired.mapped = !persistent_ && mapped_;
+  retired.flush_length = retired.mapped ? head_ - map_begin_ : 0;
+  retired_.push_back(retired);
+
+  // New storage is not used by GPU yet
+  DeleteFences();
+  mapped_ = nullptr;
+  buffer_ = 0;
+}
+
+void StreamBuffer::Orphan() {
+  assert(!persistent_ && !mapped_);
+  const MemoryTagScope tag_scope(MemoryTag::Render);
+  OpenGl::BindBuffer(kStagingTarget, buffer_);
+  OpenGl::BufferData(kStagingTarget,
+                     static_cast<GLsizeiptr>(frame_capacity_ * kFramesInFlight),
+                     nullptr, GL_STREAM_DRAW);
+  DeleteFences();
+  ++stats_.orphans;
+}
+
+void StreamBuffer::Map() {
+  assert(!persistent_ && !mapped_);
+  OpenGl::BindBuffer(kStagingTarget, buffer_);
+  map_begin_ = head_;
+  mapped_ = reinterpret_cast<ui8*>(OpenGl::MapBufferRange(
+      kStagingTarget, static_cast<GLintptr>(map_begin_),
+      static_cast<GLsizeiptr>(GetSegmentEnd() - map_begin_),
+      kUnsynchronizedMapFlags));
+}
+
+void StreamBuffer::Unmap() {
+  if (persistent_ || !mapped_) {
+    return;
+  }
+
+  OpenGl::BindBuffer(kStagingTarget, buffer_);
+  if (const size_t written = head_ - map_begin_; written) {
+    OpenGl::FlushMappedBufferRange(kStagingTarget, 0,
+                                   static_cast<GLsizeiptr>(written));
+  }
+  OpenGl::UnmapBuffer(kStagingTarget);
+  mapped_ = nullptr;
+  map_begin_ = 0;
+}
+
+void StreamBuffer::DeleteFences() {
+  for (GLsync& fence : fences_) {
+    if (fence) {
+      OpenGl::DeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+}
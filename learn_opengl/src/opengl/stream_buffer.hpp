@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "integer.hpp"
+#include "opengl/gl_api.hpp"
+
+struct StreamAllocation {
+  [[nodiscard]] bool IsValid() const noexcept { return data != nullptr; }
+
+  template <typename T>
+  [[nodiscard]] std::span<T> As() const noexcept {
+    return std::span(reinterpret_cast<T*>(data), size / sizeof(T));
+  }
+
+  GLuint buffer = 0;
+  size_t offset = 0;
+  size_t size = 0;
+  // CPU write pointer. Valid until Commit() or EndFrame()
+  ui8* data = nullptr;
+};
+
+struct StreamBufferStats {
+  size_t capacity = 0;
+  size_t frame_bytes = 0;
+  size_t peak_frame_bytes = 0;
+  ui32 frame_allocations = 0;
+  ui32 fence_waits = 0;
+  ui32 orphans = 0;
+  ui32 grows = 0;
+};
+
+// Ring buffer for dynamic per-frame data (transforms, material parameters,
+// instance data). The storage is split into kFramesInFlight segments and a
+// fence guards each of them, so the CPU never writes memory the GPU may still
+// read. Uses persistently mapped storage if the context supports it and
+// falls back to unsynchronized glMapBufferRange with orphaning otherwise.
+class StreamBuffer {
+ public:
+  static constexpr size_t kFramesInFlight = 3;
+
+  explicit StreamBuffer(size_t frame_capacity, bool allow_persistent = true);
+  StreamBuffer(const StreamBuffer&) = delete;
+  ~StreamBuffer();
+
+  // Selects the segment for the next frame. May block if GPU is more than
+  // kFramesInFlight frames behind.
+  void BeginFrame();
+
+  // alignment must be a power of two
+  [[nodiscard]] StreamAllocation Allocate(size_t size, size_t alignment = 16);
+
+  template <typename T>
+  [[nodiscard]] std::span<T> Allocate(size_t count,
+                                      size_t alignment = alignof(T)) {
+    return Allocate(sizeof(T) * count, alignment).As<T>();
+  }
+
+  // Makes everything written so far visible to GPU. Must be called before
+  // issuing commands that read allocated ranges.
+  void Commit();
+
+  // Commits pending writes and fences the segment of current frame
+  void EndFrame();
+
+  static void BindRange(GLenum target, GLuint index,
+                        const StreamAllocation& allocation) noexcept;
+
+  [[nodiscard]] bool IsPersistent() const noexcept { return persistent_; }
+  [[nodiscard]] const StreamBufferStats& GetStats() const noexcept {
+    return stats_;
+  }
+
+  StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+ private:
+  [[nodiscard]] size_t GetSegmentBegin() const noexcept {
+    return segment_index_ * frame_capacity_;
+  }
+  [[nodiscard]] size_t GetSegmentEnd() const noexcept {
+    return GetSegmentBegin() + frame_capacity_;
+  }
+
+  void CreateStorage();
+  void RetireStorage();
+  void Orphan();
+  void Map();
+  void Unmap();
+  void DeleteFences();
+
+ private:
+  // Storage replaced in the middle of a frame. Allocations made from it are
+  // alive until the end of that frame.
+  struct RetiredBuffer {
+    GLuint buffer;
+    size_t flush_length;
+    bool mapped;
+  };
+
+  std::array<GLsync, kFramesInFlight> fences_{};
+  std::vector<RetiredBuffer> retired_;
+  StreamBufferStats stats_;
+  size_t frame_capacity_;
+  size_t segment_index_ = 0;
+  // Offset of the first free byte in the current segment
+  size_t head_ = 0;
+  // Offset where the current mapping starts (fallback mode only)
+  size_t map_begin_ = 0;
+  ui8* mapped_ = nullptr;
+  GLuint buffer_ = 0;
+  bool persistent_;
+  bool frame_started_ = false;
+};
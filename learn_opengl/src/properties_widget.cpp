@@ -67,9 +67,27 @@ void ParametersWidget::Update() {
     FloatProperty("far plane", properties_->far_plane, 0.0f, 1000.0f);
     FloatProperty("fov", properties_->fov, 0.1f, 89.0f);
   }
+  GlCallsWidget();
   ImGui::End();
 }
 
+void ParametersWidget::GlCallsWidget() {
+  if (ImGui::CollapsingHeader("OpenGl Calls")) {
+    bool cache_enabled = OpenGl::IsStateCacheEnabled();
+    if (ImGui::Checkbox("state cache", &cache_enabled)) {
+      OpenGl::SetStateCacheEnabled(cache_enabled);
+    }
+
+    const GlCallCounters& counters = OpenGl::GetCallCounters();
+    for (size_t i = 0; i != counters.size(); ++i) {
+      const auto call = static_cast<GlApiCall>(i);
+      const std::string_view name = cppreflection::EnumToString(call);
+      ImGui::Text("%.*s: issued %u, skipped %u", static_cast<int>(name.size()),
+                  name.data(), counters[i].issued, counters[i].skipped);
+    }
+  }
+}
+
 void ParametersWidget::ColorProperty(
     const char* title, ProgramProperties::ColorIndex index) noexcept {
   auto& value = Get(index);
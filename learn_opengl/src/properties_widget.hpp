@@ -188,6 +188,7 @@ struct ParametersWidget {
 
  private:
   void PolygonModeWidget();
+  void GlCallsWidget();
   void ColorProperty(const char* title,
                      ProgramProperties::ColorIndex index) noexcept;
   void FloatProperty(const char* title, ProgramProperties::FloatIndex index,
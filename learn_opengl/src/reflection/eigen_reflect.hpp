@@ -51,4 +51,13 @@ struct TypeReflectionProvider<Eigen::Matrix4f> {
   }
 };
 
+template <>
+struct TypeReflectionProvider<Eigen::Quaternionf> {
+  [[nodiscard]] inline constexpr static auto ReflectType() {
+    return cppreflection::StaticClassTypeInfo<Eigen::Quaternionf>(
+        "Eigen::Quaternionf",
+        edt::GUID::Create("5D3A8C61-0F27-4B9E-A4D2-7E1B96C3F085"));
+  }
+};
+
 }  // namespace cppreflection
\ No newline at end of file
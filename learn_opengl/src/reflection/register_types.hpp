@@ -12,37 +12,44 @@
 #include "entities/entity.hpp"
 #include "reflection/eigen_reflect.hpp"
 #include "reflection/glm_reflect.hpp"
+#include "reflection/type_indices.hpp"
 #include "shader/sampler_uniform.hpp"
 #include "spdlog/spdlog.h"
 
+// Makes sure the type is in the registry and has a dense index
+template <typename T>
+void RegisterReflectionType() {
+  TypeIndices::Get().Register(*cppreflection::GetTypeInfo<T>());
+}
+
 inline void RegisterReflectionTypes() {
-  [[maybe_unused]] const cppreflection::Type* t;
-  t = cppreflection::GetTypeInfo<int8_t>();
-  t = cppreflection::GetTypeInfo<int16_t>();
-  t = cppreflection::GetTypeInfo<int32_t>();
-  t = cppreflection::GetTypeInfo<int64_t>();
-  t = cppreflection::GetTypeInfo<uint8_t>();
-  t = cppreflection::GetTypeInfo<uint16_t>();
-  t = cppreflection::GetTypeInfo<uint32_t>();
-  t = cppreflection::GetTypeInfo<uint64_t>();
-  t = cppreflection::GetTypeInfo<glm::vec2>();
-  t = cppreflection::GetTypeInfo<Eigen::Vector3f>();
-  t = cppreflection::GetTypeInfo<Eigen::Vector4f>();
-  t = cppreflection::GetTypeInfo<Eigen::Matrix3f>();
-  t = cppreflection::GetTypeInfo<Eigen::Matrix4f>();
-  t = cppreflection::GetTypeInfo<Eigen::Vector2f>();
-  t = cppreflection::GetTypeInfo<Eigen::Vector3f>();
-  t = cppreflection::GetTypeInfo<Eigen::Vector4f>();
-  t = cppreflection::GetTypeInfo<Eigen::Matrix3f>();
-  t = cppreflection::GetTypeInfo<Eigen::Matrix4f>();
-  t = cppreflection::GetTypeInfo<Component>();
-  t = cppreflection::GetTypeInfo<CameraComponent>();
-  t = cppreflection::GetTypeInfo<MeshComponent>();
-  t = cppreflection::GetTypeInfo<TransformComponent>();
-  t = cppreflection::GetTypeInfo<DirectionalLightComponent>();
-  t = cppreflection::GetTypeInfo<PointLightComponent>();
-  t = cppreflection::GetTypeInfo<SpotLightComponent>();
-  t = cppreflection::GetTypeInfo<Attenuation>();
-  t = cppreflection::GetTypeInfo<Entity>();
-  t = cppreflection::GetTypeInfo<SamplerUniform>();
+  RegisterReflectionType<int8_t>();
+  RegisterReflectionType<int16_t>();
+  RegisterReflectionType<int32_t>();
+  RegisterReflectionType<int64_t>();
+  RegisterReflectionType<uint8_t>();
+  RegisterReflectionType<uint16_t>();
+  RegisterReflectionType<uint32_t>();
+  RegisterReflectionType<uint64_t>();
+  RegisterReflectionType<glm::vec2>();
+  RegisterReflectionType<Eigen::Vector3f>();
+  RegisterReflectionType<Eigen::Vector4f>();
+  RegisterReflectionType<Eigen::Matrix3f>();
+  RegisterReflectionType<Eigen::Matrix4f>();
+  RegisterReflectionType<Eigen::Vector2f>();
+  RegisterReflectionType<Eigen::Vector3f>();
+  RegisterReflectionType<Eigen::Vector4f>();
+  RegisterReflectionType<Eigen::Matrix3f>();
+  RegisterReflectionType<Eigen::Matrix4f>();
+  RegisterReflectionType<Eigen::Quaternionf>();
+  RegisterReflectionType<Component>();
+  RegisterReflectionType<CameraComponent>();
+  RegisterReflectionType<MeshComponent>();
+  RegisterReflectionType<TransformComponent>();
+  RegisterReflectionType<DirectionalLightComponent>();
+  RegisterReflectionType<PointLightComponent>();
+  RegisterReflectionType<SpotLightComponent>();
+  RegisterReflectionType<Attenuation>();
+  RegisterReflectionType<Entity>();
+  RegisterReflectionType<SamplerUniform>();
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "reflection/type_indices.hpp"
+
+#include <fmt/format.h>
+
+#include <stdexcept>
+
+TypeMask AtomicTypeMask::Load() const noexcept {
+  TypeMask mask;
+  for (size_t i = kNumWords; i-- != 0;) {
+    mask <<= kBitsPerWord;
+    mask |= TypeMask(words_[i].load(std::memory_order_relaxed));
+  }
+  return mask;
+}
+
+void AtomicTypeMask::Or(const TypeMask& mask) noexcept {
+  const TypeMask word_mask(~ui64{0});
+  for (size_t i = 0; i != kNumWords; ++i) {
+    const ui64 word = ((mask >> (i * kBitsPerWord)) & word_mask).to_ullong();
+    [[likely]] if (word) {
+      words_[i].fetch_or(word, std::memory_order_relaxed);
+    }
+  }
+}
+
+TypeIndices& TypeIndices::Get() {
+  static TypeIndices instance;
+  return instance;
+}
+
+ui32 TypeIndices::Register(const cppreflection::Type& type) {
+  std::unique_lock lock(mutex_);
+  [[likely]] if (auto it = type_to_index_.find(&type);
+                 it != type_to_index_.end()) {
+    return it->second;
+  }
+
+  const ui32 index = num_types_.load(std::memory_order_relaxed);
+  [[unlikely]] if (index == kMaxIndexedTypes) {
+    throw std::runtime_error(
+        fmt::format("Can't index {}: limit of {} types is reached",
+                    type.GetName(), kMaxIndexedTypes));
+  }
+
+  const edt::GUID guid = type.GetGuid();
+  TypeMask ancestors;
+  ancestors.set(index);
+  for (ui32 other = 0; other != index; ++other) {
+    const cppreflection::Type& other_type = *types_[other];
+    if (type.IsA(other_type.GetGuid())) {
+      ancestors.set(other);
+    }
+
+    // Base may be registered after its derived types
+    if (other_type.IsA(guid)) {
+      ancestors_[other].Set(index);
+    }
+  }
+
+  types_[index] = &type;
+  ancestors_[index].Or(ancestors);
+  type_to_index_.emplace(&type, index);
+  // Publishes the type and the masks updated above
+  num_types_.store(index + 1, std::memory_order_release);
+  return index;
+}
+
+std::optional<ui32> TypeIndices::FindIndex(
+    edt::GUID type_guid) const noexcept {
+  const cppreflection::Type* type =
+      cppreflection::GetTypeRegistry()->FindType(type_guid);
+  [[likely]] if (type) { return FindIndex(*type); }
+  return std::nullopt;
+}
+
+std::optional<ui32> TypeIndices::FindIndex(
+    const cppreflection::Type& type) const noexcept {
+  std::shared_lock lock(mutex_);
+  [[likely]] if (auto it = type_to_index_.find(&type);
+                 it != type_to_index_.end()) {
+    return it->second;
+  }
+
+  return std::nullopt;
+}
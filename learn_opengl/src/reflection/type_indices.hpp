@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "CppReflection/GetTypeInfo.hpp"
+#include "CppReflection/TypeRegistry.hpp"
+#include "EverydayTools/GUID.hpp"
+#include "integer.hpp"
+
+constexpr size_t kMaxIndexedTypes = 128;
+
+// Set of dense type indices
+using TypeMask = std::bitset<kMaxIndexedTypes>;
+
+// TypeMask which may get more bits while other threads read it
+class AtomicTypeMask {
+ public:
+  static constexpr size_t kBitsPerWord = 64;
+  static constexpr size_t kNumWords = kMaxIndexedTypes / kBitsPerWord;
+  static_assert(kMaxIndexedTypes % kBitsPerWord == 0);
+
+  [[nodiscard]] bool Test(ui32 index) const noexcept {
+    const ui64 word =
+        words_[index / kBitsPerWord].load(std::memory_order_relaxed);
+    return (word >> (index % kBitsPerWord)) & 1;
+  }
+
+  void Set(ui32 index) noexcept {
+    words_[index / kBitsPerWord].fetch_or(ui64{1} << (index % kBitsPerWord),
+                                          std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] TypeMask Load() const noexcept;
+  void Or(const TypeMask& mask) noexcept;
+
+ private:
+  std::array<std::atomic<ui64>, kNumWords> words_{};
+};
+
+// Assigns dense indices to reflected types and precomputes for each of them
+// the mask of types it IsA (itself and all bases), so that type checks on
+// hot paths are bit tests instead of registry lookups. Types are registered
+// at startup by RegisterReflectionTypes, others get an index on first use,
+// possibly while other threads query registered types. Ancestor masks only
+// get bits added, and they are written before the count is published.
+class TypeIndices {
+ public:
+  static TypeIndices& Get();
+
+  // Returns the existing index if the type is registered already
+  ui32 Register(const cppreflection::Type& type);
+
+  [[nodiscard]] std::optional<ui32> FindIndex(
+      edt::GUID type_guid) const noexcept;
+  [[nodiscard]] std::optional<ui32> FindIndex(
+      const cppreflection::Type& type) const noexcept;
+
+  // Mask of types which the type IsA, including itself
+  [[nodiscard]] TypeMask GetAncestors(ui32 index) const noexcept {
+    return ancestors_[index].Load();
+  }
+  [[nodiscard]] bool IsA(ui32 index, ui32 ancestor) const noexcept {
+    return ancestors_[index].Test(ancestor);
+  }
+
+  [[nodiscard]] const cppreflection::Type* GetType(ui32 index) const noexcept {
+    return types_[index];
+  }
+
+  [[nodiscard]] size_t GetNumTypes() const noexcept {
+    return num_types_.load(std::memory_order_acquire);
+  }
+
+  template <typename T>
+  [[nodiscard]] static ui32 IndexOf() {
+    static const ui32 index = Get().Register(*cppreflection::GetTypeInfo<T>());
+    return index;
+  }
+
+ private:
+  // Guards type_to_index_ and registration
+  mutable std::shared_mutex mutex_;
+  std::atomic<ui32> num_types_ = 0;
+  // Fixed storage: readers never see a reallocation
+  std::array<const cppreflection::Type*, kMaxIndexedTypes> types_{};
+  std::array<AtomicTypeMask, kMaxIndexedTypes> ancestors_;
+  std::unordered_map<const cppreflection::Type*, ui32> type_to_index_;
+};
@@ -1,5 +1,9 @@
 #include "render_system.hpp"
 
+#include <iterator>
+#include <memory_resource>
+#include <string>
+
 #include "components/camera_component.hpp"
 #include "components/lights/directional_light_component.hpp"
 #include "components/lights/point_light_component.hpp"
@@ -7,25 +11,33 @@
 #include "components/mesh_component.hpp"
 #include "components/transform_component.hpp"
 #include "entities/entity.hpp"
+#include "geometry/frustum.hpp"
+#include "memory/frame_allocator.hpp"
+#include "name_cache/name_literal.hpp"
 #include "opengl/debug/annotations.hpp"
 #include "reflection/eigen_reflect.hpp"
 #include "spdlog/spdlog.h"
 #include "texture/texture_manager.hpp"
 #include "window.hpp"
 #include "world.hpp"
+#include "wrap/wrap_imgui.h"
+
+static constexpr size_t kStreamBufferFrameCapacity = 2 * 1024 * 1024;
 
 auto GetMaterialUniform(Shader& s) {
   MaterialUniform u;
-  u.diffuse = s.GetUniform("material.diffuse");
-  u.specular = s.GetUniform("material.specular");
-  u.shininess = s.GetUniform("material.shininess");
+  u.diffuse = s.GetUniform("material.diffuse"_name);
+  u.specular = s.GetUniform("material.specular"_name);
+  u.shininess = s.GetUniform("material.shininess"_name);
   return u;
 }
 
 static auto GetArrayUniform(const Shader& s, std::string_view array_name,
                             size_t index, std::string_view property_name) {
-  return s.GetUniform(
-      fmt::format("{}[{}].{}", array_name, index, property_name));
+  fmt::memory_buffer name;
+  fmt::format_to(std::back_inserter(name), "{}[{}].{}", array_name, index,
+                 property_name);
+  return s.GetUniform(std::string_view(name.data(), name.size()));
 }
 
 auto GetPointLightUniform(Shader& s, size_t index) {
@@ -113,11 +125,7 @@ void PrintUniforms(std::span<T, Extent> uniforms) {
 
 void ApplyUniforms(PointLightUniform& u, Shader& s,
                    TransformComponent& transform, PointLightComponent& light) {
-  {
-    Eigen::Transform<float, 3, Eigen::Affine> tr(transform.transform);
-    Eigen::Vector3f l = tr.translation();
-    s.SetUniform(u.location, l);
-  }
+  s.SetUniform(u.location, transform.GetTranslation());
 
   s.SetUniform(u.ambient, light.ambient);
   s.SetUniform(u.diffuse, light.diffuse);
@@ -161,11 +169,11 @@ void ApplyUniforms(DirectionalLightUniform& u, Shader& s,
 }
 
 template <typename UniformType, typename LightComponent, typename UniformGetter>
-void SetLightsArrayUniform(
-    Shader& shader, DefineHandle& define, std::vector<UniformType>& uniforms,
-    std::vector<std::pair<TransformComponent*, LightComponent*>>& lights,
-    const std::pair<TransformComponent*, LightComponent*>& default_light,
-    UniformGetter uniform_getter) {
+void SetLightsArrayUniform(Shader& shader, DefineHandle& define,
+                           std::vector<UniformType>& uniforms,
+                           std::span<const LightEntry<LightComponent>> lights,
+                           const LightEntry<LightComponent>& default_light,
+                           bool lights_rebuilt, UniformGetter uniform_getter) {
   auto num_uniforms = static_cast<size_t>(shader.GetDefineValue<int>(define));
 
   [[unlikely]] if (lights.size() > num_uniforms) {
@@ -177,34 +185,89 @@ void SetLightsArrayUniform(
   }
 
   // Refresh uniforms array if number changed
+  bool apply_all = lights_rebuilt;
   [[unlikely]] if (num_uniforms != uniforms.size()) {
     uniforms.resize(num_uniforms);
     for (size_t idx = 0; idx < num_uniforms; ++idx) {
       uniforms[idx] = uniform_getter(shader, idx);
     }
+    apply_all = true;
     // PrintUniforms(std::span{uniforms});
   }
 
-  // Apply actual lights
+  // Apply actual lights. Shader keeps values of others.
   size_t uniform_index = 0;
   while ((uniform_index < lights.size()) && (uniform_index < num_uniforms)) {
-    auto [t, l] = lights[uniform_index];
-    ApplyUniforms(uniforms[uniform_index], shader, *t, *l);
+    const auto& [t, l, changed] = lights[uniform_index];
+    if (apply_all || changed) {
+      ApplyUniforms(uniforms[uniform_index], shader, *t, *l);
+    }
     ++uniform_index;
   }
 
   // Apply defaults if there are unused slots
-  auto [t, l] = default_light;
+  [[likely]] if (!apply_all) { return; }
   while (uniform_index < num_uniforms) {
-    ApplyUniforms(uniforms[uniform_index], shader, *t, *l);
+    ApplyUniforms(uniforms[uniform_index], shader, *default_light.transform,
+                  *default_light.light);
     ++uniform_index;
   }
 }
 
+// Marks lights whose components were written after the version
+template <typename Light>
+void CollectLightList(World& world, ui32 since, bool mark_all,
+                      std::vector<LightEntry<Light>>& lights) {
+  lights.clear();
+  world.ForEachChunk<TransformComponent, Light>(
+      [&](const ArchetypeChunk& chunk, std::span<TransformComponent> transforms,
+          std::span<Light> components) {
+        const Archetype& archetype = chunk.GetArchetype();
+        const size_t transform_column =
+            *archetype.FindColumn(TypeIndices::IndexOf<TransformComponent>());
+        const size_t light_column =
+            *archetype.FindColumn(TypeIndices::IndexOf<Light>());
+        const bool chunk_changed =
+            mark_all ||
+            chunk.GetColumnChangeVersion(transform_column) > since ||
+            chunk.GetColumnChangeVersion(light_column) > since;
+        for (size_t i = 0; i != chunk.GetSize(); ++i) {
+          const bool changed =
+              mark_all ||
+              (chunk_changed &&
+               (chunk.GetChangeVersion(transform_column, i) > since ||
+                chunk.GetChangeVersion(light_column, i) > since));
+          lights.push_back({&transforms[i], &components[i], changed});
+        }
+      });
+}
+
+static Eigen::Matrix4f GetModelMatrix(Entity& entity) {
+  // The last transform component wins
+  Eigen::Matrix4f model = Eigen::Matrix4f::Identity();
+  entity.ForEachComp<TransformComponent>(
+      [&](TransformComponent& transform_component) {
+        model = transform_component.GetWorld();
+      });
+  return model;
+}
+
+static void AddMeshDraws(Entity& entity, const Eigen::Matrix4f& model,
+                         DrawList& draw_list) {
+  entity.ForEachComp<MeshComponent>([&](MeshComponent& mesh_component) {
+    [[likely]] if (mesh_component.GetGeometry()) {
+      draw_list.Add(*mesh_component.GetGeometry(), model);
+    }
+  });
+}
+
 RenderSystem::RenderSystem(TextureManager& texture_manager)
-    : texture_manager_(&texture_manager) {
+    : texture_manager_(&texture_manager),
+      stream_buffer_(kStreamBufferFrameCapacity) {
   shader_ = std::make_shared<Shader>("simple.shader.json");
   outline_shader_ = std::make_shared<Shader>("outline.shader.json");
+  depth_shader_ = std::make_shared<Shader>("depth.shader.json");
+  gbuffer_shader_ = std::make_shared<Shader>("gbuffer.shader.json");
   shader_->Use();
 
   container_diffuse_ = texture_manager.GetTexture("container.texture.json");
@@ -219,46 +282,99 @@ RenderSystem::RenderSystem(TextureManager& texture_manager)
   default_directional_light_.specular = Eigen::Vector3f::Zero();
   default_spot_light_.diffuse = Eigen::Vector3f::Zero();
   default_spot_light_.specular = Eigen::Vector3f::Zero();
-  def_num_point_lights_ = shader_->GetDefine("cv_num_point_lights");
-  def_num_directional_lights_ = shader_->GetDefine("cv_num_directional_lights");
-  def_num_spot_lights_ = shader_->GetDefine("cv_num_spot_lights");
+  def_num_point_lights_ = shader_->GetDefine("cv_num_point_lights"_name);
+  def_num_directional_lights_ =
+      shader_->GetDefine("cv_num_directional_lights"_name);
+  def_num_spot_lights_ = shader_->GetDefine("cv_num_spot_lights"_name);
 
   material_uniform_ = GetMaterialUniform(*shader_);
 
-  model_uniform_ = shader_->GetUniform("model");
-  view_uniform_ = shader_->GetUniform("view");
-  projection_uniform_ = shader_->GetUniform("projection");
-  view_location_uniform_ = shader_->GetUniform("viewLocation");
-  tex_multiplier_uniform_ = shader_->GetUniform("texCoordMultiplier");
+  view_uniform_ = shader_->GetUniform("view"_name);
+  projection_uniform_ = shader_->GetUniform("projection"_name);
+  view_location_uniform_ = shader_->GetUniform("viewLocation"_name);
+  tex_multiplier_uniform_ = shader_->GetUniform("texCoordMultiplier"_name);
+
+  outline_view_uniform_ = shader_->GetUniform("view"_name);
+  outline_projection_uniform_ = shader_->GetUniform("projection"_name);
 
-  outline_model_uniform_ = shader_->GetUniform("model");
-  outline_view_uniform_ = shader_->GetUniform("view");
-  outline_projection_uniform_ = shader_->GetUniform("projection");
+  depth_view_uniform_ = depth_shader_->GetUniform("view"_name);
+  depth_projection_uniform_ = depth_shader_->GetUniform("projection"_name);
+
+  gbuffer_material_uniform_ = GetMaterialUniform(*gbuffer_shader_);
+  gbuffer_view_uniform_ = gbuffer_shader_->GetUniform("view"_name);
+  gbuffer_projection_uniform_ = gbuffer_shader_->GetUniform("projection"_name);
+  gbuffer_tex_multiplier_uniform_ =
+      gbuffer_shader_->GetUniform("texCoordMultiplier"_name);
 
   shader_->SetUniform(material_uniform_.diffuse, container_diffuse_);
   shader_->SetUniform(material_uniform_.specular, container_specular_);
   shader_->SetUniform(material_uniform_.shininess, 32.0f);
   shader_->SetUniform(tex_multiplier_uniform_, Eigen::Vector2f{1.0f, 1.0f});
+
+  gbuffer_shader_->SetUniform(gbuffer_material_uniform_.diffuse,
+                              container_diffuse_);
+  gbuffer_shader_->SetUniform(gbuffer_material_uniform_.specular,
+                              container_specular_);
+  gbuffer_shader_->SetUniform(gbuffer_material_uniform_.shininess, 32.0f);
+  gbuffer_shader_->SetUniform(gbuffer_tex_multiplier_uniform_,
+                              Eigen::Vector2f{1.0f, 1.0f});
 }
 
 RenderSystem::~RenderSystem() = default;
 
+void RenderSystem::CollectLights(World& world) {
+  // Order of lights changes with the structure of the world, and the other
+  // path has not seen changes made while this one was active
+  lights_rebuilt_ =
+      world.GetStructureVersion() != lights_structure_version_ ||
+      shading_path_ != lights_shading_path_;
+  CollectLightList(world, lights_change_version_, lights_rebuilt_,
+                   point_lights_);
+  CollectLightList(world, lights_change_version_, lights_rebuilt_,
+                   directional_lights_);
+  CollectLightList(world, lights_change_version_, lights_rebuilt_,
+                   spot_lights_);
+
+  // Components may still be written in this frame after rendering
+  lights_structure_version_ = world.GetStructureVersion();
+  lights_change_version_ = world.GetChangeVersion() - 1;
+  lights_shading_path_ = shading_path_;
+}
+
 void RenderSystem::ApplyLights() {
-  SetLightsArrayUniform(
+  SetLightsArrayUniform<PointLightUniform, PointLightComponent>(
       *shader_, def_num_point_lights_, point_light_uniforms_, point_lights_,
-      {&default_transform_, &default_point_light_}, GetPointLightUniform);
+      {&default_transform_, &default_point_light_, true}, lights_rebuilt_,
+      GetPointLightUniform);
 
-  SetLightsArrayUniform(*shader_, def_num_directional_lights_,
-                        directional_light_uniforms_, directional_lights_,
-                        {&default_transform_, &default_directional_light_},
-                        GetDirectionalLightUniform);
+  SetLightsArrayUniform<DirectionalLightUniform, DirectionalLightComponent>(
+      *shader_, def_num_directional_lights_, directional_light_uniforms_,
+      directional_lights_,
+      {&default_transform_, &default_directional_light_, true},
+      lights_rebuilt_, GetDirectionalLightUniform);
 
-  SetLightsArrayUniform(
+  SetLightsArrayUniform<SpotLightUniform, SpotLightComponent>(
       *shader_, def_num_spot_lights_, spot_light_uniforms_, spot_lights_,
-      {&default_transform_, &default_spot_light_}, GetSpotLightUniform);
+      {&default_transform_, &default_spot_light_, true}, lights_rebuilt_,
+      GetSpotLightUniform);
 }
 
 void RenderSystem::Render(Window& window, World& world, Entity* selected) {
+  const bool deferred = shading_path_ == ShadingPath::Deferred;
+  stream_buffer_.BeginFrame();
+  std::pmr::memory_resource* frame_memory =
+      FrameAllocator::Get().GetResource();
+  draw_list_.Reset(frame_memory);
+  selected_draw_list_.Reset(frame_memory);
+  static_batcher_.Update(world);
+  CollectLights(world);
+  if (deferred) {
+    depth_pre_pass_ = false;
+  } else {
+    UpdateDepthPrePass(window);
+  }
+  frame_draws_ = 0;
+  frame_draw_calls_ = 0;
   OpenGl::Viewport(0, 0, static_cast<GLsizei>(window.GetWidth()),
                    static_cast<GLsizei>(window.GetHeight()));
 
@@ -274,34 +390,50 @@ void RenderSystem::Render(Window& window, World& world, Entity* selected) {
   glStencilFunc(GL_ALWAYS, 1, 0xFF);
   glStencilMask(0xFF);
 
-  OpenGl::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT |
-                GL_STENCIL_BUFFER_BIT);
+  if (deferred) {
+    g_buffer_.Resize(window.GetWidth(), window.GetHeight());
+    g_buffer_.BeginGeometryPass();
+  } else {
+    OpenGl::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT |
+                  GL_STENCIL_BUFFER_BIT);
+  }
+
+  static_batcher_.AddDraws(Frustum(window.GetProjection() * window.GetView()),
+                           draw_list_);
+  const Eigen::Matrix4f identity = Eigen::Matrix4f::Identity();
+  world.ForEachChunk<MeshComponent>(
+      [&](const ArchetypeChunk& chunk, std::span<MeshComponent> meshes) {
+        const std::span<Entity* const> entities = chunk.GetEntities();
+        const std::span<TransformComponent> transforms =
+            chunk.FindComponents<TransformComponent>();
+        for (size_t i = 0; i != meshes.size(); ++i) {
+          const Entity* entity = entities[i];
+          [[unlikely]] if (entity == selected ||
+                           static_batcher_.IsBatched(*entity)) {
+            continue;
+          }
+
+          [[likely]] if (meshes[i].GetGeometry()) {
+            draw_list_.Add(*meshes[i].GetGeometry(),
+                           transforms.empty() ? identity
+                                              : transforms[i].GetWorld());
+          }
+        }
+      });
+
+  // Batched selected entity is a part of a batch already and is drawn once
+  // again only to mark it in stencil
+  const bool selected_is_batched =
+      selected &&
+      static_batcher_.AddEntityDraws(*selected, selected_draw_list_);
+  if (selected && !selected_is_batched) {
+    AddMeshDraws(*selected, GetModelMatrix(*selected), selected_draw_list_);
+  }
 
-  {
-    ScopeAnnotation annot_render_("Render world");
-    shader_->Use();
-    shader_->SetUniform(view_uniform_, window.GetView());
-    shader_->SetUniform(view_location_uniform_, window.GetCamera()->eye);
-    shader_->SetUniform(projection_uniform_, window.GetProjection());
-
-    ApplyLights();
-    shader_->SendUniforms();
-
-    world.ForEachEntity([&](Entity& entity) {
-      const bool is_selected = (&entity == selected);
-      // don't update stencil buffer for not selected objects
-      glStencilMask(is_selected ? 0xFF : 0x00);
-
-      entity.ForEachComp<TransformComponent>(
-          [&](TransformComponent& transform_component) {
-            auto t = transform_component.transform;
-            shader_->SetUniform(model_uniform_, t);
-            shader_->SendUniform(model_uniform_);
-          });
-
-      entity.ForEachComp<MeshComponent>(
-          [&](MeshComponent& mesh_component) { mesh_component.Draw(); });
-    });
+  if (deferred) {
+    RenderDeferred(window, selected_is_batched);
+  } else {
+    RenderForward(window, selected_is_batched);
   }
 
   if (selected) {
@@ -313,19 +445,225 @@ void RenderSystem::Render(Window& window, World& world, Entity* selected) {
     outline_shader_->SetUniform(outline_view_uniform_, window.GetView());
     outline_shader_->SetUniform(outline_projection_uniform_,
                                 window.GetProjection());
+    outline_shader_->SendUniforms();
 
-    selected->ForEachComp<TransformComponent>(
-        [&](TransformComponent& transform_component) {
-          Eigen::Vector3f s = Eigen::Vector3f::Ones() * 1.05f;
-          Eigen::Matrix4f t =
-              transform_component.transform * Eigen::Scale(s.x(), s.y(), s.z());
-          outline_shader_->SetUniform(outline_model_uniform_, t);
-        });
+    const Eigen::Vector3f s = Eigen::Vector3f::Ones() * 1.05f;
+    const Eigen::Matrix4f t =
+        GetModelMatrix(*selected) * Eigen::Scale(s.x(), s.y(), s.z());
+    AddMeshDraws(*selected, t, draw_list_);
+    SubmitDraws();
+  }
 
-    outline_shader_->SendUniforms();
-    selected->ForEachComp<MeshComponent>(
-        [&](MeshComponent& mesh_component) { mesh_component.Draw(); });
+  if (deferred) {
+    g_buffer_.Present();
   }
 
   OpenGl::BindVertexArray(0);
+  stream_buffer_.EndFrame();
+}
+
+void RenderSystem::RenderForward(const Window& window,
+                                 bool selected_is_batched) {
+  if (depth_pre_pass_) {
+    ScopeAnnotation annot_render_("Depth pre-pass");
+    depth_shader_->Use();
+    depth_shader_->SetUniform(depth_view_uniform_, window.GetView());
+    depth_shader_->SetUniform(depth_projection_uniform_,
+                              window.GetProjection());
+    depth_shader_->SendUniforms();
+
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glStencilMask(0x00);
+    overdraw_query_.Begin();
+    SubmitDraws(draw_list_);
+    if (!selected_is_batched) {
+      SubmitDraws(selected_draw_list_);
+    }
+    overdraw_query_.End();
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    // Only the nearest fragment of each pixel gets shaded
+    glDepthFunc(GL_EQUAL);
+    glDepthMask(GL_FALSE);
+  }
+
+  ScopeAnnotation annot_render_("Render world");
+  shader_->Use();
+  shader_->SetUniform(view_uniform_, window.GetView());
+  shader_->SetUniform(view_location_uniform_, window.GetEyeLocation());
+  shader_->SetUniform(projection_uniform_, window.GetProjection());
+
+  ApplyLights();
+  shader_->SendUniforms();
+
+  // don't update stencil buffer for not selected objects
+  glStencilMask(0x00);
+  [[likely]] if (!depth_pre_pass_) { overdraw_query_.Begin(); }
+  SubmitDraws();
+  SubmitSelectedDraws(selected_is_batched);
+  [[likely]] if (!depth_pre_pass_) { overdraw_query_.End(); }
+
+  glDepthFunc(GL_LESS);
+  glDepthMask(GL_TRUE);
+}
+
+void RenderSystem::RenderDeferred(const Window& window,
+                                  bool selected_is_batched) {
+  {
+    ScopeAnnotation annot_render_("Geometry pass");
+    gbuffer_shader_->Use();
+    gbuffer_shader_->SetUniform(gbuffer_view_uniform_, window.GetView());
+    gbuffer_shader_->SetUniform(gbuffer_projection_uniform_,
+                                window.GetProjection());
+    gbuffer_shader_->SendUniforms();
+
+    // Blending would mix attributes of different surfaces
+    glDisable(GL_BLEND);
+    glStencilMask(0x00);
+    SubmitDraws();
+    SubmitSelectedDraws(selected_is_batched);
+    glEnable(GL_BLEND);
+  }
+
+  ScopeAnnotation annot_render_("Lighting pass");
+  g_buffer_.BeginLightingPass();
+  deferred_lighting_.Render(g_buffer_, window, point_lights_, spot_lights_,
+                            directional_lights_);
+}
+
+void RenderSystem::SubmitSelectedDraws(bool selected_is_batched) {
+  glStencilMask(0xFF);
+  [[unlikely]] if (selected_is_batched) {
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    [[likely]] if (!depth_pre_pass_) { glDepthFunc(GL_LEQUAL); }
+    SubmitDraws(selected_draw_list_);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthFunc(depth_pre_pass_ ? GL_EQUAL : GL_LESS);
+  } else {
+    SubmitDraws(selected_draw_list_);
+  }
+  selected_draw_list_.Clear();
+}
+
+void RenderSystem::UpdateDepthPrePass(const Window& window) {
+  // Hysteresis keeps auto mode from flipping every frame
+  constexpr float kEnableOverdraw = 1.5f;
+  constexpr float kDisableOverdraw = 1.2f;
+
+  if (const auto samples = overdraw_query_.GetResult(); samples) {
+    const auto num_pixels =
+        static_cast<float>(window.GetWidth() * window.GetHeight());
+    [[likely]] if (num_pixels > 0.0f) {
+      estimated_overdraw_ = static_cast<float>(*samples) / num_pixels;
+    }
+  }
+
+  switch (depth_pre_pass_mode_) {
+    case DepthPrePassMode::Off:
+      depth_pre_pass_ = false;
+      break;
+    case DepthPrePassMode::On:
+      depth_pre_pass_ = true;
+      break;
+    default:
+      depth_pre_pass_ = estimated_overdraw_ >
+                        (depth_pre_pass_ ? kDisableOverdraw : kEnableOverdraw);
+      break;
+  }
+}
+
+void RenderSystem::SubmitDraws() {
+  SubmitDraws(draw_list_);
+  draw_list_.Clear();
+}
+
+void RenderSystem::SubmitDraws(DrawList& draw_list) {
+  frame_draws_ += static_cast<ui32>(draw_list.GetSize());
+  frame_draw_calls_ += draw_list.Submit(GeometryArena::Get(), stream_buffer_,
+                                        use_indirect_draws_);
+}
+
+void RenderSystem::DrawDetails() {
+  ImGui::Begin("Render System");
+  if (ImGui::CollapsingHeader("Shading")) {
+    for (ui8 i = 0; i != static_cast<ui8>(ShadingPath::Max); ++i) {
+      const auto path = static_cast<ShadingPath>(i);
+      const std::pmr::string label(cppreflection::EnumToString(path),
+                                   FrameAllocator::Get().GetResource());
+      if (ImGui::RadioButton(label.data(), shading_path_ == path)) {
+        shading_path_ = path;
+      }
+    }
+
+    [[unlikely]] if (shading_path_ == ShadingPath::Deferred) {
+      const DeferredLightingStats& stats = deferred_lighting_.GetStats();
+      ImGui::Text("point lights: %u", stats.num_point_lights);
+      ImGui::Text("spot lights: %u", stats.num_spot_lights);
+      ImGui::Text("directional lights: %u", stats.num_directional_lights);
+      ImGui::Text("light draw calls: %u", stats.num_draw_calls);
+      ImGui::Text("updated lights: %u", stats.num_updated_lights);
+      ImGui::Text("uploaded light bytes: %zu", stats.uploaded_bytes);
+    }
+  }
+
+  if (ImGui::CollapsingHeader("Depth Pre-pass")) {
+    for (ui8 i = 0; i != static_cast<ui8>(DepthPrePassMode::Max); ++i) {
+      const auto mode = static_cast<DepthPrePassMode>(i);
+      const std::pmr::string label(cppreflection::EnumToString(mode),
+                                   FrameAllocator::Get().GetResource());
+      if (ImGui::RadioButton(label.data(), depth_pre_pass_mode_ == mode)) {
+        depth_pre_pass_mode_ = mode;
+      }
+    }
+    ImGui::Text("active: %s", depth_pre_pass_ ? "yes" : "no");
+    ImGui::Text("estimated overdraw: %.2f",
+                static_cast<double>(estimated_overdraw_));
+  }
+
+  if (ImGui::CollapsingHeader("Draw Submission")) {
+    ImGui::Checkbox("multi-draw indirect", &use_indirect_draws_);
+    ImGui::Text("supported: %s",
+                OpenGl::SupportsMultiDrawIndirect() ? "yes" : "no");
+    ImGui::Text("draws: %u in %u API calls", frame_draws_, frame_draw_calls_);
+  }
+
+  if (ImGui::CollapsingHeader("Geometry Arena")) {
+    const GeometryArenaStats stats = GeometryArena::Get().GetStats();
+    ImGui::Text("vertices: %zu / %zu", stats.used_vertices,
+                stats.vertex_capacity);
+    ImGui::Text("indices: %zu / %zu", stats.used_indices,
+                stats.index_capacity);
+    ImGui::Text("allocations: %u, grows: %u", stats.num_allocations,
+                stats.grows);
+  }
+
+  if (ImGui::CollapsingHeader("Stream Buffer")) {
+    const StreamBufferStats& stats = stream_buffer_.GetStats();
+    ImGui::Text("mode: %s",
+                stream_buffer_.IsPersistent() ? "persistent" : "orphaning");
+    ImGui::Text("capacity: %zu bytes", stats.capacity);
+    ImGui::Text("frame: %zu bytes in %u allocations", stats.frame_bytes,
+                stats.frame_allocations);
+    ImGui::Text("peak frame: %zu bytes", stats.peak_frame_bytes);
+    ImGui::Text("fence waits: %u, orphans: %u, grows: %u", stats.fence_waits,
+                stats.orphans, stats.grows);
+  }
+
+  if (ImGui::CollapsingHeader("Static Batching")) {
+    bool enabled = static_batcher_.IsEnabled();
+    if (ImGui::Checkbox("enabled", &enabled)) {
+      static_batcher_.SetEnabled(enabled);
+    }
+
+    const StaticBatchingStats& stats = static_batcher_.GetStats();
+    ImGui::Text("batches: %u (%u meshes merged)", stats.num_batches,
+                stats.num_merged_meshes);
+    ImGui::Text("saved draw calls: %u",
+                stats.num_merged_meshes - stats.num_batches);
+    ImGui::Text("frame: %u drawn, %u culled", stats.frame_drawn_batches,
+                stats.frame_culled_batches);
+    ImGui::Text("rebuilds: %u, last: %.3f ms", stats.num_rebuilds,
+                static_cast<double>(stats.last_rebuild_ms));
+  }
+  ImGui::End();
 }
\ No newline at end of file
@@ -4,13 +4,35 @@
 #include "components/lights/point_light_component.hpp"
 #include "components/lights/spot_light_component.hpp"
 #include "components/transform_component.hpp"
+#include "deferred/deferred_lighting.hpp"
+#include "deferred/g_buffer.hpp"
+#include "geometry/draw_list.hpp"
+#include "opengl/samples_passed_query.hpp"
+#include "opengl/stream_buffer.hpp"
 #include "shader/shader.hpp"
+#include "static_batching/static_batcher.hpp"
 
 class TextureManager;
 class Window;
 class World;
 class Entity;
 
+enum class DepthPrePassMode : ui8 {
+  Off,
+  On,
+  // Enabled while estimated overdraw is high
+  Auto,
+  Max
+};
+
+enum class ShadingPath : ui8 {
+  // Lights are evaluated for every fragment in one pass
+  Forward,
+  // Surface attributes go to a G-buffer, lights shade only pixels they reach
+  Deferred,
+  Max
+};
+
 struct MaterialUniform {
   UniformHandle diffuse;
   UniformHandle specular;
@@ -51,9 +73,22 @@ class RenderSystem {
   RenderSystem(TextureManager& texture_manager);
   ~RenderSystem();
 
+  // Gathers lights of the world. Pointers are valid until the world changes
+  // structurally.
+  void CollectLights(World& world);
   void ApplyLights();
 
   void Render(Window& window, World& world, Entity* selected);
+  void DrawDetails();
+
+  // Submits and clears draw_list_
+  void SubmitDraws();
+  void SubmitDraws(DrawList& draw_list);
+  void UpdateDepthPrePass(const Window& window);
+  void RenderForward(const Window& window, bool selected_is_batched);
+  void RenderDeferred(const Window& window, bool selected_is_batched);
+  // Submits and clears selected_draw_list_ marking it in stencil
+  void SubmitSelectedDraws(bool selected_is_batched);
 
   TextureManager* texture_manager_;
 
@@ -66,27 +101,89 @@ class RenderSystem {
   DefineHandle def_num_spot_lights_;
 
   MaterialUniform material_uniform_;
-  UniformHandle model_uniform_;
   UniformHandle view_uniform_;
   UniformHandle view_location_uniform_;
   UniformHandle projection_uniform_;
   UniformHandle tex_multiplier_uniform_;
 
-  UniformHandle outline_model_uniform_;
   UniformHandle outline_view_uniform_;
   UniformHandle outline_projection_uniform_;
 
+  UniformHandle depth_view_uniform_;
+  UniformHandle depth_projection_uniform_;
+
+  MaterialUniform gbuffer_material_uniform_;
+  UniformHandle gbuffer_view_uniform_;
+  UniformHandle gbuffer_projection_uniform_;
+  UniformHandle gbuffer_tex_multiplier_uniform_;
+
   std::shared_ptr<Shader> shader_;
   std::shared_ptr<Shader> outline_shader_;
+  std::shared_ptr<Shader> depth_shader_;
+  std::shared_ptr<Shader> gbuffer_shader_;
   std::vector<PointLightUniform> point_light_uniforms_;
-  std::vector<std::pair<TransformComponent*, PointLightComponent*>>
-      point_lights_;
+  std::vector<LightEntry<PointLightComponent>> point_lights_;
   std::vector<DirectionalLightUniform> directional_light_uniforms_;
-  std::vector<std::pair<TransformComponent*, DirectionalLightComponent*>>
-      directional_lights_;
+  std::vector<LightEntry<DirectionalLightComponent>> directional_lights_;
   std::vector<SpotLightUniform> spot_light_uniforms_;
-  std::vector<std::pair<TransformComponent*, SpotLightComponent*>> spot_lights_;
+  std::vector<LightEntry<SpotLightComponent>> spot_lights_;
+  // What the light lists were built from the last time
+  ui64 lights_structure_version_ = ~ui64{0};
+  ui32 lights_change_version_ = 0;
+  ShadingPath lights_shading_path_ = ShadingPath::Max;
+  // Every light is marked as changed
+  bool lights_rebuilt_ = true;
 
   std::shared_ptr<Texture> container_diffuse_;
   std::shared_ptr<Texture> container_specular_;
+
+  // Per-frame dynamic data for GPU
+  StreamBuffer stream_buffer_;
+
+  // Merged geometry of static entities
+  StaticBatcher static_batcher_;
+
+  DrawList draw_list_;
+  DrawList selected_draw_list_;
+  ui32 frame_draws_ = 0;
+  ui32 frame_draw_calls_ = 0;
+  bool use_indirect_draws_ = true;
+
+  // Fragments that pass depth test of the first pass that writes depth
+  SamplesPassedQuery overdraw_query_;
+  // Fragments per viewport pixel shaded without a depth pre-pass
+  float estimated_overdraw_ = 0.0f;
+  DepthPrePassMode depth_pre_pass_mode_ = DepthPrePassMode::Auto;
+  bool depth_pre_pass_ = false;
+
+  ShadingPath shading_path_ = ShadingPath::Forward;
+  GBuffer g_buffer_;
+  DeferredLighting deferred_lighting_;
+};
+
+namespace cppreflection {
+template <>
+struct TypeReflectionProvider<DepthPrePassMode> {
+  [[nodiscard]] inline constexpr static auto ReflectType() {
+    return cppreflection::StaticEnumTypeInfo<DepthPrePassMode>(
+               "DepthPrePassMode",
+               edt::GUID::Create("E2B7A4D1-6C39-4F0A-8B15-93D7C2E4F608"))
+        .Value(DepthPrePassMode::Off, "Off")
+        .Value(DepthPrePassMode::On, "On")
+        .Value(DepthPrePassMode::Auto, "Auto")
+        .Value(DepthPrePassMode::Max, "Max");
+  }
+};
+
+template <>
+struct TypeReflectionProvider<ShadingPath> {
+  [[nodiscard]] inline constexpr static auto ReflectType() {
+    return cppreflection::StaticEnumTypeInfo<ShadingPath>(
+               "ShadingPath",
+               edt::GUID::Create("7C4E91B2-3A58-4D06-9F21-B8E5D04A6C13"))
+        .Value(ShadingPath::Forward, "Forward")
+        .Value(ShadingPath::Deferred, "Deferred")
+        .Value(ShadingPath::Max, "Max");
+  }
 };
+}  // namespace cppreflection
@@ -2,6 +2,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <filesystem>
@@ -200,6 +201,9 @@ void Shader::Compile() {
   need_recompile_ = false;
 
   UpdateUniforms();
+  for (const auto& [name, binding] : uniform_block_bindings_) {
+    ApplyUniformBlockBinding(name, binding);
+  }
 }
 
 void Shader::DrawDetails() {
@@ -379,6 +383,29 @@ void Shader::SendUniforms() {
   }
 }
 
+void Shader::SetUniformBlockBinding(Name name, GLuint binding) {
+  ApplyUniformBlockBinding(name, binding);
+  auto it = std::ranges::find(uniform_block_bindings_, name,
+                              &std::pair<Name, GLuint>::first);
+  if (it != uniform_block_bindings_.end()) {
+    it->second = binding;
+  } else {
+    uniform_block_bindings_.emplace_back(name, binding);
+  }
+}
+
+void Shader::ApplyUniformBlockBinding(Name name, GLuint binding) const {
+  Check();
+  const auto block_index =
+      OpenGl::FindUniformBlockIndex(*program_, name.GetView().data());
+  [[unlikely]] if (!block_index) {
+    throw std::runtime_error(
+        fmt::format("Uniform block {} not found", name.GetView()));
+  }
+
+  OpenGl::UniformBlockBinding(*program_, *block_index, binding);
+}
+
 void Shader::SendUniform(UniformHandle& handle) {
   ShaderUniform& uniform = GetUniform(handle);
   uniform.SendValue();
@@ -390,7 +417,7 @@ void Shader::Check() const {
 
 void Shader::Destroy() {
   if (program_) {
-    glDeleteProgram(*program_);
+    OpenGl::DeleteProgram(*program_);
     program_.reset();
   }
 }
@@ -5,6 +5,7 @@
 #include <optional>
 #include <span>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "CppReflection/GetStaticTypeInfo.hpp"
@@ -48,6 +49,10 @@ class Shader {
   void SendUniforms();
   void SendUniform(UniformHandle&);
 
+  // Assigns uniform buffer binding point to a uniform block. Binding is kept
+  // when the shader gets recompiled.
+  void SetUniformBlockBinding(Name name, GLuint binding);
+
   template <typename T>
   const T& GetDefineValue(DefineHandle& handle) const;
   std::span<const ui8> GetDefineValue(DefineHandle& handle,
@@ -85,6 +90,7 @@ class Shader {
   void Check() const;
   void Destroy();
   void UpdateUniforms();
+  void ApplyUniformBlockBinding(Name name, GLuint binding) const;
 
  public:
   static std::filesystem::path shaders_dir_;
@@ -93,6 +99,7 @@ class Shader {
   std::filesystem::path path_;
   std::vector<ShaderDefine> defines_;
   std::vector<ShaderUniform> uniforms_;
+  std::vector<std::pair<Name, GLuint>> uniform_block_bindings_;
   std::optional<GLuint> program_;
   bool definitions_initialized_ : 1;
   bool need_recompile_ : 1;
@@ -15,7 +15,7 @@ ShaderDefine& ShaderDefine::operator=(ShaderDefine&& another) {
 }
 
 template <typename T>
-inline static const T& CastBuffer(const std::vector<ui8>& buffer) noexcept {
+inline static const T& CastBuffer(std::span<const ui8> buffer) noexcept {
   assert(buffer.size() == sizeof(T));
   return *reinterpret_cast<const T*>(buffer.data());
 }
@@ -7,6 +7,7 @@
 
 #include "EverydayTools/GUID.hpp"
 #include "integer.hpp"
+#include "memory/tagged_allocator.hpp"
 #include "name_cache/name.hpp"
 #include "nlohmann/json.hpp"
 
@@ -27,7 +28,7 @@ class ShaderDefine {
   ShaderDefine() = default;
 
  public:
-  std::vector<ui8> value;
+  std::vector<ui8, TaggedAllocator<ui8, MemoryTag::Shaders>> value;
   Name name;
   edt::GUID type_guid;
 };
@@ -32,8 +32,9 @@ struct ValueTypeHelper<SamplerUniform> {
       const auto texture_handle = v.texture->GetHandle();
 
       static_assert(GL_TEXTURE31 - GL_TEXTURE0 == 31);
-      glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + v.sampler_index));
-      glBindTexture(GL_TEXTURE_2D, texture_handle);
+      OpenGl::ActiveTexture(
+          static_cast<GLenum>(GL_TEXTURE0 + v.sampler_index));
+      OpenGl::BindTexture2d(texture_handle);
       glUniform1i(static_cast<GLint>(location),
                   static_cast<GLint>(v.sampler_index));
 
@@ -68,7 +69,11 @@ void ShaderUniform::MoveFrom(ShaderUniform& another) {
 void ShaderUniform::SendValue() const {
   CheckNotEmpty();
 
-  if (sent_) {
+  // Texture units are shared by all programs, so samplers bind their
+  // textures every time
+  constexpr edt::GUID sampler_type_guid =
+      cppreflection::GetStaticTypeInfo<SamplerUniform>().guid;
+  if (sent_ && type_guid_ != sampler_type_guid) {
     return;
   }
 
@@ -6,6 +6,7 @@
 
 #include "EverydayTools/GUID.hpp"
 #include "integer.hpp"
+#include "memory/tagged_allocator.hpp"
 #include "name_cache/name.hpp"
 
 class ShaderUniform {
@@ -40,7 +41,7 @@ class ShaderUniform {
   void CheckNotEmpty() const;
 
  private:
-  std::vector<ui8> value_;
+  std::vector<ui8, TaggedAllocator<ui8, MemoryTag::Shaders>> value_;
   Name name_;
   ui32 location_;
   edt::GUID type_guid_;
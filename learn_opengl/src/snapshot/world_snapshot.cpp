@@ -0,0 +1,605 @@
+#include "snapshot/world_snapshot.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "CppReflection/GetStaticTypeInfo.hpp"
+#include "CppReflection/TypeRegistry.hpp"
+#include "components/component.hpp"
+#include "entities/archetype.hpp"
+#include "entities/entity.hpp"
+#include "integer.hpp"
+#include "jobs/job_system.hpp"
+#include "mapped_file.hpp"
+#include "memory/memory.hpp"
+#include "reflection/eigen_reflect.hpp"
+#include "reflection/type_indices.hpp"
+#include "template/on_scope_leave.hpp"
+#include "world.hpp"
+
+namespace {
+// "WSNP" when read on a little-endian machine. Files of the other byte order
+// don't match and are rejected.
+constexpr ui32 kMagic = 0x504E5357;
+constexpr size_t kSectionAlignment = 16;
+constexpr ui32 kStaticEntityFlag = 1;
+
+static_assert(std::is_trivially_copyable_v<edt::GUID>);
+
+// Range of the strings section
+struct SnapshotString {
+  ui32 offset = 0;
+  ui32 size = 0;
+};
+
+// Offsets are from the beginning of the file and aligned to
+// kSectionAlignment
+struct SnapshotHeader {
+  ui32 magic = kMagic;
+  ui32 version = WorldSnapshot::kFormatVersion;
+  ui32 num_types = 0;
+  ui32 num_fields = 0;
+  ui32 num_archetypes = 0;
+  ui32 num_columns = 0;
+  ui32 num_arrays = 0;
+  ui32 padding = 0;
+  ui64 num_entities = 0;
+  ui64 types_offset = 0;
+  ui64 fields_offset = 0;
+  ui64 archetypes_offset = 0;
+  ui64 columns_offset = 0;
+  ui64 arrays_offset = 0;
+  ui64 entities_offset = 0;
+  ui64 strings_offset = 0;
+  ui64 strings_size = 0;
+};
+
+// Entity or component type with its flattened fields
+struct SnapshotType {
+  edt::GUID guid;
+  SnapshotString name;
+  ui32 first_field = 0;
+  ui32 num_fields = 0;
+};
+
+struct SnapshotField {
+  edt::GUID type;
+  SnapshotString path;
+  ui32 size = 0;
+  ui32 padding = 0;
+};
+
+// Entities of an archetype are consecutive
+struct SnapshotArchetype {
+  ui64 first_entity = 0;
+  ui64 num_entities = 0;
+  ui32 first_column = 0;
+  ui32 num_columns = 0;
+};
+
+// Offsets of arrays of the column are at first_array in the arrays table,
+// one for each field of the type. Array of a field keeps values of all
+// entities of the archetype.
+struct SnapshotColumn {
+  ui32 type = 0;
+  ui32 first_array = 0;
+};
+
+struct SnapshotEntity {
+  ui32 type = 0;
+  ui32 flags = 0;
+  SnapshotString name;
+};
+
+[[nodiscard]] constexpr size_t AlignUp(size_t value,
+                                       size_t alignment) noexcept {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename... Ts>
+[[nodiscard]] constexpr auto GetTypeGuids() noexcept {
+  return std::array{cppreflection::GetStaticTypeInfo<Ts>().guid...};
+}
+
+// Types without fields whose bytes can be copied as is. Anything else, like
+// strings, containers or smart pointers, would be saved as addresses and
+// loaded into live objects.
+constexpr auto kPlainLeafTypes =
+    GetTypeGuids<float, double, ui8, ui16, ui32, ui64, i8, i16, i32, i64,
+                 Eigen::Vector2f, Eigen::Vector3f, Eigen::Vector4f,
+                 Eigen::Matrix3f, Eigen::Matrix4f, Eigen::Quaternionf>();
+
+[[nodiscard]] bool IsPlainLeafType(const cppreflection::Type& type) noexcept {
+  return std::ranges::find(kPlainLeafTypes, type.GetGuid()) !=
+         kPlainLeafTypes.end();
+}
+
+// Reflected field of a plain type, see kPlainLeafTypes. Fields of other
+// types with no fields themselves are skipped on both save and load.
+struct FieldLeaf {
+  std::string path;
+  const cppreflection::Type* type = nullptr;
+  size_t offset = 0;
+  size_t size = 0;
+};
+
+void AppendLeaves(const cppreflection::Type& type, ui8* instance,
+                  size_t instance_offset, const std::string& prefix,
+                  std::vector<FieldLeaf>& leaves) {
+  for (const cppreflection::Field* field : type.GetFields()) {
+    const cppreflection::Type& field_type = *field->GetType();
+    auto* value = static_cast<ui8*>(field->GetValue(instance));
+    const size_t offset =
+        instance_offset + static_cast<size_t>(value - instance);
+    std::string path = prefix + std::string(field->GetName());
+    if (!field_type.GetFields().empty()) {
+      AppendLeaves(field_type, value, offset, path + '.', leaves);
+    } else if (IsPlainLeafType(field_type)) {
+      leaves.push_back(
+          {std::move(path), &field_type, offset, field_type.GetInstanceSize()});
+    } else {
+      spdlog::warn("Snapshot skips {} of {}: {} isn't plain data", path,
+                   type.GetName(), field_type.GetName());
+    }
+  }
+}
+
+// Reflection gives addresses of fields, so offsets are measured on a default
+// constructed instance
+[[nodiscard]] std::vector<FieldLeaf> CollectLeaves(
+    const cppreflection::Type& type) {
+  std::vector<FieldLeaf> leaves;
+  [[unlikely]] if (type.GetFields().empty()) { return leaves; }
+
+  void* instance = Memory::AlignedAlloc(type.GetInstanceSize(),
+                                        type.GetAlignment(), MemoryTag::Ecs);
+  [[unlikely]] if (!instance) { throw std::bad_alloc(); }
+  auto free_instance = OnScopeLeave([&]() { Memory::AlignedFree(instance); });
+  type.GetSpecialMembers().defaultConstructor(instance);
+  auto destroy_instance = OnScopeLeave(
+      [&]() { type.GetSpecialMembers().destructor(instance); });
+
+  AppendLeaves(type, static_cast<ui8*>(instance), 0, {}, leaves);
+  return leaves;
+}
+
+class SchemaCache {
+ public:
+  [[nodiscard]] const std::vector<FieldLeaf>& GetLeaves(
+      const cppreflection::Type& type) {
+    auto it = leaves_.find(&type);
+    [[unlikely]] if (it == leaves_.end()) {
+      it = leaves_.emplace(&type, CollectLeaves(type)).first;
+    }
+    return it->second;
+  }
+
+ private:
+  std::unordered_map<const cppreflection::Type*, std::vector<FieldLeaf>>
+      leaves_;
+};
+
+[[noreturn]] void ThrowCorrupted(const std::filesystem::path& path) {
+  throw std::runtime_error(
+      fmt::format("snapshot {} is truncated or corrupted", path.string()));
+}
+
+// Table of the file with bounds checked
+template <typename T>
+[[nodiscard]] std::span<const T> GetSection(
+    std::span<const ui8> file, ui64 offset, ui64 count,
+    const std::filesystem::path& path) {
+  [[unlikely]] if (offset % alignof(T) != 0 || offset > file.size() ||
+                   count > (file.size() - offset) / sizeof(T)) {
+    ThrowCorrupted(path);
+  }
+  return std::span(reinterpret_cast<const T*>(file.data() + offset),
+                   static_cast<size_t>(count));
+}
+
+[[nodiscard]] std::string_view GetString(std::span<const char> strings,
+                                         SnapshotString string,
+                                         const std::filesystem::path& path) {
+  [[unlikely]] if (string.offset > strings.size() ||
+                   string.size > strings.size() - string.offset) {
+    ThrowCorrupted(path);
+  }
+  return std::string_view(strings.data() + string.offset, string.size);
+}
+
+// Copies one field from the snapshot array into components
+struct FieldCopy {
+  const ui8* source = nullptr;
+  size_t offset = 0;
+  size_t size = 0;
+};
+
+struct ColumnLoad {
+  const cppreflection::Type* type = nullptr;
+  ui32 type_index = 0;
+  std::vector<FieldCopy> copies;
+};
+
+struct ArchetypeLoad {
+  const SnapshotArchetype* archetype = nullptr;
+  std::vector<const cppreflection::Type*> types;
+  std::vector<ColumnLoad> columns;
+};
+
+// Constructs components of consecutive rows of one chunk and copies the
+// snapshot fields into them
+void LoadRows(const Archetype& archetype, ArchetypeLocation location,
+              size_t count, size_t source_row,
+              std::span<const ColumnLoad> columns, ui32 version) {
+  for (const ColumnLoad& column_load : columns) {
+    const size_t column = *archetype.FindColumn(column_load.type_index);
+    const size_t stride = archetype.GetColumns()[column].stride;
+    auto* components =
+        static_cast<ui8*>(archetype.GetComponent(location, column));
+
+    const auto construct =
+        column_load.type->GetSpecialMembers().defaultConstructor;
+    for (size_t row = 0; row != count; ++row) {
+      construct(components + stride * row);
+    }
+
+    for (const FieldCopy& copy : column_load.copies) {
+      const ui8* source = copy.source + copy.size * source_row;
+      ui8* destination = components + copy.offset;
+      for (size_t row = 0; row != count; ++row) {
+        std::memcpy(destination + stride * row, source + copy.size * row,
+                    copy.size);
+      }
+    }
+
+    for (size_t row = 0; row != count; ++row) {
+      archetype.MarkChanged(
+          {location.chunk, location.row + static_cast<ui32>(row)}, column,
+          version);
+    }
+  }
+}
+}  // namespace
+
+void WorldSnapshot::Save(const World& world,
+                         const std::filesystem::path& path) {
+  cppreflection::TypeRegistry* type_registry = cppreflection::GetTypeRegistry();
+  SchemaCache schema;
+  std::vector<SnapshotType> types;
+  std::vector<SnapshotField> fields;
+  std::vector<SnapshotArchetype> archetypes;
+  std::vector<SnapshotColumn> columns;
+  std::vector<ui64> arrays;
+  std::vector<SnapshotEntity> entities;
+  std::string strings;
+  std::unordered_map<const cppreflection::Type*, ui32> type_ids;
+  // Arrays of fields, offsets are made absolute once tables are placed
+  std::vector<ui8> data;
+
+  auto add_string = [&](std::string_view string) {
+    [[unlikely]] if (strings.size() + string.size() >
+                     std::numeric_limits<ui32>::max()) {
+      throw std::runtime_error("Too many strings for a snapshot");
+    }
+    const SnapshotString result{static_cast<ui32>(strings.size()),
+                                static_cast<ui32>(string.size())};
+    strings.append(string);
+    return result;
+  };
+
+  auto add_type = [&](const cppreflection::Type& type) {
+    auto [it, inserted] =
+        type_ids.try_emplace(&type, static_cast<ui32>(types.size()));
+    [[likely]] if (!inserted) { return it->second; }
+
+    const std::vector<FieldLeaf>& leaves = schema.GetLeaves(type);
+    SnapshotType& snapshot_type = types.emplace_back();
+    snapshot_type.guid = type.GetGuid();
+    snapshot_type.name = add_string(type.GetName());
+    snapshot_type.first_field = static_cast<ui32>(fields.size());
+    snapshot_type.num_fields = static_cast<ui32>(leaves.size());
+    for (const FieldLeaf& leaf : leaves) {
+      SnapshotField& field = fields.emplace_back();
+      field.type = leaf.type->GetGuid();
+      field.path = add_string(leaf.path);
+      field.size = static_cast<ui32>(leaf.size);
+    }
+    return it->second;
+  };
+
+  for (const auto& archetype : world.archetypes_) {
+    [[unlikely]] if (archetype->GetSize() == 0) { continue; }
+
+    const std::span<const ArchetypeChunk> chunks = archetype->GetChunks();
+    const std::span<const ArchetypeColumn> archetype_columns =
+        archetype->GetColumns();
+    SnapshotArchetype& snapshot_archetype = archetypes.emplace_back();
+    snapshot_archetype.first_entity = entities.size();
+    snapshot_archetype.num_entities = archetype->GetSize();
+    snapshot_archetype.first_column = static_cast<ui32>(columns.size());
+    snapshot_archetype.num_columns =
+        static_cast<ui32>(archetype_columns.size());
+
+    for (const ArchetypeChunk& chunk : chunks) {
+      for (const Entity* entity : chunk.GetEntities()) {
+        const cppreflection::Type* entity_type =
+            type_registry->FindType(entity->GetTypeGUID());
+        entities.push_back(
+            {add_type(*entity_type),
+             entity->IsStatic() ? kStaticEntityFlag : 0,
+             add_string(entity->GetName())});
+      }
+    }
+
+    for (size_t column = 0; column != archetype_columns.size(); ++column) {
+      const ArchetypeColumn& archetype_column = archetype_columns[column];
+      columns.push_back({add_type(*archetype_column.type),
+                         static_cast<ui32>(arrays.size())});
+
+      for (const FieldLeaf& leaf : schema.GetLeaves(*archetype_column.type)) {
+        const size_t array_offset = AlignUp(data.size(), kSectionAlignment);
+        arrays.push_back(array_offset);
+        data.resize(array_offset + leaf.size * archetype->GetSize());
+
+        ui8* destination = data.data() + array_offset;
+        for (size_t chunk = 0; chunk != chunks.size(); ++chunk) {
+          const auto* components = static_cast<const ui8*>(
+              archetype->GetComponent({static_cast<ui32>(chunk), 0}, column));
+          for (size_t row = 0; row != chunks[chunk].GetSize(); ++row) {
+            std::memcpy(destination,
+                        components + archetype_column.stride * row +
+                            leaf.offset,
+                        leaf.size);
+            destination += leaf.size;
+          }
+        }
+      }
+    }
+  }
+
+  SnapshotHeader header;
+  header.num_types = static_cast<ui32>(types.size());
+  header.num_fields = static_cast<ui32>(fields.size());
+  header.num_archetypes = static_cast<ui32>(archetypes.size());
+  header.num_columns = static_cast<ui32>(columns.size());
+  header.num_arrays = static_cast<ui32>(arrays.size());
+  header.num_entities = entities.size();
+  header.strings_size = strings.size();
+
+  size_t offset = AlignUp(sizeof(SnapshotHeader), kSectionAlignment);
+  auto place = [&](ui64& section_offset, size_t size) {
+    section_offset = offset;
+    offset = AlignUp(offset + size, kSectionAlignment);
+  };
+  place(header.types_offset, std::span(types).size_bytes());
+  place(header.fields_offset, std::span(fields).size_bytes());
+  place(header.archetypes_offset, std::span(archetypes).size_bytes());
+  place(header.columns_offset, std::span(columns).size_bytes());
+  place(header.arrays_offset, std::span(arrays).size_bytes());
+  place(header.entities_offset, std::span(entities).size_bytes());
+  place(header.strings_offset, strings.size());
+  for (ui64& array_offset : arrays) {
+    array_offset += offset;
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  [[unlikely]] if (!file.is_open()) {
+    throw std::runtime_error(
+        fmt::format("failed to open file {}", path.string()));
+  }
+
+  // Sections are written in order of their offsets
+  size_t position = 0;
+  auto write = [&](ui64 section_offset, const void* bytes, size_t size) {
+    constexpr char zeros[kSectionAlignment]{};
+    file.write(zeros, static_cast<std::streamsize>(section_offset - position));
+    file.write(static_cast<const char*>(bytes),
+               static_cast<std::streamsize>(size));
+    position = section_offset + size;
+  };
+  write(0, &header, sizeof(header));
+  write(header.types_offset, types.data(), std::span(types).size_bytes());
+  write(header.fields_offset, fields.data(), std::span(fields).size_bytes());
+  write(header.archetypes_offset, archetypes.data(),
+        std::span(archetypes).size_bytes());
+  write(header.columns_offset, columns.data(),
+        std::span(columns).size_bytes());
+  write(header.arrays_offset, arrays.data(), std::span(arrays).size_bytes());
+  write(header.entities_offset, entities.data(),
+        std::span(entities).size_bytes());
+  write(header.strings_offset, strings.data(), strings.size());
+  write(offset, data.data(), data.size());
+
+  [[unlikely]] if (!file) {
+    throw std::runtime_error(
+        fmt::format("failed to write snapshot {}", path.string()));
+  }
+}
+
+size_t WorldSnapshot::Load(World& world, const std::filesystem::path& path) {
+  world.CheckStructuralChange();
+  const MappedFile mapped_file(path);
+  const std::span<const ui8> file = mapped_file.GetData();
+
+  SnapshotHeader header;
+  [[unlikely]] if (file.size() < sizeof(header)) { ThrowCorrupted(path); }
+  std::memcpy(&header, file.data(), sizeof(header));
+  [[unlikely]] if (header.magic != kMagic) {
+    throw std::runtime_error(
+        fmt::format("{} is not a world snapshot", path.string()));
+  }
+  [[unlikely]] if (header.version != kFormatVersion) {
+    throw std::runtime_error(
+        fmt::format("snapshot {} has format version {}, expected {}",
+                    path.string(), header.version, kFormatVersion));
+  }
+
+  const auto types = GetSection<SnapshotType>(file, header.types_offset,
+                                              header.num_types, path);
+  const auto fields = GetSection<SnapshotField>(file, header.fields_offset,
+                                                header.num_fields, path);
+  const auto archetypes = GetSection<SnapshotArchetype>(
+      file, header.archetypes_offset, header.num_archetypes, path);
+  const auto columns = GetSection<SnapshotColumn>(file, header.columns_offset,
+                                                  header.num_columns, path);
+  const auto arrays = GetSection<ui64>(file, header.arrays_offset,
+                                       header.num_arrays, path);
+  const auto entities = GetSection<SnapshotEntity>(
+      file, header.entities_offset, header.num_entities, path);
+  const auto strings = GetSection<char>(file, header.strings_offset,
+                                        header.strings_size, path);
+
+  // Everything is validated before the world is touched
+  cppreflection::TypeRegistry* type_registry = cppreflection::GetTypeRegistry();
+  constexpr edt::GUID entity_guid =
+      cppreflection::GetStaticTypeInfo<Entity>().guid;
+  constexpr edt::GUID component_guid =
+      cppreflection::GetStaticTypeInfo<Component>().guid;
+  std::vector<const cppreflection::Type*> resolved_types(types.size());
+  for (size_t i = 0; i != types.size(); ++i) {
+    const SnapshotType& type = types[i];
+    [[unlikely]] if (type.first_field > fields.size() ||
+                     type.num_fields > fields.size() - type.first_field) {
+      ThrowCorrupted(path);
+    }
+    resolved_types[i] = type_registry->FindType(type.guid);
+  }
+
+  for (const SnapshotEntity& entity : entities) {
+    [[unlikely]] if (entity.type >= types.size()) { ThrowCorrupted(path); }
+    const cppreflection::Type* type = resolved_types[entity.type];
+    [[unlikely]] if (!type || !type->IsA(entity_guid)) {
+      throw std::runtime_error(fmt::format(
+          "snapshot {} has entities of unknown type {}", path.string(),
+          GetString(strings, types[entity.type].name, path)));
+    }
+    (void)GetString(strings, entity.name, path);
+  }
+
+  SchemaCache schema;
+  TypeIndices& type_indices = TypeIndices::Get();
+  std::vector<ArchetypeLoad> loads;
+  loads.reserve(archetypes.size());
+  for (const SnapshotArchetype& archetype : archetypes) {
+    [[unlikely]] if (archetype.first_entity > entities.size() ||
+                     archetype.num_entities >
+                         entities.size() - archetype.first_entity ||
+                     archetype.first_column > columns.size() ||
+                     archetype.num_columns >
+                         columns.size() - archetype.first_column) {
+      ThrowCorrupted(path);
+    }
+
+    ArchetypeLoad& load = loads.emplace_back();
+    load.archetype = &archetype;
+    for (const SnapshotColumn& column :
+         columns.subspan(archetype.first_column, archetype.num_columns)) {
+      [[unlikely]] if (column.type >= types.size()) { ThrowCorrupted(path); }
+      const SnapshotType& stored_type = types[column.type];
+      const std::string_view type_name =
+          GetString(strings, stored_type.name, path);
+      [[unlikely]] if (column.first_array > arrays.size() ||
+                       stored_type.num_fields >
+                           arrays.size() - column.first_array) {
+        ThrowCorrupted(path);
+      }
+
+      const cppreflection::Type* type = resolved_types[column.type];
+      [[unlikely]] if (!type || !type->IsA(component_guid)) {
+        spdlog::warn("Snapshot {}: unknown component type {} is skipped",
+                     path.string(), type_name);
+        continue;
+      }
+
+      ColumnLoad& column_load = load.columns.emplace_back();
+      column_load.type = type;
+      column_load.type_index = type_indices.Register(*type);
+      load.types.push_back(type);
+
+      const std::vector<FieldLeaf>& leaves = schema.GetLeaves(*type);
+      for (ui32 i = 0; i != stored_type.num_fields; ++i) {
+        const SnapshotField& field = fields[stored_type.first_field + i];
+        const std::string_view field_path =
+            GetString(strings, field.path, path);
+        const ui64 array_offset = arrays[column.first_array + i];
+        [[unlikely]] if (array_offset > file.size() ||
+                         archetype.num_entities >
+                             (file.size() - array_offset) /
+                                 std::max<size_t>(field.size, 1)) {
+          ThrowCorrupted(path);
+        }
+
+        const auto leaf = std::ranges::find(leaves, field_path,
+                                            &FieldLeaf::path);
+        [[unlikely]] if (leaf == leaves.end() ||
+                         leaf->type->GetGuid() != field.type ||
+                         leaf->size != field.size) {
+          spdlog::warn("Snapshot {}: field {}.{} doesn't match the schema",
+                       path.string(), type_name, field_path);
+          continue;
+        }
+
+        column_load.copies.push_back(
+            {file.data() + array_offset, leaf->offset, leaf->size});
+      }
+    }
+
+    std::ranges::sort(load.types, {}, [&](const cppreflection::Type* type) {
+      return type_indices.Register(*type);
+    });
+    [[unlikely]] if (std::ranges::adjacent_find(load.types) !=
+                     load.types.end()) {
+      ThrowCorrupted(path);
+    }
+  }
+
+  // Entities are created one by one, then chunks are filled in parallel
+  world.ReserveEntities(entities.size());
+  const ui32 version = world.GetChangeVersion();
+  for (const ArchetypeLoad& load : loads) {
+    Archetype& archetype = world.FindOrCreateArchetype(load.types);
+    const size_t first_row = archetype.GetSize();
+    for (const SnapshotEntity& snapshot_entity :
+         entities.subspan(load.archetype->first_entity,
+                          load.archetype->num_entities)) {
+      Entity& entity =
+          world.CreateEntity(*resolved_types[snapshot_entity.type], archetype);
+      entity.SetName(GetString(strings, snapshot_entity.name, path));
+      entity.SetStatic((snapshot_entity.flags & kStaticEntityFlag) != 0);
+    }
+
+    // All chunks but the last one are full
+    const size_t capacity = archetype.GetChunkCapacity();
+    JobSystem::Get().ParallelFor(
+        0, load.archetype->num_entities, capacity,
+        [&](size_t first, size_t last) {
+          while (first != last) {
+            const size_t row = first_row + first;
+            const ArchetypeLocation location{
+                static_cast<ui32>(row / capacity),
+                static_cast<ui32>(row % capacity)};
+            const size_t count =
+                std::min(last - first, capacity - location.row);
+            LoadRows(archetype, location, count, first, load.columns, version);
+            first += count;
+          }
+        },
+        "LoadSnapshot");
+  }
+
+  return entities.size();
+}
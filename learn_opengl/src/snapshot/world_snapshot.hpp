@@ -0,0 +1,29 @@
+#pragma once
+
+#include <filesystem>
+
+#include "integer.hpp"
+
+class World;
+
+// Binary copy of entities and reflected fields of their components.
+//
+// Components are stored per archetype as one array per reflected field, so
+// loading maps the file and copies arrays into chunks without parsing.
+// Fields of nested reflected types are flattened into paths such as
+// "attenuation.linear". The file carries its schema: fields are matched by
+// path, type and size, so fields added since the snapshot was written keep
+// their default values and removed ones are skipped. Members which are not
+// reflected fields, like GPU resources of meshes or transform parents, are
+// default constructed.
+class WorldSnapshot {
+ public:
+  // Bumped whenever layout of the file itself changes
+  static constexpr ui32 kFormatVersion = 1;
+
+  static void Save(const World& world, const std::filesystem::path& path);
+
+  // Adds entities of the snapshot to the world and returns their number.
+  // The world is left unchanged if the file is not a valid snapshot.
+  static size_t Load(World& world, const std::filesystem::path& path);
+};
@@ -0,0 +1,211 @@
+#include "static_batching/static_batcher.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+#include "components/mesh_component.hpp"
+#include "components/transform_component.hpp"
+#include "entities/entity.hpp"
+#include "geometry/draw_list.hpp"
+#include "geometry/frustum.hpp"
+#include "world.hpp"
+
+namespace {
+// Edge of a grid cell that limits spatial extent of one batch
+constexpr float kBatchCellSize = 32.0f;
+constexpr size_t kMaxBatchVertices = size_t{1} << 20;
+}  // namespace
+
+StaticBatcher::StaticBatcher() = default;
+StaticBatcher::~StaticBatcher() { Clear(); }
+
+void StaticBatcher::Update(World& world) {
+  stats_.frame_drawn_batches = 0;
+  stats_.frame_culled_batches = 0;
+
+  [[unlikely]] if (!enabled_) { return; }
+
+  gathered_.clear();
+  Gather(world, gathered_);
+  [[unlikely]] if (SourcesChanged(gathered_)) {
+    std::swap(sources_, gathered_);
+    Rebuild();
+  }
+}
+
+void StaticBatcher::AddDraws(const Frustum& frustum, DrawList& draw_list) {
+  const Eigen::Matrix4f identity = Eigen::Matrix4f::Identity();
+  for (const StaticBatch& batch : batches_) {
+    if (!frustum.Intersects(batch.bounds)) {
+      ++stats_.frame_culled_batches;
+      continue;
+    }
+
+    draw_list.Add(batch.geometry, identity);
+    ++stats_.frame_drawn_batches;
+  }
+}
+
+bool StaticBatcher::AddEntityDraws(const Entity& entity,
+                                   DrawList& draw_list) const {
+  const Eigen::Matrix4f identity = Eigen::Matrix4f::Identity();
+  auto [begin, end] = entity_ranges_.equal_range(entity.GetHandle());
+  for (auto it = begin; it != end; ++it) {
+    const RangeLocation& location = it->second;
+    const StaticBatch& batch = batches_[location.batch_index];
+    const StaticBatchRange& range = batch.ranges[location.range_index];
+    draw_list.Add(batch.geometry, range.first_index, range.num_indices,
+                  identity);
+  }
+
+  return begin != end;
+}
+
+bool StaticBatcher::IsBatched(const Entity& entity) const noexcept {
+  return entity_ranges_.contains(entity.GetHandle());
+}
+
+void StaticBatcher::SetEnabled(bool enabled) noexcept {
+  enabled_ = enabled;
+  if (!enabled_) {
+    Clear();
+    sources_.clear();
+  }
+}
+
+void StaticBatcher::Gather(World& world, std::vector<SourceMesh>& sources) {
+  world.ForEachEntity([&](Entity& entity) {
+    if (!entity.IsStatic()) {
+      return;
+    }
+
+    // Render system uses the last transform of entity for all its meshes
+    const TransformComponent* transform = nullptr;
+    entity.ForEachComp<TransformComponent>(
+        [&](TransformComponent& component) { transform = &component; });
+
+    [[unlikely]] if (!transform) { return; }
+
+    entity.ForEachComp<MeshComponent>([&](MeshComponent& mesh) {
+      sources.push_back({entity.GetHandle(), &mesh, transform->GetWorld()});
+    });
+  });
+}
+
+bool StaticBatcher::SourcesChanged(
+    std::span<const SourceMesh> sources) const noexcept {
+  [[unlikely]] if (sources.size() != sources_.size()) { return true; }
+
+  for (size_t i = 0; i != sources.size(); ++i) {
+    const SourceMesh& a = sources[i];
+    const SourceMesh& b = sources_[i];
+    [[unlikely]] if (a.entity != b.entity || a.mesh != b.mesh ||
+                     a.transform != b.transform) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void StaticBatcher::Rebuild() {
+  const auto rebuild_start = std::chrono::steady_clock::now();
+  Clear();
+
+  // Group sources by shader and grid cell
+  using BatchKey = std::tuple<const Shader*, int, int, int>;
+  std::map<BatchKey, std::vector<size_t>> groups;
+  for (size_t i = 0; i != sources_.size(); ++i) {
+    const SourceMesh& source = sources_[i];
+    const Eigen::Vector3f cell =
+        (source.transform.block<3, 1>(0, 3) / kBatchCellSize)
+            .array()
+            .floor();
+    const BatchKey key{source.mesh->GetShader().get(),
+                       static_cast<int>(cell.x()), static_cast<int>(cell.y()),
+                       static_cast<int>(cell.z())};
+    groups[key].push_back(i);
+  }
+
+  std::vector<Vertex> mesh_vertices;
+  std::vector<ui32> mesh_indices;
+  std::vector<Vertex> vertices;
+  std::vector<ui32> indices;
+  StaticBatch batch;
+
+  auto flush_batch = [&]() {
+    [[unlikely]] if (indices.empty()) { return; }
+
+    batch.geometry = GeometryArena::Get().Allocate(vertices, indices);
+
+    const auto batch_index = static_cast<ui32>(batches_.size());
+    for (size_t i = 0; i != batch.ranges.size(); ++i) {
+      entity_ranges_.insert(
+          {batch.ranges[i].entity, {batch_index, static_cast<ui32>(i)}});
+    }
+
+    batches_.push_back(std::move(batch));
+    batch = StaticBatch{};
+    vertices.clear();
+    indices.clear();
+  };
+
+  for (const auto& [key, source_indices] : groups) {
+    for (const size_t source_index : source_indices) {
+      const SourceMesh& source = sources_[source_index];
+      source.mesh->ReadGeometry(mesh_vertices, mesh_indices);
+
+      if (vertices.size() + mesh_vertices.size() > kMaxBatchVertices) {
+        flush_batch();
+      }
+
+      batch.shader = source.mesh->GetShader();
+      const Eigen::Matrix3f normal_matrix =
+          source.transform.block<3, 3>(0, 0).inverse().transpose();
+
+      StaticBatchRange range;
+      range.entity = source.entity;
+      range.first_index = static_cast<ui32>(indices.size());
+      range.num_indices = static_cast<ui32>(mesh_indices.size());
+
+      const auto base_vertex = static_cast<ui32>(vertices.size());
+      for (Vertex vertex : mesh_vertices) {
+        vertex.position =
+            (source.transform * vertex.position.homogeneous()).head<3>();
+        vertex.normal = (normal_matrix * vertex.normal).normalized();
+        range.bounds.extend(vertex.position);
+        vertices.push_back(vertex);
+      }
+
+      for (const ui32 index : mesh_indices) {
+        indices.push_back(base_vertex + index);
+      }
+
+      batch.bounds.extend(range.bounds);
+      batch.ranges.push_back(range);
+    }
+
+    flush_batch();
+  }
+
+  const auto rebuild_end = std::chrono::steady_clock::now();
+  stats_.num_batches = static_cast<ui32>(batches_.size());
+  stats_.num_merged_meshes = static_cast<ui32>(sources_.size());
+  stats_.last_rebuild_ms =
+      std::chrono::duration<float, std::milli>(rebuild_end - rebuild_start)
+          .count();
+  ++stats_.num_rebuilds;
+}
+
+void StaticBatcher::Clear() {
+  for (const StaticBatch& batch : batches_) {
+    GeometryArena::Get().Free(batch.geometry);
+  }
+
+  batches_.clear();
+  entity_ranges_.clear();
+  stats_.num_batches = 0;
+  stats_.num_merged_meshes = 0;
+}
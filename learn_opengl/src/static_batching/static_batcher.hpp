@@ -0,0 +1,100 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "entities/entity_handle.hpp"
+#include "geometry/geometry_arena.hpp"
+#include "integer.hpp"
+#include "wrap/wrap_eigen.hpp"
+
+class DrawList;
+class Entity;
+class Frustum;
+class MeshComponent;
+class Shader;
+class World;
+
+// Part of a batch that came from one mesh of a static entity
+struct StaticBatchRange {
+  EntityHandle entity;
+  ui32 first_index = 0;
+  ui32 num_indices = 0;
+  Eigen::AlignedBox3f bounds;
+};
+
+// Geometry of several static meshes merged into one geometry arena range
+// with transforms applied to vertices
+struct StaticBatch {
+  std::shared_ptr<Shader> shader;
+  std::vector<StaticBatchRange> ranges;
+  Eigen::AlignedBox3f bounds;
+  GeometryAllocation geometry;
+};
+
+struct StaticBatchingStats {
+  ui32 num_batches = 0;
+  ui32 num_merged_meshes = 0;
+  ui32 num_rebuilds = 0;
+  ui32 frame_drawn_batches = 0;
+  ui32 frame_culled_batches = 0;
+  float last_rebuild_ms = 0.0f;
+};
+
+// Merges meshes of static entities which share a shader into batches.
+// Batches are split by a coarse spatial grid so that each of them can still
+// be culled as a whole. They are rebuilt once any static entity appears,
+// disappears or moves.
+class StaticBatcher {
+ public:
+  StaticBatcher();
+  StaticBatcher(const StaticBatcher&) = delete;
+  ~StaticBatcher();
+
+  void Update(World& world);
+
+  // Adds visible batches to the draw list
+  void AddDraws(const Frustum& frustum, DrawList& draw_list);
+
+  // Adds only ranges that belong to the entity. Returns false if the entity
+  // is not batched.
+  bool AddEntityDraws(const Entity& entity, DrawList& draw_list) const;
+
+  [[nodiscard]] bool IsBatched(const Entity& entity) const noexcept;
+
+  void SetEnabled(bool enabled) noexcept;
+  [[nodiscard]] bool IsEnabled() const noexcept { return enabled_; }
+  [[nodiscard]] const StaticBatchingStats& GetStats() const noexcept {
+    return stats_;
+  }
+
+  StaticBatcher& operator=(const StaticBatcher&) = delete;
+
+ private:
+  struct SourceMesh {
+    EntityHandle entity;
+    MeshComponent* mesh;
+    Eigen::Matrix4f transform;
+  };
+
+  struct RangeLocation {
+    ui32 batch_index;
+    ui32 range_index;
+  };
+
+  static void Gather(World& world, std::vector<SourceMesh>& sources);
+  [[nodiscard]] bool SourcesChanged(
+      std::span<const SourceMesh> sources) const noexcept;
+  void Rebuild();
+  void Clear();
+
+ private:
+  std::vector<StaticBatch> batches_;
+  std::vector<SourceMesh> sources_;
+  std::vector<SourceMesh> gathered_;
+  std::unordered_multimap<EntityHandle, RangeLocation> entity_ranges_;
+  StaticBatchingStats stats_;
+  bool enabled_ = true;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "integer.hpp"
+#include "reflection/type_indices.hpp"
+
+class World;
+
+// Component types a system touches. Systems that don't conflict run
+// concurrently.
+struct SystemAccess {
+  template <typename... Ts>
+  SystemAccess& Read() {
+    (reads.set(TypeIndices::IndexOf<Ts>()), ...);
+    return *this;
+  }
+
+  template <typename... Ts>
+  SystemAccess& Write() {
+    (writes.set(TypeIndices::IndexOf<Ts>()), ...);
+    return *this;
+  }
+
+  [[nodiscard]] bool ConflictsWith(const SystemAccess& other) const noexcept {
+    return structural || other.structural ||
+           (writes & (other.reads | other.writes)).any() ||
+           (reads & other.writes).any();
+  }
+
+  // Exact component types, same as queries
+  TypeMask reads;
+  TypeMask writes;
+  // Spawns or destroys entities or adds components directly, not through
+  // World::GetCommandBuffer. Runs alone.
+  bool structural = false;
+  // Uses GL or other state bound to the main thread
+  bool main_thread = false;
+};
+
+class System {
+ public:
+  virtual ~System() noexcept = default;
+
+  // Static string
+  [[nodiscard]] virtual const char* GetName() const noexcept = 0;
+
+  // Called once when the system is added to a scheduler
+  virtual void DeclareAccess(SystemAccess& access) const = 0;
+
+  virtual void Update(World& world, float delta_time) = 0;
+};
+
+#ifndef NDEBUG
+// Throws if the system which is being updated on this thread has not
+// declared the access. Called by world queries.
+void CheckComponentAccess(ui32 type_index, bool write);
+#endif
@@ -0,0 +1,203 @@
+#include "systems/system_scheduler.hpp"
+
+#include <fmt/format.h>
+
+#include <cassert>
+#include <chrono>
+#include <stdexcept>
+
+#include "jobs/job_system.hpp"
+#include "world.hpp"
+#include "wrap/wrap_imgui.h"
+
+#ifndef NDEBUG
+namespace {
+struct CurrentSystem {
+  const System* system = nullptr;
+  const SystemAccess* access = nullptr;
+};
+
+thread_local CurrentSystem t_current_system;
+}  // namespace
+
+void CheckComponentAccess(ui32 type_index, bool write) {
+  const CurrentSystem& current = t_current_system;
+  [[likely]] if (!current.access) { return; }
+
+  const bool allowed =
+      current.access->writes.test(type_index) ||
+      (!write && current.access->reads.test(type_index));
+  [[unlikely]] if (!allowed) {
+    throw std::logic_error(fmt::format(
+        "System {} {} {} without declaring it", current.system->GetName(),
+        write ? "writes" : "reads",
+        TypeIndices::Get().GetType(type_index)->GetName()));
+  }
+}
+#endif
+
+SystemScheduler::SystemScheduler() = default;
+SystemScheduler::~SystemScheduler() = default;
+
+System& SystemScheduler::AddSystem(std::unique_ptr<System> system) {
+  Node node;
+  system->DeclareAccess(node.access);
+  node.system = std::move(system);
+  nodes_.push_back(std::move(node));
+  graph_dirty_ = true;
+  return *nodes_.back().system;
+}
+
+void SystemScheduler::Update(World& world, float delta_time) {
+  assert(JobSystem::GetCurrentWorker() == JobSystem::kMainThreadWorker);
+  [[unlikely]] if (nodes_.empty()) { return; }
+
+  [[unlikely]] if (graph_dirty_) { BuildGraph(); }
+
+  for (size_t i = 0; i != nodes_.size(); ++i) {
+    remaining_[i].store(static_cast<ui32>(nodes_[i].predecessors.size()),
+                        std::memory_order_relaxed);
+    skip_[i].store(false, std::memory_order_relaxed);
+  }
+  error_ = nullptr;
+
+  JobCounter counter;
+  const FrameContext context{&world, delta_time, &counter};
+  for (const ui32 root : roots_) {
+    Launch(root, context);
+  }
+
+  JobSystem::Get().Wait(counter);
+  [[unlikely]] if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+  world.PlaybackCommands();
+}
+
+void SystemScheduler::DrawDetails() const {
+  for (const Node& node : nodes_) {
+    if (node.skipped) {
+      ImGui::Text("%s: skipped", node.system->GetName());
+    } else {
+      ImGui::Text("%s: %.3f ms", node.system->GetName(),
+                  static_cast<double>(node.last_update_ms));
+    }
+    for (const ui32 predecessor : node.predecessors) {
+      ImGui::BulletText("after %s",
+                        nodes_[predecessor].system->GetName());
+    }
+  }
+}
+
+void SystemScheduler::BuildGraph() {
+  roots_.clear();
+  for (Node& node : nodes_) {
+    node.predecessors.clear();
+    node.successors.clear();
+  }
+
+  for (ui32 i = 0; i != nodes_.size(); ++i) {
+    Node& node = nodes_[i];
+    for (ui32 j = 0; j != i; ++j) {
+      [[unlikely]] if (node.access.ConflictsWith(nodes_[j].access)) {
+        node.predecessors.push_back(j);
+        nodes_[j].successors.push_back(i);
+      }
+    }
+
+    if (node.predecessors.empty()) {
+      roots_.push_back(i);
+    }
+  }
+
+  remaining_ = std::make_unique<std::atomic<ui32>[]>(nodes_.size());
+  skip_ = std::make_unique<std::atomic<bool>[]>(nodes_.size());
+  graph_dirty_ = false;
+}
+
+void SystemScheduler::Launch(ui32 node_index, const FrameContext& context) {
+  const Node& node = nodes_[node_index];
+  Job job{[this, node_index, context] { Execute(node_index, context); },
+          context.counter, node.system->GetName()};
+  if (node.access.main_thread) {
+    JobSystem::Get().ScheduleOnMainThread(std::move(job));
+  } else {
+    JobSystem::Get().Schedule(std::move(job));
+  }
+}
+
+void SystemScheduler::Execute(ui32 node_index, const FrameContext& context) {
+  Node& node = nodes_[node_index];
+  node.skipped = skip_[node_index].load(std::memory_order_relaxed);
+  bool failed = node.skipped;
+  [[likely]] if (!node.skipped) {
+    try {
+      Run(node_index, context);
+    } catch (...) {
+      failed = true;
+      std::lock_guard lock(error_mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+
+  // Successors are released even after a failure so that the skip reaches
+  // the whole subgraph. Scheduled before this job completes, so the counter
+  // can't reach zero.
+  for (const ui32 successor : node.successors) {
+    [[unlikely]] if (failed) {
+      skip_[successor].store(true, std::memory_order_relaxed);
+    }
+    if (remaining_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      Launch(successor, context);
+    }
+  }
+}
+
+void SystemScheduler::Run(ui32 node_index, const FrameContext& context) {
+  Node& node = nodes_[node_index];
+  const auto start = std::chrono::steady_clock::now();
+
+#ifndef NDEBUG
+  BeginConflictCheck(node_index);
+  // The thread may run another system while this one waits for its jobs
+  const CurrentSystem previous =
+      std::exchange(t_current_system, {node.system.get(), &node.access});
+  try {
+    node.system->Update(*context.world, context.delta_time);
+  } catch (...) {
+    t_current_system = previous;
+    EndConflictCheck(node_index);
+    throw;
+  }
+  t_current_system = previous;
+  EndConflictCheck(node_index);
+#else
+  node.system->Update(*context.world, context.delta_time);
+#endif
+
+  node.last_update_ms = std::chrono::duration<float, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+}
+
+#ifndef NDEBUG
+void SystemScheduler::BeginConflictCheck(ui32 node_index) {
+  const Node& node = nodes_[node_index];
+  std::lock_guard lock(running_mutex_);
+  for (const ui32 running : running_) {
+    [[unlikely]] if (node.access.ConflictsWith(nodes_[running].access)) {
+      throw std::logic_error(fmt::format(
+          "Systems {} and {} conflict but run concurrently",
+          node.system->GetName(), nodes_[running].system->GetName()));
+    }
+  }
+  running_.push_back(node_index);
+}
+
+void SystemScheduler::EndConflictCheck(ui32 node_index) {
+  std::lock_guard lock(running_mutex_);
+  std::erase(running_, node_index);
+}
+#endif
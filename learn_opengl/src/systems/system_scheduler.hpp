@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "integer.hpp"
+#include "systems/system.hpp"
+
+class JobCounter;
+
+// Runs systems on the job system. Each system starts after every system
+// added before it that conflicts with it has finished, so the order of
+// AddSystem calls is the order of conflicting updates. Independent systems
+// run concurrently.
+class SystemScheduler {
+ public:
+  SystemScheduler();
+  SystemScheduler(const SystemScheduler&) = delete;
+  ~SystemScheduler();
+
+  System& AddSystem(std::unique_ptr<System> system);
+
+  template <typename T, typename... Args>
+  T& AddSystem(Args&&... args) {
+    return static_cast<T&>(
+        AddSystem(std::make_unique<T>(std::forward<Args>(args)...)));
+  }
+
+  // Must be called from the main thread. Systems which depend on a failed
+  // one, directly or not, are skipped for the frame. Independent systems
+  // still run, and the first exception is rethrown after they finish.
+  void Update(World& world, float delta_time);
+
+  void DrawDetails() const;
+
+  SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+ private:
+  struct Node {
+    std::unique_ptr<System> system;
+    SystemAccess access;
+    std::vector<ui32> predecessors;
+    std::vector<ui32> successors;
+    float last_update_ms = 0.0f;
+    // In the last frame, because a predecessor failed or was skipped
+    bool skipped = false;
+  };
+
+  struct FrameContext {
+    World* world;
+    float delta_time;
+    JobCounter* counter;
+  };
+
+  void BuildGraph();
+  void Launch(ui32 node_index, const FrameContext& context);
+  void Execute(ui32 node_index, const FrameContext& context);
+  void Run(ui32 node_index, const FrameContext& context);
+
+#ifndef NDEBUG
+  void BeginConflictCheck(ui32 node_index);
+  void EndConflictCheck(ui32 node_index);
+#endif
+
+ private:
+  std::vector<Node> nodes_;
+  std::vector<ui32> roots_;
+  // Unfinished predecessors of each node in the current frame
+  std::unique_ptr<std::atomic<ui32>[]> remaining_;
+  // Set when a predecessor failed or was skipped in the current frame
+  std::unique_ptr<std::atomic<bool>[]> skip_;
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+  bool graph_dirty_ = false;
+
+#ifndef NDEBUG
+  std::mutex running_mutex_;
+  std::vector<ui32> running_;
+#endif
+};
@@ -0,0 +1,229 @@
+#include "systems/transform_system.hpp"
+
+#include <fmt/format.h>
+
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+
+#include "components/transform_component.hpp"
+#include "entities/entity.hpp"
+#include "geometry/trs_batch.hpp"
+#include "jobs/job_system.hpp"
+#include "world.hpp"
+
+namespace {
+constexpr size_t kTransformsPerJob = 1024;
+// Depth of a transform whose parents are being classified
+constexpr ui32 kVisiting = ~ui32{0};
+}  // namespace
+
+void TransformSystem::DeclareAccess(SystemAccess& access) const {
+  access.Write<TransformComponent>();
+}
+
+void TransformSystem::Update(World& world, float) {
+  ++frame_;
+  const ui32 version = world.GetChangeVersion();
+  const ui64 hierarchy_version =
+      TransformComponent::hierarchy_version_.load(std::memory_order_relaxed);
+  [[unlikely]] if (world_ != &world ||
+                   structure_version_ != world.GetStructureVersion() ||
+                   hierarchy_version_ != hierarchy_version) {
+    Rebuild(world);
+    world_ = &world;
+    structure_version_ = world.GetStructureVersion();
+    hierarchy_version_ = hierarchy_version;
+    UpdateLevels(levels_, version);
+  } else {
+    CollectChanged(world);
+    UpdateLevels(changed_levels_, version);
+  }
+
+  // Writes later in this frame get the same version
+  seen_version_ = version - 1;
+}
+
+void TransformSystem::Rebuild(World& world) {
+  for (auto& level : levels_) {
+    level.clear();
+  }
+
+  world.ForEachChunk<TransformComponent>(
+      [&](const ArchetypeChunk& chunk,
+          std::span<TransformComponent> transforms) {
+        const auto column = static_cast<ui32>(
+            *chunk.GetArchetype().FindColumn(
+                TypeIndices::IndexOf<TransformComponent>()));
+        for (size_t row = 0; row != transforms.size(); ++row) {
+          Classify(world,
+                   {&transforms[row], &chunk, column, static_cast<ui32>(row)});
+        }
+      });
+
+  nodes_.clear();
+  for (const auto& level : levels_) {
+    for (const Node& node : level) {
+      node.transform->node_index_ = static_cast<ui32>(nodes_.size());
+      nodes_.push_back(node);
+    }
+  }
+
+  // Children of node i are children_[child_offsets_[i]..child_offsets_[i+1])
+  child_offsets_.assign(nodes_.size() + 1, 0);
+  for (const Node& node : nodes_) {
+    if (const TransformComponent* parent = node.transform->parent_transform_) {
+      ++child_offsets_[parent->node_index_ + 1];
+    }
+  }
+  for (size_t i = 1; i != child_offsets_.size(); ++i) {
+    child_offsets_[i] += child_offsets_[i - 1];
+  }
+  children_.resize(nodes_.size());
+  std::vector<ui32> next_child(child_offsets_.begin(),
+                               std::prev(child_offsets_.end()));
+  for (ui32 i = 0; i != nodes_.size(); ++i) {
+    const TransformComponent* parent = nodes_[i].transform->parent_transform_;
+    if (parent) {
+      children_[next_child[parent->node_index_]++] = i;
+    }
+  }
+
+  changed_levels_.resize(levels_.size());
+}
+
+void TransformSystem::CollectChanged(World& world) {
+  for (auto& level : changed_levels_) {
+    level.clear();
+  }
+
+  world.ForEachChunkChangedSince<TransformComponent>(
+      seen_version_,
+      [&](const ArchetypeChunk&, std::span<TransformComponent> transforms) {
+        for (const TransformComponent& transform : transforms) {
+          [[unlikely]] if (transform.dirty_) {
+            AddSubtree(transform.node_index_);
+          }
+        }
+      });
+}
+
+void TransformSystem::AddSubtree(ui32 node_index) {
+  thread_local std::vector<ui32> stack;
+  stack.assign(1, node_index);
+  while (!stack.empty()) {
+    const ui32 index = stack.back();
+    stack.pop_back();
+    const Node& node = nodes_[index];
+    TransformComponent& transform = *node.transform;
+    // Already added as a descendant of another dirty transform
+    [[unlikely]] if (transform.visited_frame_ == frame_) { continue; }
+
+    transform.visited_frame_ = frame_;
+    changed_levels_[transform.depth_].push_back(node);
+    stack.insert(stack.end(), children_.begin() + child_offsets_[index],
+                 children_.begin() + child_offsets_[index + 1]);
+  }
+}
+
+void TransformSystem::UpdateLevels(std::span<const std::vector<Node>> levels,
+                                   ui32 version) {
+  // Parents are complete before children read them
+  for (const auto& level : levels) {
+    JobSystem::Get().ParallelFor(
+        0, level.size(), kTransformsPerJob,
+        [&](size_t first, size_t last) {
+          UpdateRange(level, first, last, version);
+        },
+        "UpdateTransforms");
+  }
+}
+
+void TransformSystem::UpdateRange(std::span<const Node> level, size_t first,
+                                  size_t last, ui32 version) {
+  // Changed transforms are packed for the batch conversion
+  thread_local std::vector<const Node*> changed;
+  thread_local TrsBatch batch;
+  thread_local std::vector<Eigen::Matrix4f> locals;
+  changed.clear();
+  batch.Clear();
+
+  for (size_t i = first; i != last; ++i) {
+    TransformComponent& t = *level[i].transform;
+    const TransformComponent* parent = t.parent_transform_;
+    t.world_changed_ = t.dirty_ || (parent && parent->world_changed_);
+    [[unlikely]] if (t.world_changed_) {
+      changed.push_back(&level[i]);
+      batch.Add(t.rotation, t.translation, t.scale);
+    }
+  }
+
+  [[likely]] if (changed.empty()) { return; }
+
+  locals.resize(changed.size());
+  batch.ComputeMatrices(locals);
+  for (size_t i = 0; i != changed.size(); ++i) {
+    const Node& node = *changed[i];
+    TransformComponent& t = *node.transform;
+    if (const TransformComponent* parent = t.parent_transform_) {
+      t.world_.noalias() = parent->world_ * locals[i];
+    } else {
+      t.world_ = locals[i];
+    }
+    t.dirty_ = false;
+    node.chunk->MarkChanged(node.column, node.row, version);
+  }
+}
+
+ui32 TransformSystem::Classify(World& world, const Node& node) {
+  TransformComponent& transform = *node.transform;
+  [[likely]] if (transform.visited_frame_ == frame_) {
+    [[unlikely]] if (transform.depth_ == kVisiting) {
+      throw std::runtime_error("Transform hierarchy has a cycle");
+    }
+    return transform.depth_;
+  }
+
+  transform.visited_frame_ = frame_;
+  transform.depth_ = kVisiting;
+
+  std::optional<Node> parent;
+  if (transform.parent_.IsValid()) {
+    parent = FindNode(world, transform.parent_);
+  }
+
+  const ui32 depth = parent ? Classify(world, *parent) + 1 : 0;
+  const TransformComponent* parent_transform =
+      parent ? parent->transform : nullptr;
+
+  // Parent was destroyed, replaced or moved in memory
+  [[unlikely]] if (transform.parent_transform_ != parent_transform) {
+    transform.dirty_ = true;
+  }
+
+  transform.parent_transform_ = parent_transform;
+  transform.depth_ = depth;
+  [[unlikely]] if (depth >= levels_.size()) { levels_.resize(depth + 1); }
+  levels_[depth].push_back(node);
+  return depth;
+}
+
+std::optional<TransformSystem::Node> TransformSystem::FindNode(
+    World& world, EntityHandle handle) {
+  const Entity* entity = world.GetEntity(handle);
+  [[unlikely]] if (!entity) { return std::nullopt; }
+
+  const Archetype& archetype = *entity->GetArchetype();
+  const auto column = archetype.FindColumn(
+      TypeIndices::IndexOf<TransformComponent>());
+  [[unlikely]] if (!column) { return std::nullopt; }
+
+  const ArchetypeLocation location = entity->GetLocation();
+  Node node;
+  node.transform = reinterpret_cast<TransformComponent*>(
+      archetype.GetComponent(location, *column));
+  node.chunk = &archetype.GetChunks()[location.chunk];
+  node.column = static_cast<ui32>(*column);
+  node.row = location.row;
+  return node;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "entities/entity_handle.hpp"
+#include "integer.hpp"
+#include "systems/system.hpp"
+
+class ArchetypeChunk;
+class TransformComponent;
+
+// Updates cached world matrices. Transforms are grouped by depth in the
+// hierarchy and levels are processed from the roots down; transforms of one
+// level are independent and are updated in parallel. The hierarchy is cached
+// and rebuilt only when the world structure or a parent changes. Otherwise
+// dirty transforms are looked up in chunks with changed transforms, and
+// only they and their descendants are visited. Local matrices of a range
+// are converted from TRS in SIMD batches. Recomputed transforms are marked
+// as changed.
+class TransformSystem : public System {
+ public:
+  [[nodiscard]] const char* GetName() const noexcept override {
+    return "Transforms";
+  }
+
+  void DeclareAccess(SystemAccess& access) const override;
+  void Update(World& world, float delta_time) override;
+
+ private:
+  struct Node {
+    TransformComponent* transform;
+    // Where the change version of the transform is stored
+    const ArchetypeChunk* chunk;
+    ui32 column;
+    ui32 row;
+  };
+
+  void Rebuild(World& world);
+  void CollectChanged(World& world);
+  void AddSubtree(ui32 node_index);
+  static void UpdateLevels(std::span<const std::vector<Node>> levels,
+                           ui32 version);
+  ui32 Classify(World& world, const Node& node);
+  [[nodiscard]] static std::optional<Node> FindNode(World& world,
+                                                    EntityHandle handle);
+  // Changed transforms get the version
+  static void UpdateRange(std::span<const Node> level, size_t first,
+                          size_t last, ui32 version);
+
+ private:
+  // Cached hierarchy, valid for the versions below. All transforms by
+  // depth, the same flattened, and children of each flattened node.
+  std::vector<std::vector<Node>> levels_;
+  std::vector<Node> nodes_;
+  std::vector<ui32> child_offsets_;
+  std::vector<ui32> children_;
+  const World* world_ = nullptr;
+  ui64 structure_version_ = 0;
+  ui64 hierarchy_version_ = 0;
+  // Transforms to update in the current frame by depth
+  std::vector<std::vector<Node>> changed_levels_;
+  // Writes up to this version were seen by the last update
+  ui32 seen_version_ = 0;
+  ui64 frame_ = 0;
+};
@@ -0,0 +1,323 @@
+#include "texture/block_decoder.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+using Texels = std::span<ui8, 64>;
+
+[[nodiscard]] constexpr ui8 Clamp8(int value) noexcept {
+  return static_cast<ui8>(std::clamp(value, 0, 255));
+}
+
+[[nodiscard]] constexpr ui8 Expand(ui32 value, ui32 bits) noexcept {
+  value <<= 8 - bits;
+  return static_cast<ui8>(value | (value >> bits));
+}
+
+[[nodiscard]] ui64 ReadLittleEndian64(const ui8* bytes) noexcept {
+  ui64 value = 0;
+  for (size_t i = 0; i != 8; ++i) {
+    value |= ui64{bytes[i]} << (8 * i);
+  }
+  return value;
+}
+
+[[nodiscard]] ui64 ReadBigEndian64(const ui8* bytes) noexcept {
+  ui64 value = 0;
+  for (size_t i = 0; i != 8; ++i) {
+    value = (value << 8) | bytes[i];
+  }
+  return value;
+}
+
+// Color part of BC1-BC3. Three color mode with transparent black is only
+// available in BC1.
+void DecodeBc1Colors(const ui8* block, bool allow_three_colors,
+                     Texels texels) noexcept {
+  const ui32 c0 = block[0] | (ui32{block[1]} << 8);
+  const ui32 c1 = block[2] | (ui32{block[3]} << 8);
+
+  auto unpack = [](ui32 c) {
+    return std::array<int, 4>{Expand(c >> 11, 5), Expand((c >> 5) & 63, 6),
+                              Expand(c & 31, 5), 255};
+  };
+  std::array<std::array<int, 4>, 4> palette{unpack(c0), unpack(c1)};
+  for (size_t channel = 0; channel != 3; ++channel) {
+    const int a = palette[0][channel];
+    const int b = palette[1][channel];
+    if (c0 > c1 || !allow_three_colors) {
+      palette[2][channel] = (2 * a + b) / 3;
+      palette[3][channel] = (a + 2 * b) / 3;
+    } else {
+      palette[2][channel] = (a + b) / 2;
+      palette[3][channel] = 0;
+    }
+  }
+  palette[2][3] = 255;
+  palette[3][3] = c0 > c1 || !allow_three_colors ? 255 : 0;
+
+  const ui32 indices = block[4] | (ui32{block[5]} << 8) |
+                       (ui32{block[6]} << 16) | (ui32{block[7]} << 24);
+  for (size_t i = 0; i != 16; ++i) {
+    const auto& color = palette[(indices >> (2 * i)) & 3];
+    for (size_t channel = 0; channel != 4; ++channel) {
+      texels[i * 4 + channel] = static_cast<ui8>(color[channel]);
+    }
+  }
+}
+
+// Single channel block of BC3 alpha, BC4 and BC5
+void DecodeBc4Channel(const ui8* block, size_t channel,
+                      Texels texels) noexcept {
+  const int a = block[0];
+  const int b = block[1];
+  std::array<int, 8> palette{a, b};
+  if (a > b) {
+    for (int i = 2; i != 8; ++i) {
+      palette[static_cast<size_t>(i)] = ((8 - i) * a + (i - 1) * b) / 7;
+    }
+  } else {
+    for (int i = 2; i != 6; ++i) {
+      palette[static_cast<size_t>(i)] = ((6 - i) * a + (i - 1) * b) / 5;
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+
+  const ui64 indices = ReadLittleEndian64(block) >> 16;
+  for (size_t i = 0; i != 16; ++i) {
+    texels[i * 4 + channel] =
+        static_cast<ui8>(palette[(indices >> (3 * i)) & 7]);
+  }
+}
+
+constexpr std::array<std::array<int, 4>, 8> kEtcModifiers{
+    {{2, 8, -2, -8},
+     {5, 17, -5, -17},
+     {9, 29, -9, -29},
+     {13, 42, -13, -42},
+     {18, 60, -18, -60},
+     {24, 80, -24, -80},
+     {33, 106, -33, -106},
+     {47, 183, -47, -183}}};
+
+constexpr std::array<int, 8> kEtcDistances{3, 6, 11, 16, 23, 32, 41, 64};
+
+constexpr std::array<std::array<int, 8>, 16> kEacModifiers{
+    {{-3, -6, -9, -15, 2, 5, 8, 14},
+     {-3, -7, -10, -13, 2, 6, 9, 12},
+     {-2, -5, -8, -13, 1, 4, 7, 12},
+     {-2, -4, -6, -13, 1, 3, 5, 12},
+     {-3, -6, -8, -12, 2, 5, 7, 11},
+     {-3, -7, -9, -11, 2, 6, 8, 10},
+     {-4, -7, -8, -11, 3, 6, 7, 10},
+     {-3, -5, -8, -11, 2, 4, 7, 10},
+     {-2, -6, -8, -10, 1, 5, 7, 9},
+     {-2, -5, -8, -10, 1, 4, 7, 9},
+     {-2, -4, -8, -10, 1, 3, 7, 9},
+     {-2, -5, -7, -10, 1, 4, 6, 9},
+     {-3, -4, -7, -10, 2, 3, 6, 9},
+     {-1, -2, -3, -10, 0, 1, 2, 9},
+     {-4, -6, -8, -9, 3, 5, 7, 8},
+     {-3, -5, -7, -9, 2, 4, 6, 8}}};
+
+using Color = std::array<int, 3>;
+
+void SetColor(Texels texels, size_t x, size_t y, const Color& color) noexcept {
+  ui8* texel = &texels[(y * 4 + x) * 4];
+  for (size_t channel = 0; channel != 3; ++channel) {
+    texel[channel] = Clamp8(color[channel]);
+  }
+  texel[3] = 255;
+}
+
+[[nodiscard]] Color Offset(const Color& color, int offset) noexcept {
+  return {color[0] + offset, color[1] + offset, color[2] + offset};
+}
+
+// Two bit index of texel x, y. Texels are numbered in columns.
+[[nodiscard]] constexpr size_t GetEtcIndex(ui64 bits, size_t x,
+                                           size_t y) noexcept {
+  const size_t i = x * 4 + y;
+  return static_cast<size_t>((((bits >> (i + 16)) & 1) << 1) |
+                             ((bits >> i) & 1));
+}
+
+void DecodeEtcPaint(ui64 bits, const std::array<Color, 4>& paint,
+                    Texels texels) noexcept {
+  for (size_t y = 0; y != 4; ++y) {
+    for (size_t x = 0; x != 4; ++x) {
+      SetColor(texels, x, y, paint[GetEtcIndex(bits, x, y)]);
+    }
+  }
+}
+
+[[nodiscard]] constexpr ui32 GetBits(ui64 bits, ui32 first,
+                                     ui32 count) noexcept {
+  return static_cast<ui32>((bits >> first) & ((ui64{1} << count) - 1));
+}
+
+void DecodeEtcT(ui64 bits, Texels texels) noexcept {
+  const Color c1{Expand((GetBits(bits, 59, 2) << 2) | GetBits(bits, 56, 2), 4),
+                 Expand(GetBits(bits, 52, 4), 4),
+                 Expand(GetBits(bits, 48, 4), 4)};
+  const Color c2{Expand(GetBits(bits, 44, 4), 4),
+                 Expand(GetBits(bits, 40, 4), 4),
+                 Expand(GetBits(bits, 36, 4), 4)};
+  const int d =
+      kEtcDistances[(GetBits(bits, 34, 2) << 1) | GetBits(bits, 32, 1)];
+  DecodeEtcPaint(bits, {c1, Offset(c2, d), c2, Offset(c2, -d)}, texels);
+}
+
+void DecodeEtcH(ui64 bits, Texels texels) noexcept {
+  const ui32 r1 = GetBits(bits, 59, 4);
+  const ui32 g1 = (GetBits(bits, 56, 3) << 1) | GetBits(bits, 52, 1);
+  const ui32 b1 = (GetBits(bits, 51, 1) << 3) | GetBits(bits, 47, 3);
+  const ui32 r2 = GetBits(bits, 43, 4);
+  const ui32 g2 = GetBits(bits, 39, 4);
+  const ui32 b2 = GetBits(bits, 35, 4);
+  const bool first_greater = ((r1 << 8) | (g1 << 4) | b1) >=
+                             ((r2 << 8) | (g2 << 4) | b2);
+  const int d = kEtcDistances[(GetBits(bits, 34, 1) << 2) |
+                              (GetBits(bits, 32, 1) << 1) |
+                              (first_greater ? 1 : 0)];
+
+  const Color c1{Expand(r1, 4), Expand(g1, 4), Expand(b1, 4)};
+  const Color c2{Expand(r2, 4), Expand(g2, 4), Expand(b2, 4)};
+  DecodeEtcPaint(bits,
+                 {Offset(c1, d), Offset(c1, -d), Offset(c2, d), Offset(c2, -d)},
+                 texels);
+}
+
+void DecodeEtcPlanar(ui64 bits, Texels texels) noexcept {
+  const Color o{
+      Expand(GetBits(bits, 57, 6), 6),
+      Expand((GetBits(bits, 56, 1) << 6) | GetBits(bits, 49, 6), 7),
+      Expand((GetBits(bits, 48, 1) << 5) | (GetBits(bits, 43, 2) << 3) |
+                 GetBits(bits, 39, 3),
+             6)};
+  const Color h{Expand((GetBits(bits, 34, 5) << 1) | GetBits(bits, 32, 1), 6),
+                Expand(GetBits(bits, 25, 7), 7),
+                Expand(GetBits(bits, 19, 6), 6)};
+  const Color v{Expand(GetBits(bits, 13, 6), 6), Expand(GetBits(bits, 6, 7), 7),
+                Expand(GetBits(bits, 0, 6), 6)};
+
+  for (size_t y = 0; y != 4; ++y) {
+    for (size_t x = 0; x != 4; ++x) {
+      const auto ix = static_cast<int>(x);
+      const auto iy = static_cast<int>(y);
+      Color color;
+      for (size_t c = 0; c != 3; ++c) {
+        color[c] =
+            (ix * (h[c] - o[c]) + iy * (v[c] - o[c]) + 4 * o[c] + 2) >> 2;
+      }
+      SetColor(texels, x, y, color);
+    }
+  }
+}
+
+void DecodeEtc2Rgb(const ui8* block, Texels texels) noexcept {
+  const ui64 bits = ReadBigEndian64(block);
+  std::array<Color, 2> base;
+  if (GetBits(bits, 33, 1) == 0) {
+    // Individual mode: two 4-bit colors
+    for (size_t c = 0; c != 3; ++c) {
+      const auto first = static_cast<ui32>(60 - 8 * c);
+      base[0][c] = Expand(GetBits(bits, first, 4), 4);
+      base[1][c] = Expand(GetBits(bits, first - 4, 4), 4);
+    }
+  } else {
+    // Differential mode, overflows of the sum select the ETC2 modes
+    std::array<int, 3> sums;
+    for (size_t c = 0; c != 3; ++c) {
+      const auto first = static_cast<ui32>(59 - 8 * c);
+      const auto color = static_cast<int>(GetBits(bits, first, 5));
+      const int delta =
+          static_cast<int>(GetBits(bits, first - 3, 3) ^ 4) - 4;
+      sums[c] = color + delta;
+      base[0][c] = Expand(static_cast<ui32>(color), 5);
+    }
+    [[unlikely]] if (sums[0] < 0 || sums[0] > 31) {
+      DecodeEtcT(bits, texels);
+      return;
+    }
+    [[unlikely]] if (sums[1] < 0 || sums[1] > 31) {
+      DecodeEtcH(bits, texels);
+      return;
+    }
+    [[unlikely]] if (sums[2] < 0 || sums[2] > 31) {
+      DecodeEtcPlanar(bits, texels);
+      return;
+    }
+    for (size_t c = 0; c != 3; ++c) {
+      base[1][c] = Expand(static_cast<ui32>(sums[c]), 5);
+    }
+  }
+
+  const std::array<ui32, 2> tables{GetBits(bits, 37, 3), GetBits(bits, 34, 3)};
+  const bool flip = GetBits(bits, 32, 1) != 0;
+  for (size_t y = 0; y != 4; ++y) {
+    for (size_t x = 0; x != 4; ++x) {
+      const size_t subblock = flip ? y / 2 : x / 2;
+      const int modifier =
+          kEtcModifiers[tables[subblock]][GetEtcIndex(bits, x, y)];
+      SetColor(texels, x, y, Offset(base[subblock], modifier));
+    }
+  }
+}
+
+void DecodeEacAlpha(const ui8* block, Texels texels) noexcept {
+  const ui64 bits = ReadBigEndian64(block);
+  const auto base = static_cast<int>(GetBits(bits, 56, 8));
+  const auto multiplier = static_cast<int>(GetBits(bits, 52, 4));
+  const auto& modifiers = kEacModifiers[GetBits(bits, 48, 4)];
+  for (size_t x = 0; x != 4; ++x) {
+    for (size_t y = 0; y != 4; ++y) {
+      // The first texel is in the highest bits
+      const auto shift = static_cast<ui32>(45 - 3 * (x * 4 + y));
+      const int modifier = modifiers[GetBits(bits, shift, 3)];
+      texels[(y * 4 + x) * 4 + 3] = Clamp8(base + modifier * multiplier);
+    }
+  }
+}
+}  // namespace
+
+bool DecodeBlock(CompressedFormat format, std::span<const ui8> block,
+                 Texels texels) noexcept {
+  [[unlikely]] if (block.size() < GetBlockSize(format)) { return false; }
+
+  switch (format) {
+    case CompressedFormat::BC1:
+      DecodeBc1Colors(block.data(), true, texels);
+      return true;
+    case CompressedFormat::BC3:
+      DecodeBc1Colors(block.data() + 8, false, texels);
+      DecodeBc4Channel(block.data(), 3, texels);
+      return true;
+    case CompressedFormat::BC4:
+    case CompressedFormat::BC5:
+      std::ranges::fill(texels, ui8{0});
+      DecodeBc4Channel(block.data(), 0, texels);
+      if (format == CompressedFormat::BC5) {
+        DecodeBc4Channel(block.data() + 8, 1, texels);
+      }
+      for (size_t i = 0; i != 16; ++i) {
+        texels[i * 4 + 3] = 255;
+      }
+      return true;
+    case CompressedFormat::Etc2Rgb8:
+      DecodeEtc2Rgb(block.data(), texels);
+      return true;
+    case CompressedFormat::Etc2Rgba8:
+      DecodeEtc2Rgb(block.data() + 8, texels);
+      DecodeEacAlpha(block.data(), texels);
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool HasBlockDecoder(CompressedFormat format) noexcept {
+  return format != CompressedFormat::BC7 && format != CompressedFormat::Max;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <span>
+
+#include "integer.hpp"
+#include "texture/compressed_format.hpp"
+
+// Fallback for block formats the driver doesn't accept. Decodes one 4x4
+// block into RGBA8 texels in row-major order. Returns false for formats
+// without a CPU decoder (BC7).
+[[nodiscard]] bool DecodeBlock(CompressedFormat format,
+                               std::span<const ui8> block,
+                               std::span<ui8, 64> texels) noexcept;
+
+[[nodiscard]] bool HasBlockDecoder(CompressedFormat format) noexcept;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <bitset>
+
+#include "integer.hpp"
+#include "opengl/gl_api.hpp"
+
+// Block compressed formats of 4x4 texel blocks. sRGB variants in files are
+// loaded as their linear counterparts, like uncompressed images.
+enum class CompressedFormat : ui8 {
+  BC1,
+  BC3,
+  BC4,
+  BC5,
+  BC7,
+  Etc2Rgb8,
+  Etc2Rgba8,
+  Max
+};
+
+inline constexpr size_t kNumCompressedFormats =
+    static_cast<size_t>(CompressedFormat::Max);
+
+// Bytes per 4x4 block
+[[nodiscard]] constexpr size_t GetBlockSize(CompressedFormat format) noexcept {
+  switch (format) {
+    case CompressedFormat::BC1:
+    case CompressedFormat::BC4:
+    case CompressedFormat::Etc2Rgb8:
+      return 8;
+    default:
+      return 16;
+  }
+}
+
+[[nodiscard]] constexpr GLenum GetGlFormat(CompressedFormat format) noexcept {
+  switch (format) {
+    case CompressedFormat::BC1:
+      return kGlCompressedRgbaS3tcDxt1;
+    case CompressedFormat::BC3:
+      return kGlCompressedRgbaS3tcDxt5;
+    case CompressedFormat::BC4:
+      return GL_COMPRESSED_RED_RGTC1;
+    case CompressedFormat::BC5:
+      return GL_COMPRESSED_RG_RGTC2;
+    case CompressedFormat::BC7:
+      return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    case CompressedFormat::Etc2Rgb8:
+      return GL_COMPRESSED_RGB8_ETC2;
+    case CompressedFormat::Etc2Rgba8:
+      return GL_COMPRESSED_RGBA8_ETC2_EAC;
+    default:
+      return GL_NONE;
+  }
+}
+
+using CompressedFormatSet = std::bitset<kNumCompressedFormats>;
+
+// Formats the driver accepts. Needs the GL context.
+[[nodiscard]] inline CompressedFormatSet GetSupportedCompressedFormats() {
+  CompressedFormatSet formats;
+  for (size_t i = 0; i != kNumCompressedFormats; ++i) {
+    const GLenum format = GetGlFormat(static_cast<CompressedFormat>(i));
+    formats[i] = OpenGl::SupportsCompressedFormat(format);
+  }
+  return formats;
+}
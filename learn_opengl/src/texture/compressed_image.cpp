@@ -0,0 +1,284 @@
+#include "texture/compressed_image.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+#include "fmt/format.h"
+#include "read_file.hpp"
+#include "texture/block_decoder.hpp"
+
+namespace {
+constexpr std::array<ui8, 12> kKtx2Identifier{
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+constexpr size_t kKtx2HeaderSize = 80;
+constexpr size_t kKtx2LevelIndexEntrySize = 24;
+
+constexpr ui32 kDdsMagic = 0x20534444;  // "DDS "
+constexpr size_t kDdsHeaderSize = 128;
+constexpr size_t kDdsDx10HeaderSize = 20;
+constexpr ui32 kDdsCubeMap = 0x200;
+
+[[nodiscard]] constexpr ui32 MakeFourCc(const char (&code)[5]) noexcept {
+  return static_cast<ui32>(code[0]) | (static_cast<ui32>(code[1]) << 8) |
+         (static_cast<ui32>(code[2]) << 16) |
+         (static_cast<ui32>(code[3]) << 24);
+}
+
+template <typename T>
+[[nodiscard]] T Read(std::span<const ui8> file, size_t offset) {
+  [[unlikely]] if (offset + sizeof(T) > file.size()) {
+    throw std::runtime_error("Unexpected end of file");
+  }
+
+  // Both containers are little endian, as are the supported platforms
+  T value;
+  std::memcpy(&value, file.data() + offset, sizeof(T));
+  return value;
+}
+
+// sRGB formats map to the linear ones
+[[nodiscard]] std::optional<CompressedFormat> FromVkFormat(
+    ui32 format) noexcept {
+  switch (format) {
+    case 131:  // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    case 132:
+    case 133:  // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    case 134:
+      return CompressedFormat::BC1;
+    case 137:  // VK_FORMAT_BC3_UNORM_BLOCK
+    case 138:
+      return CompressedFormat::BC3;
+    case 139:  // VK_FORMAT_BC4_UNORM_BLOCK
+      return CompressedFormat::BC4;
+    case 141:  // VK_FORMAT_BC5_UNORM_BLOCK
+      return CompressedFormat::BC5;
+    case 145:  // VK_FORMAT_BC7_UNORM_BLOCK
+    case 146:
+      return CompressedFormat::BC7;
+    case 147:  // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+    case 148:
+      return CompressedFormat::Etc2Rgb8;
+    case 151:  // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+    case 152:
+      return CompressedFormat::Etc2Rgba8;
+    default:
+      return std::nullopt;
+  }
+}
+
+[[nodiscard]] std::optional<CompressedFormat> FromDxgiFormat(
+    ui32 format) noexcept {
+  switch (format) {
+    case 71:  // DXGI_FORMAT_BC1_UNORM
+    case 72:
+      return CompressedFormat::BC1;
+    case 77:  // DXGI_FORMAT_BC3_UNORM
+    case 78:
+      return CompressedFormat::BC3;
+    case 80:  // DXGI_FORMAT_BC4_UNORM
+      return CompressedFormat::BC4;
+    case 83:  // DXGI_FORMAT_BC5_UNORM
+      return CompressedFormat::BC5;
+    case 98:  // DXGI_FORMAT_BC7_UNORM
+    case 99:
+      return CompressedFormat::BC7;
+    default:
+      return std::nullopt;
+  }
+}
+
+[[nodiscard]] std::optional<CompressedFormat> FromFourCc(
+    ui32 four_cc) noexcept {
+  switch (four_cc) {
+    case MakeFourCc("DXT1"):
+      return CompressedFormat::BC1;
+    case MakeFourCc("DXT5"):
+      return CompressedFormat::BC3;
+    case MakeFourCc("ATI1"):
+    case MakeFourCc("BC4U"):
+      return CompressedFormat::BC4;
+    case MakeFourCc("ATI2"):
+    case MakeFourCc("BC5U"):
+      return CompressedFormat::BC5;
+    default:
+      return std::nullopt;
+  }
+}
+
+[[nodiscard]] constexpr ui32 GetLevelSize(ui32 base, size_t level) noexcept {
+  return std::max(base >> level, 1u);
+}
+
+[[nodiscard]] constexpr size_t GetNumBlocks(ui32 size) noexcept {
+  return (size + 3) / 4;
+}
+}  // namespace
+
+bool CompressedImage::IsCompressedFile(const std::filesystem::path& path) {
+  const std::filesystem::path extension = path.extension();
+  return extension == ".ktx2" || extension == ".dds";
+}
+
+void CompressedImage::LoadFromFile(const std::filesystem::path& path) {
+  Destroy();
+  std::vector<char> buffer;
+  ReadFile(path, buffer);
+  const std::span file(reinterpret_cast<const ui8*>(buffer.data()),
+                       buffer.size());
+
+  try {
+    if (path.extension() == ".ktx2") {
+      ReadKtx2(file);
+    } else {
+      ReadDds(file);
+    }
+  } catch (const std::exception& e) {
+    Destroy();
+    throw std::runtime_error(
+        fmt::format("Failed to load {}: {}", path.string(), e.what()));
+  }
+}
+
+void CompressedImage::Destroy() noexcept {
+  format_ = CompressedFormat::Max;
+  levels_.clear();
+  ReleaseData();
+}
+
+void CompressedImage::ReleaseData() noexcept {
+  // Releases the memory
+  decltype(data_)().swap(data_);
+}
+
+void CompressedImage::DecodeBaseLevel(std::span<ui8> rgba) const {
+  [[unlikely]] if (!HasBlockDecoder(format_)) {
+    throw std::runtime_error(
+        "Driver doesn't support the format and it has no CPU decoder");
+  }
+
+  const CompressedLevel& level = levels_.front();
+  assert(rgba.size() == size_t{level.width} * level.height * 4);
+  const size_t block_size = GetBlockSize(format_);
+  const size_t blocks_x = GetNumBlocks(level.width);
+  const std::span<const ui8> blocks = GetData().subspan(level.offset);
+
+  std::array<ui8, 64> texels;
+  for (size_t block_y = 0; block_y != GetNumBlocks(level.height); ++block_y) {
+    for (size_t block_x = 0; block_x != blocks_x; ++block_x) {
+      const size_t block_index = block_y * blocks_x + block_x;
+      [[maybe_unused]] const bool decoded =
+          DecodeBlock(format_, blocks.subspan(block_index * block_size),
+                      texels);
+      assert(decoded);
+
+      // Edge blocks are partially outside of the image
+      const size_t num_x = std::min<size_t>(4, level.width - block_x * 4);
+      for (size_t y = 0; y != 4; ++y) {
+        const size_t image_y = block_y * 4 + y;
+        [[unlikely]] if (image_y >= level.height) { break; }
+        std::memcpy(&rgba[(image_y * level.width + block_x * 4) * 4],
+                    &texels[y * 16], num_x * 4);
+      }
+    }
+  }
+}
+
+void CompressedImage::ReadKtx2(std::span<const ui8> file) {
+  [[unlikely]] if (file.size() < kKtx2HeaderSize ||
+                   !std::equal(kKtx2Identifier.begin(),
+                               kKtx2Identifier.end(), file.begin())) {
+    throw std::runtime_error("Not a KTX2 file");
+  }
+
+  const auto vk_format = Read<ui32>(file, 12);
+  const auto width = Read<ui32>(file, 20);
+  const auto height = Read<ui32>(file, 24);
+  const auto depth = Read<ui32>(file, 28);
+  const auto layers = Read<ui32>(file, 32);
+  const auto faces = Read<ui32>(file, 36);
+  const auto num_levels = std::max(Read<ui32>(file, 40), 1u);
+  const auto supercompression = Read<ui32>(file, 44);
+
+  const auto format = FromVkFormat(vk_format);
+  [[unlikely]] if (!format) {
+    throw std::runtime_error(fmt::format("Unsupported format {}", vk_format));
+  }
+  [[unlikely]] if (depth > 1 || layers > 1 || faces != 1 || height == 0) {
+    throw std::runtime_error("Only 2D textures are supported");
+  }
+  [[unlikely]] if (supercompression != 0) {
+    throw std::runtime_error("Supercompressed files are not supported");
+  }
+
+  format_ = *format;
+  for (size_t level = 0; level != num_levels; ++level) {
+    const size_t entry = kKtx2HeaderSize + level * kKtx2LevelIndexEntrySize;
+    const auto offset = Read<ui64>(file, entry);
+    const auto length = Read<ui64>(file, entry + 8);
+    [[unlikely]] if (AddLevel(width, height, file, offset) > length) {
+      throw std::runtime_error("Level is smaller than its blocks");
+    }
+  }
+}
+
+void CompressedImage::ReadDds(std::span<const ui8> file) {
+  [[unlikely]] if (Read<ui32>(file, 0) != kDdsMagic) {
+    throw std::runtime_error("Not a DDS file");
+  }
+
+  const auto height = Read<ui32>(file, 12);
+  const auto width = Read<ui32>(file, 16);
+  const auto num_levels = std::max(Read<ui32>(file, 28), 1u);
+  const auto four_cc = Read<ui32>(file, 84);
+  const auto caps2 = Read<ui32>(file, 112);
+  [[unlikely]] if (caps2 & kDdsCubeMap) {
+    throw std::runtime_error("Only 2D textures are supported");
+  }
+
+  size_t offset = kDdsHeaderSize;
+  std::optional<CompressedFormat> format;
+  if (four_cc == MakeFourCc("DX10")) {
+    const auto dxgi_format = Read<ui32>(file, kDdsHeaderSize);
+    const auto array_size = Read<ui32>(file, kDdsHeaderSize + 12);
+    [[unlikely]] if (array_size > 1) {
+      throw std::runtime_error("Only 2D textures are supported");
+    }
+    format = FromDxgiFormat(dxgi_format);
+    offset += kDdsDx10HeaderSize;
+  } else {
+    format = FromFourCc(four_cc);
+  }
+  [[unlikely]] if (!format) {
+    throw std::runtime_error("Unsupported format");
+  }
+
+  format_ = *format;
+  for (size_t level = 0; level != num_levels; ++level) {
+    offset += AddLevel(width, height, file, offset);
+  }
+}
+
+size_t CompressedImage::AddLevel(ui32 base_width, ui32 base_height,
+                                 std::span<const ui8> file,
+                                 size_t file_offset) {
+  const size_t level_index = levels_.size();
+  CompressedLevel level;
+  level.width = GetLevelSize(base_width, level_index);
+  level.height = GetLevelSize(base_height, level_index);
+  level.offset = data_.size();
+  level.size = GetNumBlocks(level.width) * GetNumBlocks(level.height) *
+               GetBlockSize(format_);
+  [[unlikely]] if (file_offset > file.size() ||
+                   file.size() - file_offset < level.size) {
+    throw std::runtime_error("Unexpected end of file");
+  }
+
+  const auto level_data = file.subspan(file_offset, level.size);
+  data_.insert(data_.end(), level_data.begin(), level_data.end());
+  levels_.push_back(level);
+  return level.size;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "integer.hpp"
+#include "memory/tagged_allocator.hpp"
+#include "texture/compressed_format.hpp"
+
+struct CompressedLevel {
+  ui32 width = 0;
+  ui32 height = 0;
+  // Into CompressedImage::GetData()
+  size_t offset = 0;
+  size_t size = 0;
+};
+
+// Block compressed 2D image with its pre-baked mip levels, read from KTX2
+// (without supercompression) or DDS files
+class CompressedImage {
+ public:
+  // By extension: .ktx2 or .dds
+  [[nodiscard]] static bool IsCompressedFile(
+      const std::filesystem::path& path);
+
+  // Throws if the file is malformed or has an unsupported format
+  void LoadFromFile(const std::filesystem::path& path);
+  void Destroy() noexcept;
+  // Frees the blocks but keeps the format and level layout
+  void ReleaseData() noexcept;
+
+  // RGBA8 texels of the base level. Throws if the format has no CPU decoder.
+  void DecodeBaseLevel(std::span<ui8> rgba) const;
+
+  [[nodiscard]] bool IsEmpty() const noexcept { return levels_.empty(); }
+  [[nodiscard]] CompressedFormat GetFormat() const noexcept { return format_; }
+  // From the base level down
+  [[nodiscard]] std::span<const CompressedLevel> GetLevels() const noexcept {
+    return levels_;
+  }
+  [[nodiscard]] std::span<const ui8> GetData() const noexcept {
+    return data_;
+  }
+
+ private:
+  void ReadKtx2(std::span<const ui8> file);
+  void ReadDds(std::span<const ui8> file);
+  // Copies the level from the file, returns its size in the file
+  size_t AddLevel(ui32 base_width, ui32 base_height,
+                  std::span<const ui8> file, size_t file_offset);
+
+ private:
+  CompressedFormat format_ = CompressedFormat::Max;
+  std::vector<CompressedLevel> levels_;
+  std::vector<ui8, TaggedAllocator<ui8, MemoryTag::Textures>> data_;
+};
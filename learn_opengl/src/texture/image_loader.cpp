@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "fmt/format.h"
+#include "memory/memory_tracker.hpp"
 
 #if !defined(_MSC_VER) && !defined(__clang__)
 #include "stb/stb_image.h"
@@ -48,10 +49,16 @@ void ImageLoader::LoadFromFile(const std::string_view& path) {
     throw std::runtime_error(
         fmt::format("Failed to load texture from file {}", path));
   }
+
+  // stb allocates with malloc
+  MemoryTracker::Get().OnAllocate(MemoryTag::Textures, MemoryDomain::Cpu,
+                                  GetSize());
 }
 
 void ImageLoader::Destroy() {
   if (pixel_data_) {
+    MemoryTracker::Get().OnFree(MemoryTag::Textures, MemoryDomain::Cpu,
+                                GetSize());
     stbi_image_free(pixel_data_);
     Reset();
   }
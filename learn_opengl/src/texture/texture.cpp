@@ -3,6 +3,7 @@
 #include <fstream>
 
 #include "fmt/format.h"
+#include "memory/memory_tracker.hpp"
 #include "nlohmann/json.hpp"
 #include "opengl/gl_api.hpp"
 #include "texture/image_loader.hpp"
@@ -22,10 +23,10 @@ static auto get_texture_json(std::string_view path) {
 Texture::Texture() = default;
 Texture::~Texture() = default;
 
-static void JsonParseOpt(nlohmann::json& json, std::string_view key,
+static void JsonParseOpt(const nlohmann::json& json, std::string_view key,
                          auto&& fn) {
   if (json.contains(key)) {
-    auto& key_json = json[key];
+    const auto& key_json = json[key];
     fn(key_json);
   }
 }
@@ -41,23 +42,106 @@ static void ParseAndApplyWrapMode(auto& wrap_json) {
 
 std::shared_ptr<Texture> Texture::LoadFrom(
     std::string_view json_path, const std::filesystem::path& src_dir) {
-  auto texture_json = get_texture_json(json_path);
-
-  const std::string src_path =
-      (src_dir / std::string(texture_json["image"])).string();
-
-  ImageLoader image(src_path);
+  const MemoryTagScope tag_scope(MemoryTag::Textures);
+  const TextureSource source =
+      ReadSource(json_path, src_dir, GetSupportedCompressedFormats());
   const GLuint gl_texture = OpenGl::GenTexture();
 
-  glActiveTexture(GL_TEXTURE0);
+  OpenGl::ActiveTexture(GL_TEXTURE0);
   OpenGl::BindTexture2d(gl_texture);
+  Upload(source, reinterpret_cast<std::uintptr_t>(source.GetData().data()));
+  FinishUpload(source);
+
+  auto texture = std::make_shared<Texture>();
+  texture->handle_ = gl_texture;
+  return texture;
+}
+
+TextureSource Texture::ReadSource(std::string_view json_path,
+                                  const std::filesystem::path& src_dir,
+                                  const CompressedFormatSet& supported) {
+  TextureSource source;
+  source.json = get_texture_json(json_path);
+  const std::filesystem::path src_path =
+      src_dir / source.json["image"].get<std::string>();
+  [[likely]] if (!CompressedImage::IsCompressedFile(src_path)) {
+    source.image.LoadFromFile(src_path.string());
+    return source;
+  }
+
+  CompressedImage& compressed = source.compressed;
+  compressed.LoadFromFile(src_path);
+  const auto format_index = static_cast<size_t>(compressed.GetFormat());
+  [[likely]] if (supported[format_index]) { return source; }
+
+  // Decoded base level gets generated mip levels like other images
+  const CompressedLevel& base = compressed.GetLevels().front();
+  source.decoded.resize(size_t{base.width} * base.height * 4);
+  compressed.DecodeBaseLevel(source.decoded);
+  source.decoded_width = base.width;
+  source.decoded_height = base.height;
+  compressed.Destroy();
+  return source;
+}
+
+void Texture::Upload(const TextureSource& source, std::uintptr_t base) {
+  [[likely]] if (!source.IsCompressed()) {
+    OpenGl::TexImage2d(GL_TEXTURE_2D, 0, GL_RGBA, source.GetWidth(),
+                       source.GetHeight(), GL_RGBA, GL_UNSIGNED_BYTE,
+                       reinterpret_cast<const void*>(base));
+    return;
+  }
 
-  size_t lod = 0;
-  OpenGl::TexImage2d(GL_TEXTURE_2D, lod, GL_RGBA, image.GetWidth(),
-                     image.GetHeight(), GL_RGBA, GL_UNSIGNED_BYTE,
-                     image.GetData().data());
-  OpenGl::GenerateMipmap2d();
+  const GLenum format = GetGlFormat(source.compressed.GetFormat());
+  const auto levels = source.compressed.GetLevels();
+  for (size_t i = 0; i != levels.size(); ++i) {
+    const CompressedLevel& level = levels[i];
+    OpenGl::CompressedTexImage2d(
+        GL_TEXTURE_2D, i, format, level.width, level.height, level.size,
+        reinterpret_cast<const void*>(base + level.offset));
+  }
+}
 
+void Texture::FinishUpload(const TextureSource& source) {
+  if (source.IsCompressed()) {
+    // Compressed mip chains come from the file and may be incomplete
+    const auto num_levels = source.compressed.GetLevels().size();
+    OpenGl::SetTextureParameter2d(GL_TEXTURE_MAX_LEVEL,
+                                  static_cast<GLint>(num_levels - 1));
+  } else {
+    OpenGl::GenerateMipmap2d();
+  }
+  ApplyParameters(source.json);
+}
+
+ui32 TextureSource::GetWidth() const noexcept {
+  if (IsCompressed()) {
+    return compressed.GetLevels().front().width;
+  }
+  return decoded.empty() ? image.GetWidth() : decoded_width;
+}
+
+ui32 TextureSource::GetHeight() const noexcept {
+  if (IsCompressed()) {
+    return compressed.GetLevels().front().height;
+  }
+  return decoded.empty() ? image.GetHeight() : decoded_height;
+}
+
+std::span<const ui8> TextureSource::GetData() const noexcept {
+  if (IsCompressed()) {
+    return compressed.GetData();
+  }
+  return decoded.empty() ? image.GetData() : std::span<const ui8>(decoded);
+}
+
+void TextureSource::ReleaseData() noexcept {
+  image.Destroy();
+  compressed.ReleaseData();
+  decltype(decoded)().swap(decoded);
+}
+
+void Texture::ApplyParameters(const nlohmann::json& texture_json) {
   JsonParseOpt(texture_json, "wrap", [&](auto& wrap_json) {
     ParseAndApplyWrapMode<GlTextureWrap::S>(wrap_json);
     ParseAndApplyWrapMode<GlTextureWrap::T>(wrap_json);
@@ -74,8 +158,10 @@ std::shared_ptr<Texture> Texture::LoadFrom(
           cppreflection::ParseEnum<GlTextureFilter>(value_str));
     });
   });
+}
 
+std::shared_ptr<Texture> Texture::FromHandle(ui32 handle) {
   auto texture = std::make_shared<Texture>();
-  texture->handle_ = gl_texture;
+  texture->handle_ = handle;
   return texture;
 }
@@ -1,18 +1,64 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <limits>
 #include <memory>
+#include <span>
 #include <string_view>
+#include <vector>
 
 #include "integer.hpp"
+#include "memory/tagged_allocator.hpp"
+#include "nlohmann/json.hpp"
+#include "texture/compressed_image.hpp"
+#include "texture/image_loader.hpp"
+
+// CPU side of a texture, can be read on any thread. Holds one of: an RGBA8
+// image, block compressed levels the driver accepts, or RGBA8 texels decoded
+// from compressed levels it doesn't.
+struct TextureSource {
+  [[nodiscard]] bool IsCompressed() const noexcept {
+    return !compressed.IsEmpty();
+  }
+  [[nodiscard]] ui32 GetWidth() const noexcept;
+  [[nodiscard]] ui32 GetHeight() const noexcept;
+  // Everything to upload: pixels or all compressed levels
+  [[nodiscard]] std::span<const ui8> GetData() const noexcept;
+  // After the upload. Keeps what FinishUpload needs.
+  void ReleaseData() noexcept;
+
+  nlohmann::json json;
+  ImageLoader image;
+  CompressedImage compressed;
+  std::vector<ui8, TaggedAllocator<ui8, MemoryTag::Textures>> decoded;
+  ui32 decoded_width = 0;
+  ui32 decoded_height = 0;
+};
 
 class Texture {
  public:
   Texture();
   ~Texture();
+  // Reads and uploads synchronously, see TextureManager for streaming
   static std::shared_ptr<Texture> LoadFrom(
       std::string_view path, const std::filesystem::path& src_dir);
+  // Compressed images in formats outside of the set are decoded to RGBA8
+  static TextureSource ReadSource(std::string_view path,
+                                  const std::filesystem::path& src_dir,
+                                  const CompressedFormatSet& supported);
+  // Specifies all levels of the texture bound to GL_TEXTURE_2D. Base is the
+  // address of source.GetData(), or zero with the data in the bound
+  // GL_PIXEL_UNPACK_BUFFER.
+  static void Upload(const TextureSource& source, std::uintptr_t base);
+  // Mip levels and parameters, after the upload is complete
+  static void FinishUpload(const TextureSource& source);
+  // Wrap and filter settings of the json, applied to the texture bound to
+  // GL_TEXTURE_2D of the active unit
+  static void ApplyParameters(const nlohmann::json& texture_json);
+
+  // Wraps a texture object created elsewhere (e.g. render target)
+  static std::shared_ptr<Texture> FromHandle(ui32 handle);
 
   static inline ui32 kInvalidHandle = std::numeric_limits<ui32>::max();
 
@@ -23,5 +69,8 @@ class Texture {
   [[nodiscard]] ui32 GetHandle() const noexcept { return handle_; }
 
  private:
+  // Swaps streamed textures in
+  friend class TextureManager;
+
   ui32 handle_ = kInvalidHandle;
 };
@@ -1,11 +1,40 @@
 #include "texture/texture_manager.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "memory/memory_tracker.hpp"
+#include "spdlog/spdlog.h"
+#include "template/on_scope_leave.hpp"
 #include "texture/texture.hpp"
+#include "wrap/wrap_imgui.h"
+
+namespace {
+// Other pixel uploads pass client pointers, which are treated as offsets
+// while a buffer is bound here, so it is bound only for the duration of a
+// step and released before Advance returns
+constexpr GLenum kUploadTarget = GL_PIXEL_UNPACK_BUFFER;
+constexpr GLbitfield kMapFlags =
+    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+// Neutral grey keeps lighting plausible until the image arrives
+constexpr std::array<ui8, 4> kPlaceholderTexel{128, 128, 128, 255};
+}  // namespace
 
 TextureManager::TextureManager(const std::filesystem::path& textures_dir)
-    : textures_dir_(textures_dir), sources_dir_(textures_dir / "src") {}
+    : textures_dir_(textures_dir),
+      sources_dir_(textures_dir / "src"),
+      supported_formats_(GetSupportedCompressedFormats()) {}
 
-TextureManager::~TextureManager() = default;
+TextureManager::~TextureManager() {
+  JobSystem::Get().Wait(decode_counter_);
+  for (auto& pending : pending_) {
+    Release(*pending);
+  }
+  if (placeholder_) {
+    OpenGl::DeleteTexture(placeholder_);
+  }
+}
 
 std::shared_ptr<Texture> TextureManager::GetTexture(
     const std::filesystem::path& in_path) {
@@ -17,7 +46,180 @@ std::shared_ptr<Texture> TextureManager::GetTexture(
     }
   }
 
-  auto texture = Texture::LoadFrom(path, sources_dir_);
+  auto texture = Texture::FromHandle(GetPlaceholder());
   textures_[path] = texture;
+
+  auto& pending = pending_.emplace_back(std::make_unique<PendingTexture>());
+  pending->texture = texture;
+  pending->path = path;
+  JobSystem::Get().Schedule(Job{
+      .function =
+          [this, p = pending.get()] {
+            try {
+              p->source = Texture::ReadSource(p->path, sources_dir_,
+                                              supported_formats_);
+            } catch (...) {
+              p->error = std::current_exception();
+            }
+            p->decoded.store(true, std::memory_order_release);
+          },
+      .counter = &decode_counter_,
+      .name = "DecodeTexture"});
+  ++stats_.num_pending;
   return texture;
 }
+
+void TextureManager::Update() {
+  const auto start = std::chrono::steady_clock::now();
+  const MemoryTagScope tag_scope(MemoryTag::Textures);
+  stats_.uploaded_bytes = 0;
+
+  // Textures are finished in request order, the budget check comes first so
+  // that at least one step is made per frame
+  for (auto it = pending_.begin(); it != pending_.end();) {
+    [[unlikely]] if (std::chrono::steady_clock::now() - start >=
+                     upload_budget_) {
+      break;
+    }
+
+    PendingTexture& pending = **it;
+    [[unlikely]] if (!pending.decoded.load(std::memory_order_acquire)) {
+      ++it;
+      continue;
+    }
+
+    if (Advance(pending)) {
+      it = pending_.erase(it);
+    } else if (pending.stage == UploadStage::Transferring) {
+      // Waits for the GPU, others can make progress meanwhile
+      ++it;
+    }
+  }
+
+  stats_.num_pending = pending_.size();
+  stats_.update_ms = std::chrono::duration<float, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+}
+
+bool TextureManager::Advance(PendingTexture& pending) {
+  [[unlikely]] if (pending.error || pending.texture.expired()) {
+    if (pending.error) {
+      ++stats_.num_failed;
+      try {
+        std::rethrow_exception(pending.error);
+      } catch (const std::exception& e) {
+        spdlog::error("Failed to stream {}: {}", pending.path, e.what());
+      }
+    }
+    Release(pending);
+    return true;
+  }
+
+  auto unbind = OnScopeLeave([] { OpenGl::BindBuffer(kUploadTarget, 0); });
+  switch (pending.stage) {
+    case UploadStage::Decoding:
+      pending.pixel_buffer = OpenGl::GenBuffer();
+      OpenGl::BindBuffer(kUploadTarget, pending.pixel_buffer);
+      OpenGl::BufferData(
+          kUploadTarget,
+          static_cast<GLsizeiptr>(pending.source.GetData().size()), nullptr,
+          GL_STREAM_DRAW);
+      pending.stage = UploadStage::Copying;
+      return false;
+    case UploadStage::Copying:
+      return CopyChunk(pending);
+    case UploadStage::Transferring:
+      return FinishTransfer(pending);
+  }
+
+  return false;
+}
+
+bool TextureManager::CopyChunk(PendingTexture& pending) {
+  const std::span<const ui8> data = pending.source.GetData();
+  const size_t size = std::min(kUploadChunkBytes,
+                               data.size() - pending.copied_bytes);
+
+  OpenGl::BindBuffer(kUploadTarget, pending.pixel_buffer);
+  void* mapped = OpenGl::MapBufferRange(
+      kUploadTarget, static_cast<GLintptr>(pending.copied_bytes),
+      static_cast<GLsizeiptr>(size), kMapFlags);
+  [[unlikely]] if (!mapped) { return false; }
+  std::memcpy(mapped, data.data() + pending.copied_bytes, size);
+  [[unlikely]] if (!OpenGl::UnmapBuffer(kUploadTarget)) {
+    // Storage got lost, copy the chunk again
+    return false;
+  }
+
+  pending.copied_bytes += size;
+  stats_.uploaded_bytes += size;
+  [[likely]] if (pending.copied_bytes != data.size()) { return false; }
+
+  // The driver reads the pixels or blocks from the buffer asynchronously
+  pending.gl_texture = OpenGl::GenTexture();
+  OpenGl::ActiveTexture(GL_TEXTURE0);
+  OpenGl::BindTexture2d(pending.gl_texture);
+  Texture::Upload(pending.source, 0);
+  pending.fence = OpenGl::FenceSync();
+  pending.source.ReleaseData();
+  pending.stage = UploadStage::Transferring;
+  return false;
+}
+
+bool TextureManager::FinishTransfer(PendingTexture& pending) {
+  [[likely]] if (!OpenGl::ClientWaitSync(pending.fence, 0)) { return false; }
+
+  OpenGl::DeleteSync(pending.fence);
+  pending.fence = nullptr;
+  OpenGl::DeleteBuffer(pending.pixel_buffer);
+  pending.pixel_buffer = 0;
+
+  OpenGl::ActiveTexture(GL_TEXTURE0);
+  OpenGl::BindTexture2d(pending.gl_texture);
+  Texture::FinishUpload(pending.source);
+
+  pending.texture.lock()->handle_ = std::exchange(pending.gl_texture, 0);
+  ++stats_.num_streamed;
+  return true;
+}
+
+void TextureManager::Release(PendingTexture& pending) noexcept {
+  if (pending.fence) {
+    OpenGl::DeleteSync(pending.fence);
+  }
+  if (pending.pixel_buffer) {
+    OpenGl::DeleteBuffer(pending.pixel_buffer);
+  }
+  if (pending.gl_texture) {
+    OpenGl::DeleteTexture(pending.gl_texture);
+  }
+}
+
+GLuint TextureManager::GetPlaceholder() {
+  [[likely]] if (placeholder_) { return placeholder_; }
+
+  const MemoryTagScope tag_scope(MemoryTag::Textures);
+  placeholder_ = OpenGl::GenTexture();
+  OpenGl::ActiveTexture(GL_TEXTURE0);
+  OpenGl::BindTexture2d(placeholder_);
+  OpenGl::TexImage2d(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, GL_RGBA,
+                     GL_UNSIGNED_BYTE, kPlaceholderTexel.data());
+  // Has no mipmaps
+  OpenGl::SetTextureParameter2d(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  return placeholder_;
+}
+
+void TextureManager::DrawDetails() {
+  ImGui::Text("pending: %zu", stats_.num_pending);
+  ImGui::Text("streamed: %llu, failed: %llu",
+              static_cast<unsigned long long>(stats_.num_streamed),
+              static_cast<unsigned long long>(stats_.num_failed));
+  ImGui::Text("last update: %zu bytes in %.3f ms", stats_.uploaded_bytes,
+              stats_.update_ms);
+
+  int budget_us = static_cast<int>(upload_budget_.count());
+  if (ImGui::SliderInt("upload budget, us", &budget_us, 100, 16000)) {
+    upload_budget_ = std::chrono::microseconds(budget_us);
+  }
+}
@@ -1,23 +1,86 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
 #include <filesystem>
 #include <memory>
 #include <string>
 #include <unordered_map>
 
+#include "jobs/job_system.hpp"
+#include "opengl/gl_api.hpp"
 #include "texture/texture.hpp"
 
 class Texture;
 
+struct TextureStreamingStats {
+  size_t num_pending = 0;
+  ui64 num_streamed = 0;
+  ui64 num_failed = 0;
+  // Of the last Update
+  size_t uploaded_bytes = 0;
+  float update_ms = 0.0f;
+};
+
+// Textures are streamed: GetTexture returns a texture that samples a
+// placeholder until the image is decoded on a worker thread and uploaded
+// through a pixel buffer object. Then the texture handle is swapped, so
+// shaders holding the texture pick the real image up. Main thread only.
 class TextureManager {
  public:
+  static constexpr size_t kUploadChunkBytes = 1024 * 1024;
+
   TextureManager(const std::filesystem::path& textures_dir);
   ~TextureManager();
 
   std::shared_ptr<Texture> GetTexture(const std::filesystem::path& path);
 
+  // Advances uploads until the frame budget is spent. Needs the GL context.
+  void Update();
+  void SetUploadBudget(std::chrono::microseconds budget) noexcept {
+    upload_budget_ = budget;
+  }
+
+  [[nodiscard]] const TextureStreamingStats& GetStats() const noexcept {
+    return stats_;
+  }
+  void DrawDetails();
+
+ private:
+  enum class UploadStage { Decoding, Copying, Transferring };
+
+  struct PendingTexture {
+    std::weak_ptr<Texture> texture;
+    std::string path;
+    // Written by the decode job before it sets decoded
+    TextureSource source;
+    std::exception_ptr error;
+    std::atomic<bool> decoded = false;
+    UploadStage stage = UploadStage::Decoding;
+    GLuint pixel_buffer = 0;
+    size_t copied_bytes = 0;
+    GLuint gl_texture = 0;
+    GLsync fence = nullptr;
+  };
+
+  [[nodiscard]] GLuint GetPlaceholder();
+  // Returns true when the texture is done with, successfully or not
+  [[nodiscard]] bool Advance(PendingTexture& pending);
+  [[nodiscard]] bool CopyChunk(PendingTexture& pending);
+  [[nodiscard]] bool FinishTransfer(PendingTexture& pending);
+  static void Release(PendingTexture& pending) noexcept;
+
  private:
   std::filesystem::path textures_dir_;
   std::filesystem::path sources_dir_;
   std::unordered_map<std::string, std::weak_ptr<Texture>> textures_;
+  std::deque<std::unique_ptr<PendingTexture>> pending_;
+  JobCounter decode_counter_;
+  // Queried on the GL thread, read by decode jobs
+  CompressedFormatSet supported_formats_;
+  GLuint placeholder_ = 0;
+  std::chrono::microseconds upload_budget_{2000};
+  TextureStreamingStats stats_;
 };
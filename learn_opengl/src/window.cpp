@@ -7,6 +7,8 @@
 
 #include "GLFW/glfw3.h"
 #include "components/camera_component.hpp"
+#include "entities/entity.hpp"
+#include "world.hpp"
 
 Window::Window(ui32 width, ui32 height)
     : id_(MakeWindowId()), width_(width), height_(height) {
@@ -24,14 +26,32 @@ bool Window::ShouldClose() const noexcept {
 void Window::ProcessInput(float dt) {
   if (glfwGetKey(window_, GLFW_KEY_ESCAPE) == GLFW_PRESS)
     glfwSetWindowShouldClose(window_, true);
-  const auto forward = dt * camera_->speed * camera_->front;
-  const auto right = camera_->speed * dt * camera_->front.cross(camera_->up);
   Eigen::Vector2f k{0.0f, 0.0f};
   if (glfwGetKey(window_, GLFW_KEY_W) == GLFW_PRESS) k.x() = 1;
   if (glfwGetKey(window_, GLFW_KEY_S) == GLFW_PRESS) k.x() = -1;
   if (glfwGetKey(window_, GLFW_KEY_A) == GLFW_PRESS) k.y() = -1;
   if (glfwGetKey(window_, GLFW_KEY_D) == GLFW_PRESS) k.y() = 1;
-  camera_->eye += forward * k.x() + right * k.y();
+  [[likely]] if (k.isZero()) { return; }
+
+  CameraComponent* camera = ModifyCamera();
+  [[unlikely]] if (!camera) { return; }
+  const auto forward = dt * camera->speed * camera->front;
+  const auto right = camera->speed * dt * camera->front.cross(camera->up);
+  camera->eye += forward * k.x() + right * k.y();
+}
+
+const CameraComponent* Window::GetCamera() const noexcept {
+  [[unlikely]] if (!world_) { return nullptr; }
+  const Entity* entity = world_->GetEntity(camera_entity_);
+  [[unlikely]] if (!entity) { return nullptr; }
+  return entity->FindComponent<CameraComponent>();
+}
+
+CameraComponent* Window::ModifyCamera() const noexcept {
+  [[unlikely]] if (!world_) { return nullptr; }
+  Entity* entity = world_->GetEntity(camera_entity_);
+  [[unlikely]] if (!entity) { return nullptr; }
+  return entity->ModifyComponent<CameraComponent>();
 }
 
 void Window::SwapBuffers() noexcept { glfwSwapBuffers(window_); }
@@ -116,8 +136,10 @@ void Window::OnMouseMove(Eigen::Vector2f new_cursor) {
   float sensitivity = 0.001f;
   auto delta = (new_cursor - cursor_) * sensitivity;
   cursor_ = new_cursor;
-  if (input_mode_) {
-    camera_->AddInput(Eigen::Vector3f(delta.x(), delta.y(), 0.0f));
+  if (input_mode_ && !delta.isZero()) {
+    if (CameraComponent* camera = ModifyCamera()) {
+      camera->AddInput(Eigen::Vector3f(delta.x(), delta.y(), 0.0f));
+    }
   }
 }
 
@@ -136,11 +158,27 @@ void Window::OnMouseButton(int button, int action, [[maybe_unused]] int mods) {
 }
 
 void Window::OnMouseScroll([[maybe_unused]] float dx, float dy) {
-  camera_->fov -= dy;
-  camera_->fov = std::clamp(camera_->fov, 15.0f, 90.0f);
+  [[unlikely]] if (dy == 0.0f) { return; }
+  CameraComponent* camera = ModifyCamera();
+  [[unlikely]] if (!camera) { return; }
+  camera->fov -= dy;
+  camera->fov = std::clamp(camera->fov, 15.0f, 90.0f);
+}
+
+Eigen::Matrix4f Window::GetView() const noexcept {
+  const CameraComponent* camera = GetCamera();
+  [[likely]] if (camera) { return camera->GetView(); }
+  return Eigen::Matrix4f::Identity();
 }
 
-Eigen::Matrix4f Window::GetView() const noexcept { return camera_->GetView(); }
 Eigen::Matrix4f Window::GetProjection() const noexcept {
-  return camera_->GetProjection(GetAspect());
+  const CameraComponent* camera = GetCamera();
+  [[likely]] if (camera) { return camera->GetProjection(GetAspect()); }
+  return Eigen::Matrix4f::Identity();
+}
+
+Eigen::Vector3f Window::GetEyeLocation() const noexcept {
+  const CameraComponent* camera = GetCamera();
+  [[likely]] if (camera) { return camera->eye; }
+  return Eigen::Vector3f::Zero();
 }
\ No newline at end of file
@@ -2,11 +2,13 @@
 
 #include <memory>
 
+#include "entities/entity_handle.hpp"
 #include "integer.hpp"
 #include "wrap/wrap_eigen.hpp"
 
 struct GLFWwindow;
 class CameraComponent;
+class World;
 
 class Window {
  public:
@@ -19,19 +21,29 @@ class Window {
   [[nodiscard]] ui32 GetWidth() const noexcept { return width_; }
   [[nodiscard]] ui32 GetHeight() const noexcept { return height_; }
   [[nodiscard]] GLFWwindow* GetGlfwWindow() const noexcept { return window_; }
+  // Identity without a camera
   [[nodiscard]] Eigen::Matrix4f GetView() const noexcept;
   [[nodiscard]] Eigen::Matrix4f GetProjection() const noexcept;
+  [[nodiscard]] Eigen::Vector3f GetEyeLocation() const noexcept;
   [[nodiscard]] float GetAspect() const noexcept {
     return static_cast<float>(GetWidth()) / static_cast<float>(GetHeight());
   }
 
   void ProcessInput(float dt);
   void SwapBuffers() noexcept;
-  void SetCamera(CameraComponent* camera) { camera_ = camera; }
-  CameraComponent* GetCamera() const { return camera_; }
+  // Camera component of the entity is looked up on every use: component
+  // storage moves when entities are destroyed or change components
+  void SetCamera(World& world, EntityHandle camera_entity) noexcept {
+    world_ = &world;
+    camera_entity_ = camera_entity;
+  }
+  // Null if the entity is gone or has no camera
+  [[nodiscard]] const CameraComponent* GetCamera() const noexcept;
 
  private:
   static ui32 MakeWindowId();
+  // Marks the camera as changed, only for actual modifications
+  [[nodiscard]] CameraComponent* ModifyCamera() const noexcept;
   static Window* GetWindow(GLFWwindow* glfw_window) noexcept;
 
   template <auto method, typename... Args>
@@ -58,7 +70,8 @@ class Window {
 
  private:
   GLFWwindow* window_ = nullptr;
-  CameraComponent* camera_ = nullptr;
+  World* world_ = nullptr;
+  EntityHandle camera_entity_;
   Eigen::Vector2f cursor_;
   ui32 id_;
   ui32 width_;
@@ -2,22 +2,39 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <atomic>
 #include <stdexcept>
+#include <vector>
 
 #include "CppReflection/GetStaticTypeInfo.hpp"
 #include "components/component.hpp"
 #include "entities/entity.hpp"
-#include "memory/memory.hpp"
+#include "entities/entity_command_buffer.hpp"
+#include "entities/prefab.hpp"
+#include "jobs/job_system.hpp"
 
 void World::EntityDeleter::operator()(Entity* entity) const {
+  const cppreflection::Type* type =
+      cppreflection::GetTypeRegistry()->FindType(entity->GetTypeGUID());
   entity->~Entity();
-  Memory::AlignedFree(entity);
+  pools->Free(*type, entity);
+}
+
+World::World() {
+  archetypes_.push_back(std::make_unique<Archetype>(
+      std::vector<const cppreflection::Type*>{}, pools_));
+  const ui32 num_workers = JobSystem::Get().GetNumWorkers();
+  command_buffers_.reserve(num_workers);
+  for (ui32 worker = 0; worker != num_workers; ++worker) {
+    command_buffers_.push_back(std::make_unique<EntityCommandBuffer>());
+  }
 }
 
-World::World() = default;
 World::~World() = default;
 
 Entity& World::SpawnEntity(edt::GUID guid) {
+  CheckStructuralChange();
   constexpr edt::GUID entity_type_guid =
       cppreflection::GetStaticTypeInfo<Entity>().guid;
   const cppreflection::Type* type_info =
@@ -26,12 +43,359 @@ Entity& World::SpawnEntity(edt::GUID guid) {
     throw std::runtime_error(
         fmt::format("{} is not an entity", type_info->GetName()));
   }
-  void* memory = Memory::AlignedAlloc(type_info->GetInstanceSize(),
-                                      type_info->GetAlignment());
-  type_info->GetSpecialMembers().defaultConstructor(memory);
-  EntityPtr entity(reinterpret_cast<Entity*>(memory));
+  Entity& entity = CreateEntity(*type_info, *archetypes_.front());
+  entity.SetName(fmt::format("Entity {}", entity.GetId()));
+  return entity;
+}
+
+EntityHandleRange World::SpawnMany(const Prefab& prefab, size_t count) {
+  CheckStructuralChange();
+  [[unlikely]] if (count == 0) { return {}; }
+  [[unlikely]] if (count >= EntityHandle::kInvalidIndex - slots_.size()) {
+    throw std::runtime_error("Too many entities");
+  }
+
+  const std::span<const cppreflection::Type* const> types = prefab.GetTypes();
+  Archetype& archetype = FindOrCreateArchetype({types.begin(), types.end()});
+  archetype.Reserve(count);
+  ReserveEntities(count);
+
+  EntityHandleRange range;
+  range.first_index = static_cast<ui32>(slots_.size());
+  range.size = static_cast<ui32>(count);
+  slots_.resize(slots_.size() + count);
+  range.generation = slots_.back().generation;
+
+  const size_t first_row = archetype.GetSize();
+  const size_t capacity = archetype.GetChunkCapacity();
+  const auto get_location = [capacity](size_t row) {
+    return ArchetypeLocation{static_cast<ui32>(row / capacity),
+                             static_cast<ui32>(row % capacity)};
+  };
+
+  TypeIndices& type_indices = TypeIndices::Get();
+  std::vector<size_t> columns(types.size());
+  for (size_t i = 0; i != types.size(); ++i) {
+    columns[i] = *archetype.FindColumn(type_indices.Register(*types[i]));
+  }
+
+  // Progress for the rollback: rows of the first constructed_columns
+  // columns are constructed, and constructed_rows of the next one
+  size_t created = 0;
+  size_t constructed_columns = 0;
+  size_t constructed_rows = 0;
+  try {
+    for (; created != count; ++created) {
+      Entity& entity =
+          CreateEntity(prefab.GetEntityType(), archetype,
+                       range.first_index + static_cast<ui32>(created));
+      entity.SetName(prefab.GetName());
+      entity.SetStatic(prefab.IsStatic());
+    }
+
+    // Column by column, one resolved copy constructor for each
+    for (; constructed_columns != types.size(); ++constructed_columns) {
+      const size_t column = columns[constructed_columns];
+      const auto copy =
+          types[constructed_columns]->GetSpecialMembers().copyConstructor;
+      const void* prototype = prefab.GetPrototype(constructed_columns);
+      for (constructed_rows = 0; constructed_rows != count;
+           ++constructed_rows) {
+        const ArchetypeLocation location =
+            get_location(first_row + constructed_rows);
+        copy(archetype.GetComponent(location, column), prototype);
+        archetype.MarkChanged(location, column, change_version_);
+      }
+    }
+  } catch (...) {
+    // New rows and entities are the last ones, so they are removed from
+    // the back without moving others
+    for (size_t row = created; row-- != 0;) {
+      const ArchetypeLocation location = get_location(first_row + row);
+      for (size_t i = 0; i != types.size(); ++i) {
+        [[likely]] if (i < constructed_columns ||
+                       (i == constructed_columns && row < constructed_rows)) {
+          types[i]->GetSpecialMembers().destructor(
+              archetype.GetComponent(location, columns[i]));
+        }
+      }
+      archetype.RemoveRow(location, false);
+    }
+    entities_.erase(entities_.end() - static_cast<ptrdiff_t>(created),
+                    entities_.end());
+    slots_.resize(range.first_index);
+    ++structure_version_;
+    throw;
+  }
+
+  return range;
+}
+
+Entity& World::CreateEntity(const cppreflection::Type& type,
+                            Archetype& archetype) {
+  [[unlikely]] if (free_slots_.empty()) {
+    free_slots_.push_back(static_cast<ui32>(slots_.size()));
+    slots_.emplace_back();
+  }
+
+  Entity& entity = CreateEntity(type, archetype, free_slots_.back());
+  free_slots_.pop_back();
+  return entity;
+}
+
+Entity& World::CreateEntity(const cppreflection::Type& type,
+                            Archetype& archetype, ui32 slot_index) {
+  void* memory = pools_.Allocate(type);
+  type.GetSpecialMembers().defaultConstructor(memory);
+  EntityPtr entity(reinterpret_cast<Entity*>(memory), EntityDeleter{&pools_});
   entity->SetId(next_entity_id_++);
-  entity->SetName(fmt::format("Entity {}", entity->GetId()));
+  entity->world_ = this;
+
+  // Grows geometrically, but before anything is modified
+  [[unlikely]] if (entities_.size() == entities_.capacity()) {
+    entities_.reserve(std::max<size_t>(entities_.size() * 2, 64));
+  }
+
+  EntitySlot& slot = slots_[slot_index];
+  entity->archetype_ = &archetype;
+  entity->location_ = entity->archetype_->AddRow(entity.get());
+  entity->handle_ = {slot_index, slot.generation};
+  slot.entity = entity.get();
+  slot.dense_index = static_cast<ui32>(entities_.size());
+  ++structure_version_;
   entities_.push_back(std::move(entity));
   return *entities_.back();
 }
+
+void World::ReserveEntities(size_t num_entities) {
+  entities_.reserve(entities_.size() + num_entities);
+  slots_.reserve(slots_.size() + num_entities);
+}
+
+Entity* World::GetEntity(EntityHandle handle) const noexcept {
+  [[likely]] if (handle.index < slots_.size()) {
+    const EntitySlot& slot = slots_[handle.index];
+    [[likely]] if (slot.generation == handle.generation) {
+      return slot.entity;
+    }
+  }
+
+  return nullptr;
+}
+
+void World::DestroyEntity(EntityHandle handle) {
+  [[unlikely]] if (!GetEntity(handle)) { return; }
+
+  if (iteration_depth_ != 0) {
+    pending_destroy_.push_back(handle);
+  } else {
+    DestroyEntityNow(handle);
+  }
+}
+
+void World::DestroyEntityNow(EntityHandle handle) {
+  // Pending list may have the same entity twice
+  Entity* entity = GetEntity(handle);
+  [[unlikely]] if (!entity) { return; }
+
+  if (Entity* moved = entity->archetype_->RemoveRow(entity->location_, true)) {
+    moved->location_ = entity->location_;
+  }
+
+  EntitySlot& slot = slots_[handle.index];
+  const ui32 dense_index = slot.dense_index;
+  [[likely]] if (dense_index != entities_.size() - 1) {
+    std::swap(entities_[dense_index], entities_.back());
+    slots_[entities_[dense_index]->handle_.index].dense_index = dense_index;
+  }
+  entities_.pop_back();
+  ++structure_version_;
+
+  slot.entity = nullptr;
+  [[unlikely]] if (++slot.generation == 0) { slot.generation = 1; }
+  free_slots_.push_back(handle.index);
+}
+
+void World::DestroyPendingEntities() {
+  while (!pending_destroy_.empty()) {
+    const EntityHandle handle = pending_destroy_.back();
+    pending_destroy_.pop_back();
+    DestroyEntityNow(handle);
+  }
+}
+
+Component* World::AddComponent(Entity& entity,
+                               const cppreflection::Type& type) {
+  CheckStructuralChange();
+  Archetype& source = *entity.archetype_;
+  const ui32 type_index = TypeIndices::Get().Register(type);
+  [[unlikely]] if (source.GetMask().test(type_index)) {
+    throw std::runtime_error(fmt::format("{} already has {}", entity.GetName(),
+                                         type.GetName()));
+  }
+
+  Archetype* target = source.FindAddEdge(&type);
+  [[unlikely]] if (!target) {
+    // Keep types sorted by index
+    std::vector<const cppreflection::Type*> types;
+    types.reserve(source.GetColumns().size() + 1);
+    bool inserted = false;
+    for (const ArchetypeColumn& column : source.GetColumns()) {
+      if (!inserted && column.type_index > type_index) {
+        types.push_back(&type);
+        inserted = true;
+      }
+      types.push_back(column.type);
+    }
+    if (!inserted) {
+      types.push_back(&type);
+    }
+    target = &FindOrCreateArchetype(std::move(types));
+    source.SetAddEdge(&type, target);
+  }
+
+  const ArchetypeLocation location = MoveEntity(entity, *target);
+  const size_t added_column = *target->FindColumn(type_index);
+  target->ConstructComponent(location, added_column);
+  target->MarkChanged(location, added_column, change_version_);
+  return reinterpret_cast<Component*>(
+      target->GetComponent(location, added_column));
+}
+
+void World::RemoveComponent(Entity& entity, const cppreflection::Type& type) {
+  CheckStructuralChange();
+  Archetype& source = *entity.archetype_;
+  const ui32 type_index = TypeIndices::Get().Register(type);
+  [[unlikely]] if (!source.GetMask().test(type_index)) {
+    throw std::runtime_error(fmt::format("{} doesn't have {}",
+                                         entity.GetName(), type.GetName()));
+  }
+
+  Archetype* target = source.FindRemoveEdge(&type);
+  [[unlikely]] if (!target) {
+    std::vector<const cppreflection::Type*> types;
+    types.reserve(source.GetColumns().size() - 1);
+    for (const ArchetypeColumn& column : source.GetColumns()) {
+      if (column.type_index != type_index) {
+        types.push_back(column.type);
+      }
+    }
+    target = &FindOrCreateArchetype(std::move(types));
+    source.SetRemoveEdge(&type, target);
+  }
+
+  MoveEntity(entity, *target);
+}
+
+ArchetypeLocation World::MoveEntity(Entity& entity, Archetype& target) {
+  Archetype& source = *entity.archetype_;
+  const ArchetypeLocation source_location = entity.location_;
+  const ArchetypeLocation target_location = target.AddRow(&entity);
+  const std::span<const ArchetypeColumn> columns = source.GetColumns();
+  for (size_t column = 0; column != columns.size(); ++column) {
+    void* component = source.GetComponent(source_location, column);
+    const auto target_column = target.FindColumn(columns[column].type_index);
+    [[unlikely]] if (!target_column) {
+      columns[column].type->GetSpecialMembers().destructor(component);
+      continue;
+    }
+
+    Archetype::RelocateComponent(
+        *columns[column].type,
+        target.GetComponent(target_location, *target_column), component);
+    target.MarkChanged(target_location, *target_column,
+                       source.GetChangeVersion(source_location, column));
+  }
+  ++structure_version_;
+
+  if (Entity* moved = source.RemoveRow(source_location, false)) {
+    moved->location_ = source_location;
+  }
+
+  entity.archetype_ = &target;
+  entity.location_ = target_location;
+  return target_location;
+}
+
+EntityCommandBuffer& World::GetCommandBuffer() const {
+  const ui32 worker = JobSystem::GetCurrentWorker();
+  [[unlikely]] if (worker >= command_buffers_.size()) {
+    throw std::logic_error(
+        "Command buffers can be used only by job system workers");
+  }
+  return *command_buffers_[worker];
+}
+
+void World::PlaybackCommands() {
+  CheckStructuralChange();
+  for (const auto& buffer : command_buffers_) {
+    [[unlikely]] if (!buffer->IsEmpty()) { buffer->Playback(*this); }
+  }
+}
+
+void World::CheckStructuralChange() const {
+  [[unlikely]] if (iteration_depth_ != 0) {
+    throw std::logic_error(
+        "World can't change structurally while it is iterated, record the "
+        "change in a command buffer instead");
+  }
+}
+
+void World::MarkChanged(const Entity& entity,
+                        ui32 type_index) const noexcept {
+  [[likely]] if (auto column = entity.archetype_->FindColumn(type_index)) {
+    entity.archetype_->MarkChanged(entity.location_, *column,
+                                   change_version_);
+  }
+}
+
+Archetype& World::FindOrCreateArchetype(
+    std::vector<const cppreflection::Type*> types) {
+  for (const auto& archetype : archetypes_) {
+    if (std::ranges::equal(archetype->GetTypes(), types)) {
+      return *archetype;
+    }
+  }
+
+  archetypes_.push_back(std::make_unique<Archetype>(std::move(types), pools_));
+  return *archetypes_.back();
+}
+
+size_t World::AllocateQueryId() noexcept {
+  static std::atomic<size_t> next_query_id = 0;
+  return next_query_id++;
+}
+
+const World::Query& World::UpdateQuery(size_t query_id,
+                                       std::span<const ui32> type_indices) {
+  std::lock_guard lock(queries_mutex_);
+  [[unlikely]] if (query_id >= queries_.size()) {
+    queries_.resize(query_id + 1);
+  }
+
+  Query& query = queries_[query_id];
+  [[unlikely]] if (query.mask.none()) {
+    for (const ui32 type_index : type_indices) {
+      query.mask.set(type_index);
+    }
+  }
+
+  // Archetypes are never removed, so only new ones need to be matched.
+  // They are added only by structural changes, which don't run concurrently
+  // with queries, so other threads never see the query grow.
+  for (; query.num_checked_archetypes != archetypes_.size();
+       ++query.num_checked_archetypes) {
+    Archetype* archetype = archetypes_[query.num_checked_archetypes].get();
+    if ((archetype->GetMask() & query.mask) != query.mask) {
+      continue;
+    }
+
+    query.archetypes.push_back(archetype);
+    for (const ui32 type_index : type_indices) {
+      query.columns.push_back(
+          static_cast<ui32>(*archetype->FindColumn(type_index)));
+    }
+  }
+
+  return query;
+}
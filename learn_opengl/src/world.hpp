@@ -1,12 +1,29 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "CppReflection/GetStaticTypeInfo.hpp"
+#include "entities/archetype.hpp"
+#include "entities/entity_handle.hpp"
 #include "integer.hpp"
+#include "memory/type_pools.hpp"
+#include "reflection/type_indices.hpp"
+#include "systems/system.hpp"
 
+class Component;
 class Entity;
+class EntityCommandBuffer;
+class Prefab;
+class WorldSnapshot;
 
 class World {
  public:
@@ -18,6 +35,73 @@ class World {
   void ForEachEntity(auto&& fn);
   Entity& SpawnEntity(edt::GUID type_id);
 
+  // Spawns entities of the prefab with components copied from its
+  // prototypes. Storage is reserved up front and entities get new slots, so
+  // their handles form a range.
+  EntityHandleRange SpawnMany(const Prefab& prefab, size_t count);
+
+  // Returns null if the entity was destroyed
+  [[nodiscard]] Entity* GetEntity(EntityHandle handle) const noexcept;
+
+  // Destroys the entity with its components. While the world is being
+  // iterated, destruction is deferred until the outermost iteration ends and
+  // the entity stays alive until then.
+  void DestroyEntity(EntityHandle handle);
+
+  // Used by Entity::AddComponent. Type must be a component.
+  Component* AddComponent(Entity& entity, const cppreflection::Type& type);
+  // Used by Entity::RemoveComponent. Entity must have a component of exactly
+  // this type.
+  void RemoveComponent(Entity& entity, const cppreflection::Type& type);
+
+  // Buffer of the calling job system worker. Structural changes can't be
+  // made while the world is iterated, so systems record them here and they
+  // are applied by PlaybackCommands.
+  [[nodiscard]] EntityCommandBuffer& GetCommandBuffer() const;
+
+  // Applies buffers of all workers in worker order. Called by
+  // SystemScheduler after systems of a frame finished.
+  void PlaybackCommands();
+
+  // Calls fn(chunk, std::span<Ts>...) for every chunk of archetypes that have
+  // components of exactly these types. Matching archetypes are cached per
+  // query. fn must not change the world structurally. Const types are only
+  // read, queries may run concurrently from systems which don't change the
+  // world structurally.
+  template <typename... Ts, typename F>
+  void ForEachChunk(F&& fn);
+
+  // Calls fn(Ts&...) for every entity that has components of exactly these
+  // types
+  template <typename... Ts, typename F>
+  void ForEach(F&& fn);
+
+  // Same as ForEachChunk, but skips chunks where none of Ts changed after
+  // the version
+  template <typename... Ts, typename F>
+  void ForEachChunkChangedSince(ui32 version, F&& fn);
+
+  // Same as ForEach, but only for entities where any of Ts changed after
+  // the version
+  template <typename... Ts, typename F>
+  void ForEachChangedSince(ui32 version, F&& fn);
+
+  // Components written now get this version. Advanced once per frame, so
+  // consumers remember the version they saw and ask what changed since.
+  [[nodiscard]] ui32 GetChangeVersion() const noexcept {
+    return change_version_;
+  }
+  void AdvanceChangeVersion() noexcept { ++change_version_; }
+
+  // Changes when entities are spawned, destroyed or move between
+  // archetypes, so that lists of entities built earlier are stale
+  [[nodiscard]] ui64 GetStructureVersion() const noexcept {
+    return structure_version_;
+  }
+
+  // Marks components of the entity that are exactly of the type as written
+  void MarkChanged(const Entity& entity, ui32 type_index) const noexcept;
+
   [[nodiscard]] inline size_t GetNumEntities() const noexcept {
     return entities_.size();
   }
@@ -27,20 +111,116 @@ class World {
     return nullptr;
   }
 
+  [[nodiscard]] size_t GetNumArchetypes() const noexcept {
+    return archetypes_.size();
+  }
+
+  [[nodiscard]] const TypePools& GetPools() const noexcept { return pools_; }
+
  private:
+  friend class WorldSnapshot;
+
   class EntityDeleter {
    public:
     void operator()(Entity*) const;
+
+    TypePools* pools = nullptr;
   };
 
   using EntityPtr = std::unique_ptr<Entity, EntityDeleter>;
 
+  struct Query {
+    TypeMask mask;
+    std::vector<Archetype*> archetypes;
+    // Columns of query types for each archetype
+    std::vector<ui32> columns;
+    size_t num_checked_archetypes = 0;
+  };
+
+  // Dense id for each instantiation of ForEachChunk
+  static size_t AllocateQueryId() noexcept;
+  template <typename... Ts>
+  [[nodiscard]] static size_t GetQueryId() noexcept {
+    static const size_t id = AllocateQueryId();
+    return id;
+  }
+
+  const Query& UpdateQuery(size_t query_id,
+                           std::span<const ui32> type_indices);
+
+  // Place of an entity in the handle table
+  struct EntitySlot {
+    Entity* entity = nullptr;
+    ui32 generation = 1;
+    // Index in entities_
+    ui32 dense_index = 0;
+  };
+
+  // Defers destruction while alive
+  class IterationScope {
+   public:
+    explicit IterationScope(World& world) noexcept : world_(&world) {
+      ++world_->iteration_depth_;
+    }
+    IterationScope(const IterationScope&) = delete;
+    ~IterationScope() {
+      [[unlikely]] if (--world_->iteration_depth_ == 0 &&
+                       !world_->pending_destroy_.empty()) {
+        world_->DestroyPendingEntities();
+      }
+    }
+    IterationScope& operator=(const IterationScope&) = delete;
+
+   private:
+    World* world_;
+  };
+
+  // Constructs an entity of the type and appends it to the archetype.
+  // Components of its row are not constructed and the entity has no name.
+  Entity& CreateEntity(const cppreflection::Type& type, Archetype& archetype);
+  // Same, but in the slot which must be empty and not in the free list
+  Entity& CreateEntity(const cppreflection::Type& type, Archetype& archetype,
+                       ui32 slot_index);
+  // Room for this many more entities
+  void ReserveEntities(size_t num_entities);
+
+  // Moves the entity with its components to the archetype. Components the
+  // target doesn't have are destroyed, new ones are not constructed.
+  ArchetypeLocation MoveEntity(Entity& entity, Archetype& target);
+
+  // Throws while the world is iterated
+  void CheckStructuralChange() const;
+
+  void DestroyEntityNow(EntityHandle handle);
+  void DestroyPendingEntities();
+
+  Archetype& FindOrCreateArchetype(
+      std::vector<const cppreflection::Type*> types);
+
  private:
+  // Memory of entities and component chunks. Destroyed last, so all of it
+  // goes back to the system at once after destructors ran.
+  TypePools pools_;
+  // The first one has no components. Destroyed after entities.
+  std::vector<std::unique_ptr<Archetype>> archetypes_;
   std::vector<EntityPtr> entities_;
+  std::vector<EntitySlot> slots_;
+  std::vector<ui32> free_slots_;
+  std::vector<EntityHandle> pending_destroy_;
+  // One per job system worker
+  std::vector<std::unique_ptr<EntityCommandBuffer>> command_buffers_;
+  // Stable addresses: a query is read while others are being added
+  std::deque<Query> queries_;
+  std::mutex queries_mutex_;
+  std::atomic<ui32> iteration_depth_ = 0;
   size_t next_entity_id_ = 0;
+  ui64 structure_version_ = 0;
+  // Zero is older than any write
+  ui32 change_version_ = 1;
 };
 
 void World::ForEachEntity(auto&& fn) {
+  IterationScope scope(*this);
   for (auto& entity : entities_) {
     fn(*entity);
   }
@@ -51,3 +231,71 @@ T& World::SpawnEntity() {
   Entity& entity_base = SpawnEntity(cppreflection::GetStaticTypeInfo<T>().guid);
   return static_cast<T&>(entity_base);
 }
+
+template <typename... Ts, typename F>
+void World::ForEachChunk(F&& fn) {
+  constexpr size_t kNumTypes = sizeof...(Ts);
+  const std::array<ui32, kNumTypes> type_indices{
+      TypeIndices::IndexOf<std::remove_const_t<Ts>>()...};
+#ifndef NDEBUG
+  (CheckComponentAccess(TypeIndices::IndexOf<std::remove_const_t<Ts>>(),
+                        !std::is_const_v<Ts>),
+   ...);
+#endif
+  const Query& query = UpdateQuery(
+      GetQueryId<std::remove_const_t<Ts>...>(), type_indices);
+  IterationScope scope(*this);
+  for (size_t i = 0; i != query.archetypes.size(); ++i) {
+    const Archetype& archetype = *query.archetypes[i];
+    const ui32* columns = query.columns.data() + i * kNumTypes;
+    for (const ArchetypeChunk& chunk : archetype.GetChunks()) {
+      [&]<size_t... I>(std::index_sequence<I...>) {
+        fn(chunk, chunk.GetComponents<Ts>(columns[I])...);
+      }(std::index_sequence_for<Ts...>{});
+    }
+  }
+}
+
+template <typename... Ts, typename F>
+void World::ForEach(F&& fn) {
+  ForEachChunk<Ts...>(
+      [&](const ArchetypeChunk& chunk, std::span<Ts>... components) {
+        for (size_t i = 0; i != chunk.GetSize(); ++i) {
+          fn(components[i]...);
+        }
+      });
+}
+
+template <typename... Ts, typename F>
+void World::ForEachChunkChangedSince(ui32 version, F&& fn) {
+  ForEachChunk<Ts...>(
+      [&](const ArchetypeChunk& chunk, std::span<Ts>... components) {
+        const Archetype& archetype = chunk.GetArchetype();
+        const bool changed =
+            ((chunk.GetColumnChangeVersion(*archetype.FindColumn(
+                  TypeIndices::IndexOf<std::remove_const_t<Ts>>())) >
+              version) ||
+             ...);
+        [[likely]] if (!changed) { return; }
+        fn(chunk, components...);
+      });
+}
+
+template <typename... Ts, typename F>
+void World::ForEachChangedSince(ui32 version, F&& fn) {
+  constexpr size_t kNumTypes = sizeof...(Ts);
+  ForEachChunkChangedSince<Ts...>(
+      version, [&](const ArchetypeChunk& chunk, std::span<Ts>... components) {
+        const Archetype& archetype = chunk.GetArchetype();
+        const std::array<size_t, kNumTypes> columns{*archetype.FindColumn(
+            TypeIndices::IndexOf<std::remove_const_t<Ts>>())...};
+        for (size_t row = 0; row != chunk.GetSize(); ++row) {
+          const bool changed = std::ranges::any_of(columns, [&](size_t c) {
+            return chunk.GetChangeVersion(c, row) > version;
+          });
+          if (changed) {
+            fn(components[row]...);
+          }
+        }
+      });
+}